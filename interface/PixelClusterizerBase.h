@@ -5,10 +5,14 @@
 #include "DataFormats/Common/interface/DetSetVectorNew.h"
 #include "DataFormats/SiPixelCluster/interface/SiPixelCluster.h"
 #include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibratedDigiCollection.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelHotPixelMasker.h"
 #include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationServiceBase.h"
 #include <vector>
+#include <cstddef>
 
 class PixelGeomDetUnit;
+class TrackerGeometry;
 
 /**
  * Abstract interface for Pixel Clusterizers
@@ -17,6 +21,8 @@ class PixelClusterizerBase {
 public:
   typedef edm::DetSet<PixelDigi>::const_iterator    DigiIterator;
 
+  PixelClusterizerBase() : theSiPixelGainCalibrationService_(0), theHotPixelMasker_(0) {}
+
   // Virtual destructor, this is a base class.
   virtual ~PixelClusterizerBase() {}
 
@@ -27,13 +33,40 @@ public:
 				  const std::vector<short>& badChannels,
 				  edmNew::DetSetVector<SiPixelCluster>::FastFiller& output) = 0;
 
+  // Same, starting from pixels already calibrated to electrons.
+  // No call to the gain calibration service is made.
+  virtual void clusterizeDetUnit( const SiPixelCalibratedDigiCollection::Module & input,
+				  const PixelGeomDetUnit * pixDet,
+				  const std::vector<short>& badChannels,
+				  edmNew::DetSetVector<SiPixelCluster>::FastFiller& output) = 0;
+
   // Configure gain calibration service
-  void setSiPixelGainCalibrationService( SiPixelGainCalibrationServiceBase* in){ 
+  virtual void setSiPixelGainCalibrationService( SiPixelGainCalibrationServiceBase* in){ 
     theSiPixelGainCalibrationService_=in;
   }
 
+  // The gain calibration is needed even with pre-calibrated input
+  virtual bool needsGainCalibration() const { return false; }
+
+  // New IOV of the gain calibration, for the DetUnits of this geometry
+  virtual void newGainCalibration( const TrackerGeometry & geom ) {}
+
+  // Working memory for the last DetUnit, in bytes (for the scaling report)
+  virtual std::size_t memoryUsage() const { return 0; }
+
+  // Number of clusters in a DetUnit without making them, -1 if not available
+  virtual int countClusters( const edm::DetSet<PixelDigi> & input, const PixelGeomDetUnit * pixDet ) { return -1; }
+  virtual int countClusters( const SiPixelCalibratedDigiCollection::Module & input, 
+			     const PixelGeomDetUnit * pixDet ) { return -1; }
+
+  // Pixels masked online, ignored by the clustering
+  void setHotPixelMasker( const SiPixelHotPixelMasker* in){ 
+    theHotPixelMasker_=in;
+  }
+
  protected:
   SiPixelGainCalibrationServiceBase* theSiPixelGainCalibrationService_;
+  const SiPixelHotPixelMasker* theHotPixelMasker_;
 
 };
 
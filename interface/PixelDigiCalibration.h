@@ -0,0 +1,63 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_PixelDigiCalibration_H
+#define RecoLocalTracker_SiPixelClusterizer_PixelDigiCalibration_H
+
+//-----------------------------------------------------------------------
+//! \class PixelDigiCalibration
+//! \brief ADC -> electrons conversion of PixelDigis.
+//!
+//! Holds the calibration part of the clustering: the gain/pedestal
+//! correction from the SiPixelGainCalibrationService (MissCalibrate=true)
+//! or the simple linear gain, including the stack layer treatment,
+//! otherwise.  It is shared by PixelThresholdClusterizer and by the
+//! SiPixelCalibDigiProducer, so that both give the same electrons for
+//! the same digi.
+//!
+//! setDetId() has to be called once per DetUnit before calibrate().
+//-----------------------------------------------------------------------
+
+#include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationServiceBase.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <stdint.h>
+
+
+class PixelDigiCalibration {
+ public:
+
+  PixelDigiCalibration(edm::ParameterSet const& conf);
+
+  //! Configure gain calibration service
+  void setSiPixelGainCalibrationService( SiPixelGainCalibrationServiceBase* in) {
+    theSiPixelGainCalibrationService_ = in;
+  }
+
+  //! Select the DetUnit for the following calls to calibrate()
+  void setDetId(uint32_t detid);
+
+  //! Calibrate the ADC charge to electrons
+  int calibrate(int adc, int col, int row) const;
+
+  //! Electrons per ADC count (gain only), 0 for dead or noisy pixels
+  float electronsPerADC(int col, int row) const;
+
+  bool doMissCalibrate() const { return doMissCalibrate_; }
+  int  stackADC() const { return theStackADC_; }
+  int  firstStackLayer() const { return theFirstStack_; }
+  //! Barrel layer of the current DetUnit, 0 for the endcaps
+  int  layer() const { return theLayer_; }
+
+ private:
+
+  SiPixelGainCalibrationServiceBase* theSiPixelGainCalibrationService_;
+
+  int   theConversionFactor;  // adc to electron conversion factor
+  int   theOffset;            // adc to electron conversion offset
+  int   theStackADC_;          // The maximum ADC count for the stack layers
+  int   theFirstStack_;        // The index of the first stack layer
+  bool  doMissCalibrate_;      // Use calibration or not
+
+  uint32_t detid_;
+  int      theLayer_;
+};
+
+#endif
@@ -21,8 +21,43 @@
 //! large amplitudes, found at the time of filling of the matrix
 //! and stored in a
 //!
-//! At this point the noise and dead channels are ignored, but soon they
-//! won't be.
+//! At this point the dead channels are ignored, but soon they won't be.
+//!
+//! The thresholds can be given in ADC counts as well (ChannelThresholdInADC,
+//! SeedThresholdInADC, ClusterThresholdInADC), converted to electrons with
+//! the gain of each column, and in units of the noise of each column
+//! (ChannelThresholdInNoiseUnits, SeedThresholdInNoiseUnits,
+//! ClusterThresholdInNoiseUnits).  The gain payloads hold no noise, so the
+//! noise of a column is made from its gain: the front-end noise
+//! NoiseInElectrons added in quadrature to the readout noise NoiseInADC
+//! (default: the digitisation noise 1/sqrt(12)) times the gain.  The
+//! largest of the thresholds is applied, 0 switches one off.  The
+//! thresholds are tabulated per DetUnit and column at each new gain IOV,
+//! so the pixel loop only compares with a table entry.
+//!
+//! The stack layers with binary readout (AdcFullScaleStack=1, layers from
+//! FirstStackLayer on, MissCalibrate=false) are clustered on an occupancy
+//! bitmap instead: the runs of fired pixels of each column are found with
+//! bit operations and connected to the runs of the neighbour column, and
+//! every pixel gets the nominal (overflow) charge.  The clusters are those
+//! of the matrix, in the same order, but the pixels of a cluster come
+//! column by column (test/testPixelThresholdClusterizer.cpp).
+//!
+//! The cluster search is a template on the DetUnit size: the known pixel
+//! topologies (BPix full and half modules, FPix plaquettes) have their own
+//! instance with constant strides, selected once per DetUnit in setup(),
+//! all other sizes go through the runtime instance.
+//!
+//! countClusters() only counts the sets of connected pixels, on the
+//! occupancy bitmap: exactly (CountingMethod = "Components", runs joined
+//! as for the binary readout) or as the Euler number, sets minus holes,
+//! from the 2x2 pixel patterns of 64 rows at a time ("Euler", default).
+//! The seed and cluster thresholds are not applied, the pixel threshold
+//! only with CountingThresholds=true (default).
+//!
+//! With the untracked SortDigis=true the PixelDigis of a DetUnit are put
+//! in (column, row) order first if they are not (SiPixelDigiSorter), for
+//! inputs from the simulation or the mixing.
 //!
 //! SiPixelCluster contains a barrycenter, but it should be noted that that
 //! information is largely useless.  One must use a PositionEstimator
@@ -46,11 +81,18 @@
 
 // The private pixel buffer
 #include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelArrayBuffer.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelOccupancyBitmap.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelDigiSorter.h"
+
+// ADC -> electrons
+#include "RecoLocalTracker/SiPixelClusterizer/interface/PixelDigiCalibration.h"
 
 // Parameter Set:
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 
 #include <vector>
+#include <map>
+#include <algorithm>
 
 
 class PixelThresholdClusterizer : public PixelClusterizerBase {
@@ -66,8 +108,27 @@ class PixelThresholdClusterizer : public PixelClusterizerBase {
 				  edmNew::DetSetVector<SiPixelCluster>::FastFiller& output
 );
 
-  
+  // Pixels already calibrated by SiPixelCalibDigiProducer
+  void clusterizeDetUnit( const SiPixelCalibratedDigiCollection::Module & input,
+				  const PixelGeomDetUnit * pixDet,
+				  const std::vector<short>& badChannels,
+				  edmNew::DetSetVector<SiPixelCluster>::FastFiller& output
+);
+
+  void setSiPixelGainCalibrationService( SiPixelGainCalibrationServiceBase* in);
+
+  bool needsGainCalibration() const { return doADCThresholds || doNoiseThresholds; }
+  void newGainCalibration( const TrackerGeometry & geom );
+
+  std::size_t memoryUsage() const;
+
+  //! Number of clusters without making them, see CountingMethod
+  int countClusters( const edm::DetSet<PixelDigi> & input, const PixelGeomDetUnit * pixDet );
+  int countClusters( const SiPixelCalibratedDigiCollection::Module & input, const PixelGeomDetUnit * pixDet );
+
  private:
+  friend class testPixelThresholdClusterizer;   // test/testPixelThresholdClusterizer.cpp
+
 
   edm::ParameterSet conf_;
 
@@ -81,12 +142,33 @@ class PixelThresholdClusterizer : public PixelClusterizerBase {
   float thePixelThresholdInNoiseUnits;    // Pixel threshold in units of noise
   float theSeedThresholdInNoiseUnits;     // Pixel cluster seed in units of noise
   float theClusterThresholdInNoiseUnits;  // Cluster threshold in units of noise
+  float theNoiseInElectrons;   // front-end noise
+  float theNoiseInADC;         // readout noise, times the gain
+  bool  doNoiseThresholds;     // Any threshold in noise units
 
   int   thePixelThreshold;  // Pixel threshold in electrons
   int   theSeedThreshold;   // Seed threshold in electrons 
   float theClusterThreshold;  // Cluster threshold in electrons
-  int   theConversionFactor;  // adc to electron conversion factor
-  int   theOffset;            // adc to electron conversion offset
+
+  float thePixelThresholdInADC;    // Pixel threshold in ADC counts
+  float theSeedThresholdInADC;     // Pixel cluster seed in ADC counts
+  float theClusterThresholdInADC;  // Cluster threshold in ADC counts
+  bool  doADCThresholds;           // Any threshold in ADC counts
+
+  //! Thresholds of one DetUnit
+  struct ThresholdTable {
+    std::vector<int> pixel;    // per column
+    std::vector<int> seed;     // per column
+    int   minPixel;
+    float cluster;
+  };
+  std::map<uint32_t,ThresholdTable> theThresholdTables;  // for the current gain IOV
+  ThresholdTable theFlatThresholds;  // without ADC or noise thresholds, same for all DetUnits
+  //! Thresholds of the current DetUnit
+  const int * thePixelThresholds;
+  const int * theSeedThresholds;
+  int   theMinPixelThreshold;
+  float theModuleClusterThreshold;
 
   //! Geometry-related information
   int  theNumOfRows;
@@ -95,16 +177,69 @@ class PixelThresholdClusterizer : public PixelClusterizerBase {
   bool dead_flag;
   bool doMissCalibrate; // Use calibration or not
   bool doSplitClusters;
+  bool doSortDigis;     // order the digis by column first
+  SiPixelDigiSorter theSorter;
+  bool calibratedInput_;  // current DetUnit comes already in electrons
+  const std::vector<uint32_t>* theMaskedPixels_;  // learned hot pixels of this DetUnit
+  bool isMasked(int row, int col) const {
+    return std::binary_search(theMaskedPixels_->begin(), theMaskedPixels_->end(),
+			      SiPixelHotPixelMasker::channel(row,col));
+  }
   //! Private helper methods:
   bool setup(const PixelGeomDetUnit * pixDet);
+  bool setup(int nrows, int ncols);
+  bool begin_detunit( uint32_t detid, const PixelGeomDetUnit * pixDet, bool calibrated );
+  bool begin_detunit( uint32_t detid, bool calibrated );   // after setup()
+  void setup_thresholds();
+  void make_threshold_table( uint32_t detid, int nrows, int ncols, int rowsPerROC, ThresholdTable & table );
   void copy_to_buffer( DigiIterator begin, DigiIterator end );   
   void clear_buffer( DigiIterator begin, DigiIterator end );   
-  SiPixelCluster make_cluster( const SiPixelCluster::PixelPos& pix, edmNew::DetSetVector<SiPixelCluster>::FastFiller& output
-);
+  void copy_to_buffer( const SiPixelCalibratedDigiCollection::Module & input );
+  void clear_buffer( const SiPixelCalibratedDigiCollection::Module & input );
+  //! Cluster search, specialised per topology
+  typedef void (PixelThresholdClusterizer::*Kernel)( edmNew::DetSetVector<SiPixelCluster>::FastFiller& );
+  Kernel theKernel;    // for the current DetUnit
+  static Kernel select_kernel( int nrows, int ncols );
+  template<int NROWS, int NCOLS>
+  void make_clusters_fixed( edmNew::DetSetVector<SiPixelCluster>::FastFiller& output );
+  void make_clusters_runtime( edmNew::DetSetVector<SiPixelCluster>::FastFiller& output );
+  template<class Topology>
+  void make_clusters( const Topology& topo, edmNew::DetSetVector<SiPixelCluster>::FastFiller& output );
+  template<class Topology>
+  SiPixelCluster make_cluster( const Topology& topo, const SiPixelCluster::PixelPos& pix, 
+			       edmNew::DetSetVector<SiPixelCluster>::FastFiller& output );
+
+  //! Binary readout layers
+  bool binary_readout() const {
+    return !doMissCalibrate && theCalibration.stackADC() == 1 && 
+      theCalibration.layer() >= theCalibration.firstStackLayer();
+  }
+  bool clusterize_binary( DigiIterator begin, DigiIterator end,
+			  edmNew::DetSetVector<SiPixelCluster>::FastFiller& output );
+  //! A run of fired pixels along a column
+  struct PixelRun { int col; int first; int last; };
+  int  find_run( int run ) { return find_root(theRunParent, run); }
+  static int  find_root( std::vector<int> & parent, int run );
+  static void connect_columns( const std::vector<PixelRun> & runs, int a, int b, int bend, 
+			       std::vector<int> & parent );
+  void group_runs( std::vector<int> & npix );
+  void bitmap_runs( int minCol, int maxCol );
+  //! Counting of the connected pixels in theBitmap
+  enum Counting { EulerCounting, ComponentCounting };
+  Counting theCounting;
+  bool doCountingThresholds;   // apply the pixel threshold when counting
+  int  count_bitmap( int minCol, int maxCol );
+  int  euler_number( int minCol, int maxCol ) const;
+  SiPixelOccupancyBitmap  theBitmap;
+  std::vector<PixelRun>   theRuns;         // ordered by column, then row
+  std::vector<int>        theRunParent;    // union-find of connected runs
+  std::vector<int>        theColumnRuns;   // first run of each column
+  std::vector<int>        theComponentOf;  // component of each run
+  std::vector<int>        theComponentFirst;  // runs of each component:
+  std::vector<int>        theComponentRuns;   //   theComponentRuns[theComponentFirst[k]...]
   // Calibrate the ADC charge to electrons 
-  int calibrate(int adc, int col, int row);
-  int   theStackADC_;          // The maximum ADC count for the stack layers
-  int   theFirstStack_;        // The index of the first stack layer
+  PixelDigiCalibration theCalibration;
+  int calibrate(int adc, int col, int row) const { return theCalibration.calibrate(adc,col,row); }
 
 
 };
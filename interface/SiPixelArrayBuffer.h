@@ -14,6 +14,7 @@
 //! History:
 //!    Modify the indexing to col*nrows + row. 9/01 d.k.
 //!    Add setSize method to adjust array size. 3/02 d.k.
+//!    Add reshape and the topology classes for the compile-time indexing.
 //----------------------------------------------------------------------------
 
 // We use PixelPos which is an inner class of SiPixelCluster:
@@ -31,6 +32,8 @@ class SiPixelArrayBuffer
   inline SiPixelArrayBuffer( ){}
   
   inline void setSize( int rows, int cols);
+  //! Change the size of an empty (all zero) buffer, no reset needed.
+  inline void reshape( int rows, int cols);
   inline int operator()( int row, int col) const;
   inline int operator()( const SiPixelCluster::PixelPos&) const;
   inline int rows() const { return nrows;}
@@ -41,6 +44,9 @@ class SiPixelArrayBuffer
   inline void set_adc( const SiPixelCluster::PixelPos&, int adc);
   int size() const { return pixel_vec.size();}
 
+  //! Raw access, to be indexed with one of the topology classes below
+  int * data() { return &pixel_vec[0];}
+
   /// Definition of indexing within the buffer.
   int index( int row, int col) const {return col*nrows+row;}
   int index( const SiPixelCluster::PixelPos& pix) const { return index(pix.row(), pix.col()); }
@@ -86,6 +92,15 @@ void SiPixelArrayBuffer::setSize( int rows, int cols)
 }
 
 
+void SiPixelArrayBuffer::reshape( int rows, int cols) 
+{
+  nrows = rows;
+  ncols = cols;
+  // the new elements are zero, the old ones are zero already
+  if ( int(pixel_vec.size()) < rows*cols ) pixel_vec.resize(rows*cols, 0);
+}
+
+
 bool SiPixelArrayBuffer::inside(int row, int col) const 
 {
   return ( row >= 0 && row < nrows && col >= 0 && col < ncols);
@@ -119,4 +134,34 @@ void SiPixelArrayBuffer::set_adc( const SiPixelCluster::PixelPos& pix, int adc)
 }
 
 
+//----------------------------------------------------------------------------
+//! Indexing of the buffer for a DetUnit size known at compile time: the
+//! strides are constants and the bound checks fold into one compare each.
+//----------------------------------------------------------------------------
+template<int NROWS, int NCOLS>
+struct SiPixelFixedTopology 
+{
+  static int rows() { return NROWS;}
+  static int columns() { return NCOLS;}
+  static bool inside( int row, int col) { 
+    return (unsigned int)(row) < (unsigned int)(NROWS) && (unsigned int)(col) < (unsigned int)(NCOLS);
+  }
+  static int index( int row, int col) { return col*NROWS+row;}
+};
+
+//! Same for any other size.
+struct SiPixelRuntimeTopology 
+{
+  SiPixelRuntimeTopology( int rows, int cols) : nrows(rows), ncols(cols) {}
+  int rows() const { return nrows;}
+  int columns() const { return ncols;}
+  bool inside( int row, int col) const { 
+    return (unsigned int)(row) < (unsigned int)(nrows) && (unsigned int)(col) < (unsigned int)(ncols);
+  }
+  int index( int row, int col) const { return col*nrows+row;}
+  int nrows;
+  int ncols;
+};
+
+
 #endif
@@ -0,0 +1,68 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelCalibDigiProducer_h
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelCalibDigiProducer_h
+
+//---------------------------------------------------------------------------
+//! \class SiPixelCalibDigiProducer
+//!
+//! \brief EDProducer to convert the PixelDigis to electrons once per event.
+//!
+//! Runs the ADC -> electrons calibration of PixelThresholdClusterizer
+//! (PixelDigiCalibration) on all PixelDigis and stores the result as a
+//! SiPixelCalibratedDigiCollection.  SiPixelClusterProducers configured
+//! with calibratedSrc pointing to this module skip their own calibration,
+//! which saves the gain service lookups when several clusterizers with
+//! different thresholds run on the same digis.
+//!
+//! The calibration parameters (VCaltoElectronGain, VCaltoElectronOffset,
+//! MissCalibrate, payloadType, AdcFullScaleStack, FirstStackLayer) have
+//! the same meaning as for SiPixelClusterProducer.
+//!
+//! With the untracked SortDigis=true the pixels of each DetUnit are
+//! written in (column, row) order, see SiPixelDigiSorter.
+//!
+//---------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/PixelDigiCalibration.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibratedDigiCollection.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelDigiSorter.h"
+
+#include "DataFormats/Common/interface/DetSetVector.h"
+#include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
+
+#include "FWCore/Framework/interface/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+
+
+namespace cms
+{
+
+  class SiPixelCalibDigiProducer : public edm::EDProducer {
+  public:
+    explicit SiPixelCalibDigiProducer(const edm::ParameterSet& conf);
+    virtual ~SiPixelCalibDigiProducer();
+
+    virtual void beginJob( );
+
+    //--- The top-level event method.
+    virtual void produce(edm::Event& e, const edm::EventSetup& c);
+
+    //--- Calibrate all the digis of the event.
+    void run(const edm::DetSetVector<PixelDigi> & input,
+	     SiPixelCalibratedDigiCollection    & output);
+
+  private:
+    edm::ParameterSet conf_;
+    SiPixelGainCalibrationServiceBase * theSiPixelGainCalibration_;
+    PixelDigiCalibration calibration_;
+    edm::InputTag src_;
+    bool sortDigis_;
+    SiPixelDigiSorter sorter_;
+  };
+}
+
+
+#endif
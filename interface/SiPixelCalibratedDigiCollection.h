@@ -0,0 +1,115 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelCalibratedDigiCollection_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelCalibratedDigiCollection_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelCalibratedDigiCollection
+//! \brief PixelDigis already converted to electrons, stored as arrays.
+//!
+//! Written once per event by SiPixelCalibDigiProducer and read by any
+//! number of SiPixelClusterProducers, so that the gain calibration is not
+//! repeated by every clusterizer instance.
+//!
+//! The data are kept as a structure of arrays: one array each for
+//! row, column and charge of all pixels, plus the DetId and the first
+//! pixel of every DetUnit.  The pixels of a DetUnit are contiguous and
+//! in the order of the input DetSet.  A Module is a light view of one
+//! DetUnit, usable in place of an edm::DetSet<PixelDigi>.
+//----------------------------------------------------------------------------
+
+#include <vector>
+#include <iterator>
+#include <stdint.h>
+
+
+class SiPixelCalibratedDigiCollection {
+ public:
+  typedef unsigned short UShort;
+
+  //! View of the calibrated pixels of one DetUnit
+  class Module {
+  public:
+    Module(const SiPixelCalibratedDigiCollection& coll, unsigned int i) :
+      detid_(coll.detIds_[i]),
+      first_(coll.offsets_[i]),
+      size_(coll.moduleEnd(i)-coll.offsets_[i]),
+      rows_(coll.rows_.empty() ? 0 : &coll.rows_[0]),
+      cols_(coll.cols_.empty() ? 0 : &coll.cols_[0]),
+      electrons_(coll.electrons_.empty() ? 0 : &coll.electrons_[0]) {}
+
+    uint32_t detId() const { return detid_; }
+    unsigned int size() const { return size_; }
+    bool empty() const { return size_==0; }
+    int row(unsigned int i) const { return rows_[first_+i]; }
+    int column(unsigned int i) const { return cols_[first_+i]; }
+    int electrons(unsigned int i) const { return electrons_[first_+i]; }
+
+  private:
+    uint32_t       detid_;
+    unsigned int   first_;
+    unsigned int   size_;
+    const UShort * rows_;
+    const UShort * cols_;
+    const int    * electrons_;
+  };
+
+  //! Iterator over the DetUnits, dereferences to a Module
+  class const_iterator : public std::iterator<std::forward_iterator_tag, Module> {
+  public:
+    const_iterator(const SiPixelCalibratedDigiCollection& coll, unsigned int i) : coll_(&coll), i_(i) {}
+    Module operator*() const { return Module(*coll_,i_); }
+    const_iterator& operator++() { ++i_; return *this; }
+    const_iterator operator++(int) { const_iterator tmp(*this); ++i_; return tmp; }
+    bool operator==(const const_iterator& rh) const { return i_==rh.i_; }
+    bool operator!=(const const_iterator& rh) const { return i_!=rh.i_; }
+  private:
+    const SiPixelCalibratedDigiCollection * coll_;
+    unsigned int i_;
+  };
+
+  SiPixelCalibratedDigiCollection() {}
+
+  void reserve(unsigned int nModules, unsigned int nPixels) {
+    detIds_.reserve(nModules); offsets_.reserve(nModules);
+    rows_.reserve(nPixels); cols_.reserve(nPixels); electrons_.reserve(nPixels);
+  }
+
+  //! Start a new DetUnit, the following push_back() calls belong to it
+  void beginModule(uint32_t detid) {
+    detIds_.push_back(detid);
+    offsets_.push_back(rows_.size());
+  }
+
+  void push_back(int row, int col, int electrons) {
+    rows_.push_back(row);
+    cols_.push_back(col);
+    electrons_.push_back(electrons);
+  }
+
+  //! Number of DetUnits
+  unsigned int size() const { return detIds_.size(); }
+  bool empty() const { return detIds_.empty(); }
+  //! Total number of pixels
+  unsigned int nPixels() const { return rows_.size(); }
+
+  Module operator[](unsigned int i) const { return Module(*this,i); }
+  const_iterator begin() const { return const_iterator(*this,0); }
+  const_iterator end() const { return const_iterator(*this,size()); }
+
+  void swap(SiPixelCalibratedDigiCollection& other) {
+    detIds_.swap(other.detIds_); offsets_.swap(other.offsets_);
+    rows_.swap(other.rows_); cols_.swap(other.cols_); electrons_.swap(other.electrons_);
+  }
+
+ private:
+  unsigned int moduleEnd(unsigned int i) const {
+    return (i+1<offsets_.size()) ? offsets_[i+1] : rows_.size();
+  }
+
+  std::vector<uint32_t> detIds_;     // one per DetUnit
+  std::vector<uint32_t> offsets_;    // first pixel of each DetUnit
+  std::vector<UShort>   rows_;       // one per pixel
+  std::vector<UShort>   cols_;
+  std::vector<int>      electrons_;
+};
+
+#endif
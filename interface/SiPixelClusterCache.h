@@ -0,0 +1,102 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelClusterCache_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelClusterCache_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelClusterCache
+//! \brief Clusters already made in the current event, shared between
+//!        SiPixelClusterProducers with identical configuration.
+//!
+//! Process-wide table keyed on the ProductID of the input digis, a
+//! digest of the clustering configuration (the module label excluded)
+//! and the digest of the hot pixel mask the clusters were made with.
+//! The entries are the ProductIDs of the cluster collections already put
+//! in the event, not pointers: the sharing producer gets the product back
+//! from its own event.  The table is emptied as soon as another event is
+//! seen; it is guarded by a mutex.
+//!
+//! copy() fills the collection of the sharing producer from the shared
+//! product.  The clusters are copied, not made available on demand: the
+//! output modules write only the DetUnits already filled.
+//!
+//! The hot pixel mask is shared as well: masker() gives all producers of a
+//! configuration the same SiPixelHotPixelMasker, so the producer getting
+//! the clusters from the cache uses the mask learned from the events
+//! clustered by the others, and the mask digests stay equal.
+//----------------------------------------------------------------------------
+
+#include "DataFormats/Common/interface/DetSetVectorNew.h"
+#include "DataFormats/SiPixelCluster/interface/SiPixelCluster.h"
+#include "DataFormats/Provenance/interface/EventID.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelHotPixelMasker.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+
+class SiPixelClusterCache {
+ public:
+  typedef edmNew::DetSetVector<SiPixelCluster> Collection;
+
+  static SiPixelClusterCache& instance();
+
+  //! Digest of the parameters which define the clustering result
+  static std::string configDigest(const edm::ParameterSet& conf);
+
+  //! Clusters made from this input with this configuration and mask,
+  //! false if none yet
+  bool find(const edm::EventID& event,
+	    const edm::ProductID& input,
+	    const std::string& config,
+	    uint64_t mask,
+	    edm::ProductID& clusters);
+
+  //! Register the clusters put in the event by a producer
+  void insert(const edm::EventID& event,
+	      const edm::ProductID& input,
+	      const std::string& config,
+	      uint64_t mask,
+	      const edm::ProductID& clusters);
+
+  //! The hot pixel masker of a configuration, one for all the producers
+  //! with this configuration; made from conf by the first one asking, for
+  //! which first is set
+  boost::shared_ptr<SiPixelHotPixelMasker> masker(const std::string& config,
+						  const edm::ParameterSet& conf,
+						  bool& first);
+
+  //! Copy of the shared collection
+  static void copy(const Collection& shared, Collection& output);
+
+ private:
+  SiPixelClusterCache() {}
+  SiPixelClusterCache(const SiPixelClusterCache&);
+  SiPixelClusterCache& operator=(const SiPixelClusterCache&);
+
+  //! Drop the entries of the previous event, with the lock held
+  void setEvent(const edm::EventID& event);
+
+  struct Key {
+    Key(const edm::ProductID& i, const std::string& c, uint64_t m) : input(i), config(c), mask(m) {}
+    edm::ProductID input;
+    std::string    config;
+    uint64_t       mask;
+    bool operator<(const Key& other) const {
+      if ( input != other.input ) return input < other.input;
+      if ( mask != other.mask ) return mask < other.mask;
+      return config < other.config;
+    }
+  };
+
+  std::mutex                         mutex_;
+  edm::EventID                       event_;
+  std::map<Key, edm::ProductID>      entries_;
+  std::map<std::string, boost::shared_ptr<SiPixelHotPixelMasker> > maskers_;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelClusterCounts_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelClusterCounts_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelClusterCounts
+//! \brief Number of pixel clusters per DetUnit, without the clusters.
+//!
+//! Written by SiPixelClusterProducer with CountingOnly=true, for the
+//! luminosity and multiplicity triggers which need the counts only.  The
+//! DetUnits without clusters are not stored.  The counts are those of
+//! PixelThresholdClusterizer::countClusters(), i.e. approximate with the
+//! Euler method and without the seed and cluster thresholds.
+//----------------------------------------------------------------------------
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+
+class SiPixelClusterCounts {
+ public:
+  SiPixelClusterCounts() : total_(0) {}
+
+  void push_back(uint32_t detid, unsigned int count) {
+    detIds_.push_back(detid);
+    counts_.push_back(count);
+    total_ += count;
+  }
+
+  //! Number of DetUnits with clusters
+  unsigned int size() const { return detIds_.size(); }
+  bool empty() const { return detIds_.empty(); }
+  uint32_t detId(unsigned int i) const { return detIds_[i]; }
+  unsigned int count(unsigned int i) const { return counts_[i]; }
+  //! Clusters in all DetUnits
+  unsigned int total() const { return total_; }
+
+  void swap(SiPixelClusterCounts& other) {
+    detIds_.swap(other.detIds_);
+    counts_.swap(other.counts_);
+    std::swap(total_, other.total_);
+  }
+
+ private:
+  std::vector<uint32_t>     detIds_;
+  std::vector<unsigned int> counts_;
+  unsigned int              total_;
+};
+
+#endif
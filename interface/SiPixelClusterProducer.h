@@ -21,6 +21,43 @@
 //! The calibrations are not loaded at the moment (v1), although that is
 //! being planned for the near future.
 //!
+//! If the optional parameter calibratedSrc is set, the input is instead a
+//! SiPixelCalibratedDigiCollection made by SiPixelCalibDigiProducer and the
+//! gain calibration service is not used at all.
+//!
+//! With the untracked ShareClusters=true, instances with identical
+//! configuration and hot pixel mask running on the same input share their
+//! result through SiPixelClusterCache: only the first one clusters, the
+//! others put a copy of its clusters.
+//!
+//! If the HotPixelMasking PSet is given, noisy pixels are learned from the
+//! data by a SiPixelHotPixelMasker and ignored by the clusterizer; the mask
+//! is updated at each end of lumi section and exported at endRun.  Sharing
+//! instances share the masker too, it is updated and exported by the first
+//! instance constructed.
+//!
+//! With the untracked ScalingReport=true, the clustering time and the
+//! working memory per DetUnit are summed per pixel topology and printed
+//! at endJob, to follow how they grow with the number of channels.
+//!
+//! For a bounded latency (HLT), TimeBudget (ms) limits the clustering time
+//! per event: the clock is checked every DeadlineCheckInterval DetUnits
+//! and the remaining DetUnits are skipped once the budget is used up.
+//! Such an event gets a partial collection and the bool "Incomplete" set
+//! to true, as does an event emptied by maxNumberOfClusters; the number
+//! of these events is reported at endRun.  The
+//! DetUnits are clustered in the order of the groups in ModulePriority
+//! (e.g. "BPix1", "BPix2", "FPix1"), the others last; the rank of each
+//! DetUnit is tabulated once per geometry over the SiPixelModuleIndex.
+//!
+//! With CountingOnly=true no clusters are made: a SiPixelClusterCounts
+//! with the number of clusters per DetUnit from countClusters() is put
+//! in the event instead, for the luminosity and multiplicity triggers
+//! (CountingMethod, CountingThresholds: see PixelThresholdClusterizer).
+//! The untracked CountingReport=true clusters every DetUnit as well and
+//! prints the error of the counts against the clusters at endJob.  The
+//! time budget and the sharing are not used in this mode.
+//!
 //! \author porting from ORCA by Petar Maksimovic (JHU). 
 //!         DetSetVector implementation by Vincenzo Chiochia (Uni Zurich)        
 //!         Modify the local container (cache) to improve the speed. D.K. 5/07
@@ -29,6 +66,9 @@
 //---------------------------------------------------------------------------
 
 #include "RecoLocalTracker/SiPixelClusterizer/interface/PixelClusterizerBase.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibratedDigiCollection.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterCounts.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelModuleIndex.h"
 
 //#include "Geometry/CommonDetUnit/interface/TrackingGeometry.h"
 
@@ -43,12 +83,23 @@
 #include "FWCore/Framework/interface/EDProducer.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/Run.h"
 #include "DataFormats/Common/interface/Handle.h"
 #include "FWCore/Framework/interface/ESHandle.h"
+#include "DataFormats/Provenance/interface/EventID.h"
+#include "DataFormats/Provenance/interface/ProductID.h"
 
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <string>
+
 
 
 namespace cms
@@ -65,6 +116,9 @@ namespace cms
     // Begin Job
     //virtual void beginJob( const edm::EventSetup& );
     virtual void beginJob( );
+    virtual void endJob( );
+    virtual void endLuminosityBlock(edm::LuminosityBlock& lumi, const edm::EventSetup& es);
+    virtual void endRun(edm::Run& run, const edm::EventSetup& es);
 
     //--- The top-level event method.
     virtual void produce(edm::Event& e, const edm::EventSetup& c);
@@ -74,17 +128,110 @@ namespace cms
 	     edm::ESHandle<TrackerGeometry>       & geom,
              edmNew::DetSetVector<SiPixelCluster> & output);
 
+    void run(const SiPixelCalibratedDigiCollection & input,
+	     edm::ESHandle<TrackerGeometry>       & geom,
+             edmNew::DetSetVector<SiPixelCluster> & output);
+
   private:
+    //--- Common DetUnit loop of both run() methods.
+    template<typename InputCollection>
+    void clusterize(const InputCollection                & input,
+		    edm::ESHandle<TrackerGeometry>       & geom,
+		    edmNew::DetSetVector<SiPixelCluster> & output);
+
+    //--- Same, by priority and within the time budget.
+    template<typename InputCollection>
+    void clusterizeWithDeadline(const InputCollection                & input,
+				edm::ESHandle<TrackerGeometry>       & geom,
+				edmNew::DetSetVector<SiPixelCluster> & output);
+
+    //--- One DetUnit.
+    template<typename DetUnitInput>
+    void clusterizeModule(const DetUnitInput                   & input,
+			  edm::ESHandle<TrackerGeometry>       & geom,
+			  edmNew::DetSetVector<SiPixelCluster>::FastFiller & spc);
+
+    //--- The event and its pixels for the hot pixel masker.
+    template<typename InputCollection>
+    void fillHotPixelMasker(const InputCollection & input);
+
+    //--- Cluster counts only, CountingOnly.
+    template<typename InputCollection>
+    void count(const InputCollection                & input,
+	       edm::ESHandle<TrackerGeometry>       & geom,
+	       SiPixelClusterCounts                 & counts);
+
+    //--- Rank of the DetUnit in ModulePriority.
+    unsigned int priority(uint32_t detid) const;
+    //--- Tabulate the ranks, when the geometry changed.
+    void updateModulePriorities(const edm::EventSetup& es);
+
+    //--- Gain calibration service of the configured payloadType, 0 if none.
+    SiPixelGainCalibrationServiceBase * makeGainCalibrationService() const;
+
+    //--- Update the gain calibration, tell the clusterizer about a new IOV.
+    void setupGainCalibration(const edm::EventSetup& es, const TrackerGeometry& geom);
+
+    //--- Copy of the clusters of an identical producer, if any.
+    bool getSharedClusters(const edm::Event& e, const edm::ProductID& input,
+			   edmNew::DetSetVector<SiPixelCluster> & output);
+    uint64_t maskDigest() const;
+
+
     edm::ParameterSet conf_;
     // TO DO: maybe allow a map of pointers?
     SiPixelGainCalibrationServiceBase * theSiPixelGainCalibration_;
+    std::string payloadType_;
+    unsigned long long gainCacheId_;        // to detect a new gain IOV
     std::string clusterMode_;               // user's choice of the clusterizer
     PixelClusterizerBase * clusterizer_;    // what we got (for now, one ptr to base class)
+    boost::shared_ptr<SiPixelHotPixelMasker> hotPixelMasker_; // optional online masking, 0 if off
+    bool maskerOwner_;                      // updates and exports the mask
+    edm::EventID eventId_;                  // the event being produced
     bool readyToCluster_;                   // needed clusterizers valid => good to go!
     edm::InputTag src_;
+    edm::InputTag calibratedSrc_;           // pre-calibrated pixels, if any
+    bool useCalibratedDigis_;
 
     //! Optional limit on the total number of clusters
     int32_t maxTotalClusters_;
+
+    //! Sharing of the result between identical instances
+    bool shareClusters_;
+    std::string configDigest_;
+    unsigned int sharedHits_;
+    unsigned int sharedMisses_;
+
+    //! Time and memory per DetUnit, per topology (rows, columns)
+    struct TopologyStats {
+      TopologyStats() : modules(0), seconds(0.), maxBytes(0) {}
+      unsigned long modules;
+      double        seconds;
+      std::size_t   maxBytes;
+    };
+    bool scalingReport_;
+    std::map<std::pair<int,int>,TopologyStats> topologyStats_;
+
+    //! Bounded latency mode
+    double timeBudget_;                     // ms per event, 0 = no limit
+    int deadlineCheckInterval_;             // DetUnits between clock readings
+    std::vector<std::string> modulePriority_;
+    SiPixelModuleIndex moduleIndex_;
+    std::vector<unsigned int> modulePriorities_;  // per module index
+    bool incomplete_;                       // budget exhausted in this event
+    unsigned int deadlineHits_;             // events cut in this run
+
+    //! Counting only, and the comparison with the clusters
+    bool countingOnly_;
+    bool countingReport_;
+    edmNew::DetSetVector<SiPixelCluster> countingScratch_;
+    unsigned long countingEvents_;
+    unsigned long countingModules_;
+    unsigned long countingWrongModules_;    // DetUnits with a count off
+    unsigned long countingExact_;           // clusters
+    unsigned long countingCounted_;         // counts
+    unsigned long countingAbsError_;        // sum of |count - clusters| per DetUnit
+    double countingEventError_;             // sum of |relative error| per event
   };
 }
 
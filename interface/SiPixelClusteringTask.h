@@ -0,0 +1,143 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelClusteringTask_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelClusteringTask_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelClusteringTask
+//! \brief Clustering of one event in slices, resumed by the caller.
+//!
+//! The task holds the position in the DetUnits, and each call to resume()
+//! clusters the next batch of them and returns, so that the caller can do
+//! other work or stop in between: SiPixelClusterProducer checks its time
+//! budget between two batches, a standalone online tool with its own event
+//! loop can read the next event.  Everything runs in the caller's thread.
+//!
+//!   SiPixelClusteringTask<edm::DetSetVector<PixelDigi> >::DetUnitClusterizer
+//!     detUnits(clusterizer, geom);
+//!   SiPixelClusteringTask<edm::DetSetVector<PixelDigi> > task(detUnits, digis, clusters);
+//!   while ( task.resume() ) { ... other work ... }
+//!
+//! The DetUnits are done in the input order, or in the order given.  The
+//! input, the output and the ModuleClusterizer must stay alive and must
+//! not be used by anyone else until done() is true.  With more clusters
+//! than maxTotalClusters (if not negative) the output is emptied and the
+//! task is done, as in SiPixelClusterProducer.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/PixelClusterizerBase.h"
+#include "DataFormats/Common/interface/DetSetVectorNew.h"
+#include "DataFormats/SiPixelCluster/interface/SiPixelCluster.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+#include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
+
+#include <iterator>
+#include <vector>
+
+
+template<typename InputCollection>
+class SiPixelClusteringTask {
+ public:
+  typedef typename InputCollection::const_iterator const_iterator;
+  typedef typename std::iterator_traits<const_iterator>::value_type DetUnit;
+  typedef edmNew::DetSetVector<SiPixelCluster> Output;
+
+  //! Clusters one DetUnit into the filler
+  class ModuleClusterizer {
+  public:
+    virtual ~ModuleClusterizer() {}
+    virtual void clusterize(const DetUnit & input, Output::FastFiller & spc) = 0;
+  };
+
+  //! The clusterizer on the DetUnits of the geometry, without bad channels
+  class DetUnitClusterizer : public ModuleClusterizer {
+  public:
+    DetUnitClusterizer(PixelClusterizerBase & clusterizer, const TrackerGeometry & geom) :
+      clusterizer_(clusterizer), geom_(geom) {}
+    inline void clusterize(const DetUnit & input, Output::FastFiller & spc);
+  private:
+    PixelClusterizerBase & clusterizer_;
+    const TrackerGeometry & geom_;
+    std::vector<short> badChannels_;
+  };
+
+  //! The DetUnits in the input order
+  SiPixelClusteringTask(ModuleClusterizer & clusterizer,
+			const InputCollection & input,
+			Output & output,
+			unsigned int batchSize = 64,
+			int maxTotalClusters = -1) :
+    clusterizer_(clusterizer), output_(output), next_(0),
+    batchSize_(batchSize > 0 ? batchSize : 1), maxTotalClusters_(maxTotalClusters),
+    numberOfDetUnits_(0), numberOfClusters_(0), tooManyClusters_(false)
+  {
+    order_.reserve(input.size());
+    for ( const_iterator it = input.begin(); it != input.end(); ++it ) order_.push_back(it);
+  }
+
+  //! The DetUnits in this order, e.g. by priority
+  SiPixelClusteringTask(ModuleClusterizer & clusterizer,
+			const std::vector<const_iterator> & order,
+			Output & output,
+			unsigned int batchSize = 64,
+			int maxTotalClusters = -1) :
+    clusterizer_(clusterizer), output_(output), order_(order), next_(0),
+    batchSize_(batchSize > 0 ? batchSize : 1), maxTotalClusters_(maxTotalClusters),
+    numberOfDetUnits_(0), numberOfClusters_(0), tooManyClusters_(false) {}
+
+  //! Cluster the next batch, false once the event is done
+  inline bool resume();
+
+  bool done() const { return next_ == order_.size(); }
+  unsigned int numberOfDetUnits() const { return numberOfDetUnits_; }
+  unsigned int numberOfClusters() const { return numberOfClusters_; }
+  //! The limit on the clusters was hit, the output is empty
+  bool tooManyClusters() const { return tooManyClusters_; }
+
+ private:
+  ModuleClusterizer & clusterizer_;
+  Output & output_;
+  std::vector<const_iterator> order_;
+  unsigned int next_;
+  unsigned int batchSize_;
+  int maxTotalClusters_;
+  unsigned int numberOfDetUnits_;
+  unsigned int numberOfClusters_;
+  bool tooManyClusters_;
+};
+
+
+template<typename InputCollection>
+void SiPixelClusteringTask<InputCollection>::DetUnitClusterizer::clusterize(const DetUnit & input,
+									   Output::FastFiller & spc)
+{
+  const PixelGeomDetUnit * pixDet =
+    dynamic_cast<const PixelGeomDetUnit*>( geom_.idToDetUnit( DetId(input.detId()) ) );
+  if ( pixDet ) clusterizer_.clusterizeDetUnit(input, pixDet, badChannels_, spc);
+}
+
+template<typename InputCollection>
+bool SiPixelClusteringTask<InputCollection>::resume()
+{
+  for ( unsigned int i = 0; i < batchSize_ && next_ < order_.size(); ++i, ++next_ ) {
+    ++numberOfDetUnits_;
+    const DetUnit & input = *order_[next_];
+    Output::FastFiller spc(output_, input.detId());
+    clusterizer_.clusterize(input, spc);
+    if ( spc.empty() ) {
+      spc.abort();
+    } else {
+      numberOfClusters_ += spc.size();
+    }
+
+    if ( maxTotalClusters_ >= 0 && int(numberOfClusters_) > maxTotalClusters_ ) {
+      Output empty;
+      empty.swap(output_);
+      tooManyClusters_ = true;
+      next_ = order_.size();
+      break;
+    }
+  }
+  return next_ < order_.size();
+}
+
+#endif
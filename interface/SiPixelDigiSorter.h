@@ -0,0 +1,95 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelDigiSorter_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelDigiSorter_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelDigiSorter
+//! \brief Orders the PixelDigis of a DetUnit by column, then row.
+//!
+//! The digis of the raw data come column by column, those of the
+//! simulation or of the pile-up mixing need not.  sort() checks the order
+//! first (one pass over the keys) and returns the input if it is fine,
+//! else an LSD radix sort on the key col<<9|row, 9 bits per pass, is done
+//! into the sorter's own storage.  The sort is stable: repeated pixels
+//! keep their order, so the last one still wins in the buffer.  Rows of
+//! 512 and more do not fit the key: such DetUnits are checked on the digis
+//! and go through std::stable_sort if out of order.
+//----------------------------------------------------------------------------
+
+#include "DataFormats/Common/interface/DetSetVector.h"
+#include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+
+class SiPixelDigiSorter
+{
+ public:
+  typedef edm::DetSet<PixelDigi>::const_iterator DigiIterator;
+
+  //! Point begin, end to the digis in (column, row) order
+  inline void sort( DigiIterator & begin, DigiIterator & end);
+
+ private:
+  enum { BITS = 9, ROWMASK = (1<<BITS)-1 };
+  static bool less( const PixelDigi & a, const PixelDigi & b) {
+    return a.column() < b.column() || (a.column() == b.column() && a.row() < b.row());
+  }
+
+  std::vector<uint32_t>  keys;
+  std::vector<uint32_t>  keys2;
+  std::vector<PixelDigi> digis;
+  std::vector<PixelDigi> digis2;
+};
+
+
+void SiPixelDigiSorter::sort( DigiIterator & begin, DigiIterator & end)
+{
+  const unsigned int n = end - begin;
+  if ( n < 2 ) return;
+
+  // The keys, and the order check without branches
+  keys.resize(n);
+  uint32_t maxKey = 0, rows = 0, unordered = 0;
+  for (unsigned int i = 0; i < n; ++i)
+    {
+      const uint32_t row = begin[i].row();
+      keys[i] = (uint32_t(begin[i].column()) << BITS) | (row & ROWMASK);
+      rows |= row;
+      maxKey = std::max(maxKey, keys[i]);
+    }
+  for (unsigned int i = 1; i < n; ++i) unordered |= ( keys[i] < keys[i-1] );
+  if ( rows > uint32_t(ROWMASK) )
+    {
+      // the keys lack the high row bits
+      if ( std::is_sorted(begin, end, less) ) return;
+      digis.assign(begin, end);
+      std::stable_sort(digis.begin(), digis.end(), less);
+    }
+  else
+    {
+      if ( !unordered ) return;
+      digis.assign(begin, end);
+      keys2.resize(n);
+      digis2.resize(n);
+      for (int shift = 0; (maxKey >> shift) != 0; shift += BITS)
+	{
+	  unsigned int count[(1<<BITS)+1] = {0};
+	  for (unsigned int i = 0; i < n; ++i) ++count[((keys[i] >> shift) & ROWMASK) + 1];
+	  for (unsigned int b = 0; b < (1<<BITS); ++b) count[b+1] += count[b];
+	  for (unsigned int i = 0; i < n; ++i)
+	    {
+	      const unsigned int j = count[(keys[i] >> shift) & ROWMASK]++;
+	      keys2[j] = keys[i];
+	      digis2[j] = digis[i];
+	    }
+	  keys.swap(keys2);
+	  digis.swap(digis2);
+	}
+    }
+  begin = digis.begin();
+  end = digis.end();
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelHotPixelMasker_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelHotPixelMasker_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelHotPixelMasker
+//! \brief Learn the noisy pixels from the data and mask them.
+//!
+//! Every fired pixel is counted in a count-min sketch (conservative
+//! update), which is cleared at the end of each lumi section.  A pixel
+//! whose estimated count goes above half of the allowed rate in the events
+//! of the lumi section so far becomes a candidate, and stays one if it is
+//! still above at the end of the lumi section; for the candidates the counts of the last WindowLumiSections
+//! lumi sections are kept, and a candidate firing in more than MaxRate of
+//! the events of the window is masked.  The mask is updated at the end of
+//! every lumi section, so it is constant within a lumi section, and a
+//! pixel which calms down is unmasked again.
+//!
+//! The sketch overestimates, never underestimates: with Width counters per
+//! row the excess is about e*(pixels fired per event)/Width in units of the
+//! rate.  Candidates are re-estimated from the sketch each lumi section.
+//!
+//! Configured by the HotPixelMasking PSet of SiPixelClusterProducer:
+//!  - MaxRate              fraction of events above which a pixel is masked
+//!  - WindowLumiSections   length of the sliding window
+//!  - MinEvents            minimal number of events in the window to decide
+//!  - SketchWidthBits      log2 of the number of counters per sketch row
+//!  - SketchDepth          number of sketch rows (hash functions)
+//!  - OutputFile           (untracked) file the mask is appended to at endRun,
+//!                         the mask goes to the log if empty
+//----------------------------------------------------------------------------
+
+#include "DataFormats/Common/interface/DetSetVector.h"
+#include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibratedDigiCollection.h"
+#include "DataFormats/Provenance/interface/EventID.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+
+
+class SiPixelHotPixelMasker {
+ public:
+  explicit SiPixelHotPixelMasker(const edm::ParameterSet& conf);
+
+  //! Count one event, false if it was counted already: a masker shared
+  //! by several producers gets the pixels of an event only once
+  bool newEvent(const edm::EventID& event) {
+    if ( counted_ && event == lastEvent_ ) return false;
+    counted_ = true;
+    lastEvent_ = event;
+    ++nEvents_;
+    return true;
+  }
+
+  //! Count the fired pixels of one DetUnit
+  void fill(const edm::DetSet<PixelDigi>& digis);
+  void fill(const SiPixelCalibratedDigiCollection::Module& pixels);
+  inline void fill(uint32_t detid, int row, int col);
+
+  //! Close the lumi section: slide the window and update the mask
+  void endLumiBlock();
+
+  //! Masked pixels of a DetUnit as sorted channel(row,col) list, 0 if none
+  const std::vector<uint32_t>* maskedPixels(uint32_t detid) const {
+    std::map<uint32_t, std::vector<uint32_t> >::const_iterator it = masked_.find(detid);
+    return ( it == masked_.end() ) ? 0 : &it->second;
+  }
+  static uint32_t channel(int row, int col) { return (uint32_t(row)<<16) | uint32_t(col); }
+
+  unsigned int nMasked() const { return nMasked_; }
+  //! Hash of the masked pixels, 0 if none: equal masks, equal digests
+  uint64_t maskDigest() const { return maskDigest_; }
+  const std::string& outputFile() const { return outputFile_; }
+
+  //! One line per masked pixel: detid row col rate
+  void write(std::ostream& out) const;
+
+ private:
+  static uint64_t key(uint32_t detid, int row, int col) {
+    return (uint64_t(detid)<<32) | channel(row,col);
+  }
+  //! Multiplicative hash, one odd multiplier per sketch row
+  unsigned int bucket(uint64_t k, unsigned int i) const {
+    return (unsigned int)( (k * multipliers_[i]) >> (64-widthBits_) );
+  }
+  uint32_t estimate(uint64_t k) const;
+
+  double        maxRate_;
+  unsigned int  window_;
+  unsigned int  minEvents_;
+  unsigned int  widthBits_;
+  unsigned int  depth_;
+  std::string   outputFile_;
+
+  std::vector<uint64_t> multipliers_;
+  std::vector<uint32_t> sketch_;        // depth_ rows of 2^widthBits_ counters
+  uint32_t              nEvents_;       // events in the current lumi section
+  edm::EventID          lastEvent_;
+  bool                  counted_;       // lastEvent_ is valid
+
+  std::deque<uint32_t>                         windowEvents_; // events per lumi section
+  std::map<uint64_t, std::deque<uint32_t> >    candidates_;   // counts per lumi section
+  std::map<uint32_t, std::vector<uint32_t> >   masked_;       // detid -> channels
+  std::map<uint64_t, float>                    maskedRates_;
+  unsigned int                                 nMasked_;
+  uint64_t                                     maskDigest_;
+};
+
+
+void SiPixelHotPixelMasker::fill(uint32_t detid, int row, int col)
+{
+  const uint64_t k = key(detid,row,col);
+  const unsigned int width = 1u << widthBits_;
+
+  // conservative update: only the smallest counters are incremented
+  uint32_t current = 0xffffffff;
+  for (unsigned int i = 0; i < depth_; ++i)
+    current = std::min(current, sketch_[i*width + bucket(k,i)]);
+  for (unsigned int i = 0; i < depth_; ++i) {
+    uint32_t & c = sketch_[i*width + bucket(k,i)];
+    if ( c == current ) ++c;
+  }
+
+  // the events of this lumi section so far; MinEvents is for the window
+  const uint32_t threshold = uint32_t( 0.5*maxRate_*nEvents_ );
+  if ( current+1 > threshold && candidates_.find(k) == candidates_.end() )
+    candidates_[k];
+}
+
+#endif
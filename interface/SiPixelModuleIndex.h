@@ -0,0 +1,79 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelModuleIndex_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelModuleIndex_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelModuleIndex
+//! \brief Dense index 0..N-1 of the pixel DetUnits of the geometry.
+//!
+//! Built once per geometry (update() checks the TrackerDigiGeometryRecord),
+//! the DetUnits are numbered in DetId order: the barrel first, layer by
+//! layer, ladder by ladder, then the endcaps.  Each module carries its
+//! offline numbers and, for the barrel, the online (PixelBarrelName)
+//! ladder and module with the sign convention of the analyzers: negative
+//! ladders for x<0 (outer shells), negative modules for z<0.
+//!
+//! Per-module quantities can then live in plain arrays of size() entries
+//! instead of maps or layer switches; index() is a binary search in a
+//! sorted table of DetIds.  The pixel and ROC counts of each module come
+//! from its topology, for per-ROC arrays.
+//----------------------------------------------------------------------------
+
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
+#include "FWCore/Framework/interface/EventSetup.h"
+
+#include <vector>
+#include <stdint.h>
+
+
+class SiPixelModuleIndex
+{
+ public:
+  struct Module {
+    uint32_t detId;
+    int subdet;        // PixelSubdetector::PixelBarrel or PixelEndcap
+    int layer;         // barrel 1-3, 0 in the endcaps
+    int ladder;        // barrel, offline 1-20/32/44
+    int module;        // barrel z index 1-8, endcap module of the panel
+    int ladderName;    // barrel online, -22..-1, 1..22
+    int moduleName;    // barrel online, -4..-1, 1..4
+    bool half;         // barrel half module
+    int side;          // endcaps, 1 for -z, 2 for +z
+    int disk;          // endcaps 1-2, 0 in the barrel
+    int blade;         // endcaps 1-24
+    int panel;         // endcaps 1-2
+    int rows, columns; // pixels
+    int rocRows;       // ROCs along the rows (local x), 1 or 2
+    int rocColumns;    // ROCs along the columns, up to 8
+  };
+
+  SiPixelModuleIndex() : cacheId_(0) {}
+
+  //! Rebuild if the geometry changed, true if it was rebuilt
+  bool update(const edm::EventSetup& es);
+  void build(const TrackerGeometry& geom);
+
+  unsigned int size() const { return modules_.size(); }
+  //! -1 if the DetId is not a pixel DetUnit of the geometry
+  inline int index(uint32_t detId) const;
+  const Module & module(unsigned int i) const { return modules_[i]; }
+  uint32_t detId(unsigned int i) const { return detIds_[i]; }
+
+ private:
+  unsigned long long cacheId_;
+  std::vector<uint32_t> detIds_;     // sorted
+  std::vector<Module> modules_;      // same order
+};
+
+
+int SiPixelModuleIndex::index(uint32_t detId) const
+{
+  unsigned int lo = 0, n = detIds_.size();
+  while ( n > 0 ) {
+    unsigned int half = n/2;
+    if ( detIds_[lo + half] < detId ) { lo += half + 1; n -= half + 1; }
+    else n = half;
+  }
+  return ( lo < detIds_.size() && detIds_[lo] == detId ) ? int(lo) : -1;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_SiPixelOccupancyBitmap_H
+#define RecoLocalTracker_SiPixelClusterizer_SiPixelOccupancyBitmap_H
+
+//----------------------------------------------------------------------------
+//! \class SiPixelOccupancyBitmap
+//! \brief One bit per pixel of a DetUnit, for the clustering without charge.
+//!
+//! Column-major like SiPixelArrayBuffer: the rows of a column are packed
+//! in wordsPerColumn() 64-bit words, so that the runs of fired pixels
+//! along a column can be found with bit operations.
+//!
+//! As for SiPixelArrayBuffer the user has to clear what was set, the
+//! bitmap is only zeroed when its size changes.
+//----------------------------------------------------------------------------
+
+#include <vector>
+#include <stdint.h>
+
+
+class SiPixelOccupancyBitmap
+{
+ public:
+  typedef uint64_t Word;
+
+  SiPixelOccupancyBitmap() : nrows(0), ncols(0), nwords(0) {}
+
+  inline void setSize( int rows, int cols);
+  int rows() const { return nrows;}
+  int columns() const { return ncols;}
+  int wordsPerColumn() const { return nwords;}
+
+  void set( int row, int col) { bits[col*nwords + (row>>6)] |= Word(1) << (row&63); }
+  bool test( int row, int col) const { return (bits[col*nwords + (row>>6)] >> (row&63)) & 1; }
+  //! Zero the whole word holding this pixel
+  void clear_word( int row, int col) { bits[col*nwords + (row>>6)] = 0; }
+
+  //! The words of one column
+  const Word * column( int col) const { return &bits[col*nwords]; }
+
+ private:
+  int nrows;
+  int ncols;
+  int nwords;               // words per column
+  std::vector<Word> bits;
+};
+
+
+void SiPixelOccupancyBitmap::setSize( int rows, int cols)
+{
+  if ( rows == nrows && cols == ncols ) return;
+  nrows = rows;
+  ncols = cols;
+  nwords = (rows+63)/64;
+  bits.assign(nwords*cols, 0);
+}
+
+#endif
@@ -5,8 +5,12 @@
 #include "FWCore/PluginManager/interface/ModuleDef.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterProducer.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibDigiProducer.h"
 //
 using cms::SiPixelClusterProducer;
+using cms::SiPixelCalibDigiProducer;
 
 DEFINE_FWK_MODULE(SiPixelClusterProducer);
+DEFINE_FWK_MODULE(SiPixelCalibDigiProducer);
+
 
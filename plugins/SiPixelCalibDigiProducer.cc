@@ -0,0 +1,106 @@
+/** SiPixelCalibDigiProducer.cc
+ * ---------------------------------------------------------------
+ * Description:  see SiPixelCalibDigiProducer.h
+ * ---------------------------------------------------------------
+ */
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibDigiProducer.h"
+
+// Database payloads
+#include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationService.h"
+#include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationOfflineService.h"
+#include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationForHLTService.h"
+
+// Framework
+#include "DataFormats/Common/interface/Handle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+// STL
+#include <memory>
+#include <string>
+
+// MessageLogger
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
+
+namespace cms
+{
+
+  //---------------------------------------------------------------------------
+  //!  Constructor: make the gain calibration service as the clusterizer does.
+  //---------------------------------------------------------------------------
+  SiPixelCalibDigiProducer::SiPixelCalibDigiProducer(edm::ParameterSet const& conf) 
+    : 
+    conf_(conf),
+    theSiPixelGainCalibration_(0), 
+    calibration_(conf),
+    src_( conf.getParameter<edm::InputTag>( "src" ) ),
+    sortDigis_( conf.getUntrackedParameter<bool>( "SortDigis", false ) )
+  {
+    produces<SiPixelCalibratedDigiCollection>(); 
+
+    std::string payloadType = conf.getParameter<std::string>( "payloadType" );
+
+    if (payloadType == "HLT")
+       theSiPixelGainCalibration_ = new SiPixelGainCalibrationForHLTService(conf);
+    else if (payloadType == "Offline")
+       theSiPixelGainCalibration_ = new SiPixelGainCalibrationOfflineService(conf);
+    else if (payloadType == "Full")
+       theSiPixelGainCalibration_ = new SiPixelGainCalibrationService(conf);
+    else
+      throw cms::Exception("Configuration") << "[SiPixelCalibDigiProducer] payloadType " << payloadType
+					    << " is invalid, possible choices: HLT, Offline, Full";
+  }
+
+  SiPixelCalibDigiProducer::~SiPixelCalibDigiProducer() { 
+    delete theSiPixelGainCalibration_;
+  }  
+
+  void SiPixelCalibDigiProducer::beginJob( ) 
+  {
+    edm::LogInfo("SiPixelCalibDigiProducer") << "[SiPixelCalibDigiProducer::beginJob]";
+    calibration_.setSiPixelGainCalibrationService(theSiPixelGainCalibration_);
+  }
+  
+  //---------------------------------------------------------------------------
+  //! The "Event" entrypoint: gets called by framework for every event
+  //---------------------------------------------------------------------------
+  void SiPixelCalibDigiProducer::produce(edm::Event& e, const edm::EventSetup& es)
+  {
+    //Setup gain calibration service
+    theSiPixelGainCalibration_->setESObjects( es );
+
+    edm::Handle< edm::DetSetVector<PixelDigi> >  input;
+    e.getByLabel( src_, input);
+
+    std::auto_ptr<SiPixelCalibratedDigiCollection> output( new SiPixelCalibratedDigiCollection() );
+    run(*input, *output);
+
+    e.put( output );
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Calibrate every digi, dead and noisy pixels are kept with zero charge
+  //!  so that the clusterizers see exactly what they would have computed.
+  //---------------------------------------------------------------------------
+  void SiPixelCalibDigiProducer::run(const edm::DetSetVector<PixelDigi> & input,
+				     SiPixelCalibratedDigiCollection    & output) {
+    unsigned int nPixels = 0;
+    edm::DetSetVector<PixelDigi>::const_iterator DSViter = input.begin();
+    for( ; DSViter != input.end(); DSViter++) nPixels += DSViter->size();
+    output.reserve(input.size(), nPixels);
+
+    for( DSViter = input.begin(); DSViter != input.end(); DSViter++) {
+      calibration_.setDetId(DSViter->detId());
+      output.beginModule(DSViter->detId());
+      edm::DetSet<PixelDigi>::const_iterator begin = DSViter->begin();
+      edm::DetSet<PixelDigi>::const_iterator end = DSViter->end();
+      if ( sortDigis_ ) sorter_.sort(begin, end);
+      for( edm::DetSet<PixelDigi>::const_iterator di = begin; di != end; ++di) {
+	int row = di->row();
+	int col = di->column();
+	output.push_back(row, col, calibration_.calibrate(di->adc(),col,row));
+      }
+    }
+  }
+
+}  // end of namespace cms
@@ -7,6 +7,12 @@
  * Implementation of the DetSetVector container.    V.Chiochia, May 06
  * SiPixelClusterCollection typedef of DetSetVector V.Chiochia, June 06
  * Introduce the DetSet local container (cache) for speed. d.k. 05/07
+ * Optional input of pre-calibrated pixels (SiPixelCalibDigiProducer).
+ * Optional sharing of the clusters between identical instances.
+ * Optional online masking of hot pixels.
+ * Optional report of time and memory per DetUnit topology.
+ * Optional time budget per event and priority order of the DetUnits.
+ * Optional counting of the clusters only.
  * 
  * ---------------------------------------------------------------
  */
@@ -14,23 +20,31 @@
 // Our own stuff
 #include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterProducer.h"
 #include "RecoLocalTracker/SiPixelClusterizer/interface/PixelThresholdClusterizer.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterCache.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusteringTask.h"
 
 // Geometry
 #include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
+#include "Geometry/CommonTopologies/interface/PixelTopology.h"
 
 // Data Formats
 #include "DataFormats/Common/interface/DetSetVector.h"
 #include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
 #include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
 
 // Database payloads
 #include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationService.h"
 #include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationOfflineService.h"
 #include "CalibTracker/SiPixelESProducers/interface/SiPixelGainCalibrationForHLTService.h"
+#include "CondFormats/DataRecord/interface/SiPixelGainCalibrationRcd.h"
+#include "CondFormats/DataRecord/interface/SiPixelGainCalibrationOfflineRcd.h"
+#include "CondFormats/DataRecord/interface/SiPixelGainCalibrationForHLTRcd.h"
 
 // Framework
 #include "DataFormats/Common/interface/Handle.h"
+#include "DataFormats/Common/interface/OrphanHandle.h"
 #include "FWCore/Framework/interface/ESHandle.h"
 
 // STL
@@ -38,6 +52,13 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
 
 // MessageLogger
 #include "FWCore/MessageLogger/interface/MessageLogger.h"
@@ -52,23 +73,61 @@ namespace cms
     : 
     conf_(conf),
     theSiPixelGainCalibration_(0), 
+    payloadType_( conf.getParameter<std::string>( "payloadType" ) ),
+    gainCacheId_(0),
     clusterMode_("None"),     // bogus
     clusterizer_(0),          // the default, in case we fail to make one
+    maskerOwner_(true),
     readyToCluster_(false),   // since we obviously aren't
     src_( conf.getParameter<edm::InputTag>( "src" ) ),
-    maxTotalClusters_( conf.getParameter<int32_t>( "maxNumberOfClusters" ) )
+    useCalibratedDigis_(false),
+    maxTotalClusters_( conf.getParameter<int32_t>( "maxNumberOfClusters" ) ),
+    shareClusters_( conf.getUntrackedParameter<bool>( "ShareClusters", false ) ),
+    sharedHits_(0),
+    sharedMisses_(0),
+    scalingReport_( conf.getUntrackedParameter<bool>( "ScalingReport", false ) ),
+    timeBudget_(0.),
+    deadlineCheckInterval_(8),
+    incomplete_(false),
+    deadlineHits_(0),
+    countingOnly_( conf.exists("CountingOnly") && conf.getParameter<bool>( "CountingOnly" ) ),
+    countingReport_( conf.getUntrackedParameter<bool>( "CountingReport", false ) ),
+    countingEvents_(0), countingModules_(0), countingWrongModules_(0),
+    countingExact_(0), countingCounted_(0), countingAbsError_(0), countingEventError_(0.)
   {
+    if ( conf.exists("calibratedSrc") ) {
+      calibratedSrc_ = conf.getParameter<edm::InputTag>( "calibratedSrc" );
+      useCalibratedDigis_ = !calibratedSrc_.label().empty();
+    }
+
+    if ( conf.exists("TimeBudget") ) 
+      timeBudget_ = conf.getParameter<double>( "TimeBudget" );
+    if ( conf.exists("DeadlineCheckInterval") ) 
+      deadlineCheckInterval_ = std::max(1, conf.getParameter<int>( "DeadlineCheckInterval" ));
+    if ( conf.exists("ModulePriority") ) 
+      modulePriority_ = conf.getParameter<std::vector<std::string> >( "ModulePriority" );
+
     //--- Declare to the EDM what kind of collections we will be making.
-    produces<SiPixelClusterCollectionNew>(); 
+    if ( countingOnly_ ) {
+      produces<SiPixelClusterCounts>();
+      shareClusters_ = false;
+    }
+    else {
+      produces<SiPixelClusterCollectionNew>(); 
+      if ( timeBudget_ > 0. ) produces<bool>( "Incomplete" );
+    }
+
+    theSiPixelGainCalibration_ = makeGainCalibrationService();
 
-    std::string payloadType = conf.getParameter<std::string>( "payloadType" );
+    if ( shareClusters_ ) configDigest_ = SiPixelClusterCache::configDigest(conf);
 
-    if (strcmp(payloadType.c_str(), "HLT") == 0)
-       theSiPixelGainCalibration_ = new SiPixelGainCalibrationForHLTService(conf);
-    else if (strcmp(payloadType.c_str(), "Offline") == 0)
-       theSiPixelGainCalibration_ = new SiPixelGainCalibrationOfflineService(conf);
-    else if (strcmp(payloadType.c_str(), "Full") == 0)
-       theSiPixelGainCalibration_ = new SiPixelGainCalibrationService(conf);
+    if ( conf.exists("HotPixelMasking") ) {
+      const edm::ParameterSet & maskConf = conf.getParameter<edm::ParameterSet>("HotPixelMasking");
+      if ( shareClusters_ )
+	hotPixelMasker_ = SiPixelClusterCache::instance().masker(configDigest_, maskConf, maskerOwner_);
+      else
+	hotPixelMasker_.reset( new SiPixelHotPixelMasker(maskConf) );
+    }
 
     //--- Make the algorithm(s) according to what the user specified
     //--- in the ParameterSet.
@@ -87,6 +146,79 @@ namespace cms
   {
     edm::LogInfo("SiPixelClusterizer") << "[SiPixelClusterizer::beginJob]";
     clusterizer_->setSiPixelGainCalibrationService(theSiPixelGainCalibration_);
+    clusterizer_->setHotPixelMasker(hotPixelMasker_.get());
+  }
+
+  void SiPixelClusterProducer::endJob( ) 
+  {
+    if ( shareClusters_ )
+      edm::LogInfo("SiPixelClusterizer") << "[SiPixelClusterizer::endJob] clusters shared in " 
+					 << sharedHits_ << " events, made here in "
+					 << sharedMisses_ << " events";
+
+    if ( scalingReport_ && !topologyStats_.empty() ) {
+      std::ostringstream report;
+      report << "[SiPixelClusterizer::endJob] time and memory per DetUnit:";
+      for ( std::map<std::pair<int,int>,TopologyStats>::const_iterator it = topologyStats_.begin();
+	    it != topologyStats_.end(); ++it ) {
+	const TopologyStats & stats = it->second;
+	report << "\n  " << std::setw(5) << it->first.first << " x " << std::setw(5) << it->first.second
+	       << " pixels (" << std::setw(8) << it->first.first*it->first.second << " channels): "
+	       << std::setw(9) << stats.modules << " DetUnits, "
+	       << std::setw(9) << std::setprecision(3) << 1.e6*stats.seconds/stats.modules << " us, "
+	       << std::setw(9) << stats.maxBytes/1024 << " kB";
+      }
+      edm::LogInfo("SiPixelClusterizer") << report.str();
+    }
+
+    if ( countingReport_ && countingModules_ > 0 ) {
+      std::ostringstream report;
+      report << "[SiPixelClusterizer::endJob] cluster counts in " << countingEvents_ << " events, "
+	     << countingModules_ << " DetUnits:"
+	     << "\n  counted " << countingCounted_ << ", clusters " << countingExact_ 
+	     << ", sum of |error| per DetUnit " << countingAbsError_
+	     << " (" << std::setprecision(3) << 100.*countingAbsError_/std::max(countingExact_,1UL) << "%)"
+	     << "\n  " << countingWrongModules_ << " DetUnits with a wrong count ("
+	     << 100.*countingWrongModules_/countingModules_ << "%), mean |error| per event "
+	     << 100.*countingEventError_/std::max(countingEvents_,1UL) << "%";
+      edm::LogInfo("SiPixelClusterizer") << report.str();
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  //! The hot pixel mask changes only between lumi sections
+  //---------------------------------------------------------------------------
+  void SiPixelClusterProducer::endLuminosityBlock(edm::LuminosityBlock& lumi, const edm::EventSetup& es)
+  {
+    if ( hotPixelMasker_ && maskerOwner_ ) hotPixelMasker_->endLumiBlock();
+  }
+
+  //---------------------------------------------------------------------------
+  //! Export the learned mask, appended to a file or to the log
+  //---------------------------------------------------------------------------
+  void SiPixelClusterProducer::endRun(edm::Run& run, const edm::EventSetup& es)
+  {
+    if ( timeBudget_ > 0. ) {
+      edm::LogInfo("SiPixelClusterizer") << "[SiPixelClusterizer::endRun] run " << run.run() << ": "
+					 << deadlineHits_ << " incomplete events (time budget of "
+					 << timeBudget_ << " ms or maxNumberOfClusters)";
+      deadlineHits_ = 0;
+    }
+
+    if ( ! hotPixelMasker_ || ! maskerOwner_ ) return;
+
+    edm::LogInfo("SiPixelClusterizer") << "[SiPixelClusterizer::endRun] run " << run.run() << ": "
+				       << hotPixelMasker_->nMasked() << " pixels masked online";
+    if ( hotPixelMasker_->outputFile().empty() ) {
+      std::ostringstream mask;
+      hotPixelMasker_->write(mask);
+      edm::LogInfo("SiPixelClusterizer") << mask.str();
+    }
+    else {
+      std::ofstream out(hotPixelMasker_->outputFile().c_str(), std::ios::app);
+      out << "# run " << run.run() << "\n";
+      hotPixelMasker_->write(out);
+    }
   }
   
   //---------------------------------------------------------------------------
@@ -95,31 +227,134 @@ namespace cms
   void SiPixelClusterProducer::produce(edm::Event& e, const edm::EventSetup& es)
   {
 
-    //Setup gain calibration service
-    theSiPixelGainCalibration_->setESObjects( es );
-
-   // Step A.1: get input data
-    //edm::Handle<PixelDigiCollection> pixDigis;
-    edm::Handle< edm::DetSetVector<PixelDigi> >  input;
-    e.getByLabel( src_, input);
-
     // Step A.2: get event setup
     edm::ESHandle<TrackerGeometry> geom;
     es.get<TrackerDigiGeometryRecord>().get( geom );
+    if ( timeBudget_ > 0. || !modulePriority_.empty() ) updateModulePriorities( es );
 
     // Step B: create the final output collection
     std::auto_ptr<SiPixelClusterCollectionNew> output( new SiPixelClusterCollectionNew() );
     //FIXME: put a reserve() here
 
-    // Step C: Iterate over DetIds and invoke the pixel clusterizer algorithm
-    // on each DetUnit
-    run(*input, geom, *output );
+    incomplete_ = false;
+    eventId_ = e.id();
+    std::auto_ptr<SiPixelClusterCounts> counts( countingOnly_ ? new SiPixelClusterCounts() : 0 );
+
+    edm::ProductID inputId;
+    if ( useCalibratedDigis_ ) {
+      // Step A.1: get the pixels calibrated upstream, no gain service needed
+      edm::Handle<SiPixelCalibratedDigiCollection> input;
+      e.getByLabel( calibratedSrc_, input);
+      inputId = input.id();
+
+      // Step C: Iterate over DetIds and invoke the pixel clusterizer algorithm
+      if ( !getSharedClusters(e, inputId, *output) ) {
+	// the gains may still be needed for the thresholds in ADC counts
+	if ( clusterizer_ && clusterizer_->needsGainCalibration() ) setupGainCalibration( es, *geom );
+	if ( countingOnly_ ) count(*input, geom, *counts );
+	else run(*input, geom, *output );
+      }
+    }
+    else {
+      // Step A.1: get input data
+      //edm::Handle<PixelDigiCollection> pixDigis;
+      edm::Handle< edm::DetSetVector<PixelDigi> >  input;
+      e.getByLabel( src_, input);
+      inputId = input.id();
+
+      if ( !getSharedClusters(e, inputId, *output) ) {
+	//Setup gain calibration service
+	setupGainCalibration( es, *geom );
+
+	// Step C: Iterate over DetIds and invoke the pixel clusterizer algorithm
+	// on each DetUnit
+	if ( countingOnly_ ) count(*input, geom, *counts );
+	else run(*input, geom, *output );
+      }
+    }
+
+    if ( countingOnly_ ) {
+      e.put( counts );
+      return;
+    }
 
     // Step D: write output to file
-    e.put( output );
+    edm::OrphanHandle<SiPixelClusterCollectionNew> clusters = e.put( output );
+
+    if ( timeBudget_ > 0. ) {
+      if ( incomplete_ ) ++deadlineHits_;
+      std::auto_ptr<bool> incomplete( new bool(incomplete_) );
+      e.put( incomplete, "Incomplete" );
+    }
+
+    // A partial collection is not for sharing
+    if ( shareClusters_ && !incomplete_ ) 
+      SiPixelClusterCache::instance().insert(e.id(), inputId, configDigest_, maskDigest(), clusters.id());
 
   }
 
+  //---------------------------------------------------------------------------
+  //!  Setup the gain calibration service, and let the clusterizer know
+  //!  when the payload changed (e.g. to recompute its threshold tables).
+  //---------------------------------------------------------------------------
+  void SiPixelClusterProducer::setupGainCalibration(const edm::EventSetup& es, const TrackerGeometry& geom) {
+    theSiPixelGainCalibration_->setESObjects( es );
+
+    unsigned long long cacheId = 0;
+    if ( payloadType_ == "HLT" )
+      cacheId = es.get<SiPixelGainCalibrationForHLTRcd>().cacheIdentifier();
+    else if ( payloadType_ == "Offline" )
+      cacheId = es.get<SiPixelGainCalibrationOfflineRcd>().cacheIdentifier();
+    else if ( payloadType_ == "Full" )
+      cacheId = es.get<SiPixelGainCalibrationRcd>().cacheIdentifier();
+
+    if ( cacheId != gainCacheId_ ) {
+      gainCacheId_ = cacheId;
+      if ( clusterizer_ ) clusterizer_->newGainCalibration( geom );
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Look for the clusters of an identical producer in this event, made
+  //!  with the same hot pixel mask.  The output is then a copy of them,
+  //!  instead of clustering again.
+  //---------------------------------------------------------------------------
+  bool SiPixelClusterProducer::getSharedClusters(const edm::Event& e, const edm::ProductID& input,
+						 edmNew::DetSetVector<SiPixelCluster> & output) {
+    if ( ! shareClusters_ ) return false;
+
+    edm::ProductID sharedId;
+    edm::Handle<SiPixelClusterCollectionNew> shared;
+    if ( !SiPixelClusterCache::instance().find(e.id(), input, configDigest_, maskDigest(), sharedId) ||
+	 !e.get(sharedId, shared) ) {
+      ++sharedMisses_;
+      return false;
+    }
+    SiPixelClusterCache::copy(*shared, output);
+    ++sharedHits_;
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+  //!  The mask state the clusters depend on, 0 without masking.
+  //---------------------------------------------------------------------------
+  uint64_t SiPixelClusterProducer::maskDigest() const {
+    return hotPixelMasker_ ? hotPixelMasker_->maskDigest() : 0;
+  }
+
+  //---------------------------------------------------------------------------
+  //!  The gain calibration service for the payloadType.
+  //---------------------------------------------------------------------------
+  SiPixelGainCalibrationServiceBase * SiPixelClusterProducer::makeGainCalibrationService() const {
+    if (strcmp(payloadType_.c_str(), "HLT") == 0)
+       return new SiPixelGainCalibrationForHLTService(conf_);
+    else if (strcmp(payloadType_.c_str(), "Offline") == 0)
+       return new SiPixelGainCalibrationOfflineService(conf_);
+    else if (strcmp(payloadType_.c_str(), "Full") == 0)
+       return new SiPixelGainCalibrationService(conf_);
+    return 0;
+  }
+
   //---------------------------------------------------------------------------
   //!  Set up the specific algorithm we are going to use.  
   //!  TO DO: in the future, we should allow for a different algorithm for 
@@ -148,6 +383,56 @@ namespace cms
   void SiPixelClusterProducer::run(const edm::DetSetVector<PixelDigi>   & input, 
 				   edm::ESHandle<TrackerGeometry>       & geom,
                                    edmNew::DetSetVector<SiPixelCluster> & output) {
+    clusterize(input, geom, output);
+  }
+
+  void SiPixelClusterProducer::run(const SiPixelCalibratedDigiCollection & input, 
+				   edm::ESHandle<TrackerGeometry>       & geom,
+                                   edmNew::DetSetVector<SiPixelCluster> & output) {
+    clusterize(input, geom, output);
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Cluster one DetUnit into the filler.
+  //---------------------------------------------------------------------------
+  template<typename DetUnitInput>
+  void SiPixelClusterProducer::clusterizeModule(const DetUnitInput                   & input, 
+						edm::ESHandle<TrackerGeometry>       & geom,
+						edmNew::DetSetVector<SiPixelCluster>::FastFiller & spc) {
+    std::vector<short> badChannels; 
+    DetId detIdObject(input.detId());
+      
+    // Comment: At the moment the clusterizer depends on geometry
+    // to access information as the pixel topology (number of columns
+    // and rows in a detector module). 
+    // In the future the geometry service will be replaced with
+    // a ES service.
+    const GeomDetUnit      * geoUnit = geom->idToDetUnit( detIdObject );
+    const PixelGeomDetUnit * pixDet  = dynamic_cast<const PixelGeomDetUnit*>(geoUnit);
+    if (! pixDet) {
+      // Fatal error!  TO DO: throw an exception!
+      assert(0);
+    }
+    // Produce clusters for this DetUnit and store them in 
+    // a DetSet
+    if ( scalingReport_ ) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      clusterizer_->clusterizeDetUnit(input, pixDet, badChannels, spc);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      const PixelTopology & topol = pixDet->specificTopology();
+      TopologyStats & stats = topologyStats_[std::make_pair(topol.nrows(),topol.ncolumns())];
+      ++stats.modules;
+      stats.seconds += elapsed.count();
+      stats.maxBytes = std::max(stats.maxBytes, clusterizer_->memoryUsage());
+    } else {
+      clusterizer_->clusterizeDetUnit(input, pixDet, badChannels, spc);
+    }
+  }
+
+  template<typename InputCollection>
+  void SiPixelClusterProducer::clusterize(const InputCollection                & input, 
+					  edm::ESHandle<TrackerGeometry>       & geom,
+					  edmNew::DetSetVector<SiPixelCluster> & output) {
     if ( ! readyToCluster_ ) {
       edm::LogError("SiPixelClusterProducer")
 		<<" at least one clusterizer is not ready -- can't run!" ;
@@ -155,35 +440,26 @@ namespace cms
       return;   // clusterizer is invalid, bail out
     }
 
+    fillHotPixelMasker(input);
+
+    if ( timeBudget_ > 0. || !modulePriority_.empty() ) {
+      clusterizeWithDeadline(input, geom, output);
+      return;
+    }
+
     int numberOfDetUnits = 0;
     int numberOfClusters = 0;
  
     // Iterate on detector units
-    edm::DetSetVector<PixelDigi>::const_iterator DSViter = input.begin();
+    typename InputCollection::const_iterator DSViter = input.begin();
     for( ; DSViter != input.end(); DSViter++) {
       ++numberOfDetUnits;
 
       //  LogDebug takes very long time, get rid off.
       //LogDebug("SiStripClusterizer") << "[SiPixelClusterProducer::run] DetID" << DSViter->id;
 
-      std::vector<short> badChannels; 
-      DetId detIdObject(DSViter->detId());
-      
-      // Comment: At the moment the clusterizer depends on geometry
-      // to access information as the pixel topology (number of columns
-      // and rows in a detector module). 
-      // In the future the geometry service will be replaced with
-      // a ES service.
-      const GeomDetUnit      * geoUnit = geom->idToDetUnit( detIdObject );
-      const PixelGeomDetUnit * pixDet  = dynamic_cast<const PixelGeomDetUnit*>(geoUnit);
-      if (! pixDet) {
-	// Fatal error!  TO DO: throw an exception!
-	assert(0);
-      }
-      // Produce clusters for this DetUnit and store them in 
-      // a DetSet
-      edmNew::DetSetVector<SiPixelCluster>::FastFiller spc(output, DSViter->detId());
-      clusterizer_->clusterizeDetUnit(*DSViter, pixDet, badChannels, spc);
+      edmNew::DetSetVector<SiPixelCluster>::FastFiller spc(output, (*DSViter).detId());
+      clusterizeModule(*DSViter, geom, spc);
       if ( spc.empty() ) {
         spc.abort();
       } else {
@@ -194,6 +470,7 @@ namespace cms
         edm::LogError("TooManyClusters") <<  "Limit on the number of clusters exceeded. An empty cluster collection will be produced instead.\n";
         edmNew::DetSetVector<SiPixelCluster> empty;
         empty.swap(output);
+        incomplete_ = true;   // not for sharing either
         break;
       }
     } // end of DetUnit loop
@@ -203,4 +480,166 @@ namespace cms
     //				    << " SiPixelClusters in " << numberOfDetUnits << " DetUnits."; 
   }
 
+  //---------------------------------------------------------------------------
+  //!  The event and all its pixels for the hot pixel masker, also those of
+  //!  the DetUnits skipped by the time budget.  With sharing, the masker is
+  //!  filled by the instance which clusters and only once per event, the
+  //!  others get the clusters and the mask from it.
+  //!  Before the clustering, the masker is not thread safe.
+  //---------------------------------------------------------------------------
+  template<typename InputCollection>
+  void SiPixelClusterProducer::fillHotPixelMasker(const InputCollection & input) {
+    if ( ! hotPixelMasker_ || ! hotPixelMasker_->newEvent(eventId_) ) return;
+    for ( typename InputCollection::const_iterator it = input.begin(); it != input.end(); ++it )
+      hotPixelMasker_->fill(*it);
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Count the clusters of every DetUnit, and compare with the clusters
+  //!  for the CountingReport.
+  //---------------------------------------------------------------------------
+  template<typename InputCollection>
+  void SiPixelClusterProducer::count(const InputCollection                & input, 
+				     edm::ESHandle<TrackerGeometry>       & geom,
+				     SiPixelClusterCounts                 & counts) {
+    if ( ! readyToCluster_ ) {
+      edm::LogError("SiPixelClusterProducer")
+		<<" at least one clusterizer is not ready -- can't run!" ;
+      return;
+    }
+
+    fillHotPixelMasker(input);
+
+    std::vector<short> badChannels; 
+    unsigned long eventCounted = 0, eventExact = 0;
+    for ( typename InputCollection::const_iterator it = input.begin(); it != input.end(); ++it ) {
+      const PixelGeomDetUnit * pixDet = 
+	dynamic_cast<const PixelGeomDetUnit*>( geom->idToDetUnit( DetId((*it).detId()) ) );
+      if ( !pixDet ) continue;
+
+      int n = clusterizer_->countClusters(*it, pixDet);
+      if ( n > 0 ) counts.push_back((*it).detId(), n);
+
+      if ( countingReport_ ) {
+	edmNew::DetSetVector<SiPixelCluster>::FastFiller spc(countingScratch_, (*it).detId());
+	clusterizer_->clusterizeDetUnit(*it, pixDet, badChannels, spc);
+	int exact = spc.size();
+	spc.abort();
+	++countingModules_;
+	if ( exact != n ) ++countingWrongModules_;
+	countingAbsError_ += std::abs(exact - n);
+	eventCounted += std::max(n, 0);
+	eventExact += exact;
+      }
+    }
+
+    if ( countingReport_ ) {
+      ++countingEvents_;
+      countingCounted_ += eventCounted;
+      countingExact_ += eventExact;
+      if ( eventExact > 0 ) 
+	countingEventError_ += std::fabs(double(eventCounted) - double(eventExact))/eventExact;
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Priority of a DetUnit: its position in ModulePriority, the DetUnits
+  //!  of the groups not listed come last.
+  //---------------------------------------------------------------------------
+  unsigned int SiPixelClusterProducer::priority(uint32_t detid) const {
+    int index = moduleIndex_.index(detid);
+    return index < 0 ? modulePriority_.size() : modulePriorities_[index];
+  }
+
+  void SiPixelClusterProducer::updateModulePriorities(const edm::EventSetup& es) {
+    if ( !moduleIndex_.update(es) ) return;
+    modulePriorities_.resize(moduleIndex_.size());
+    for ( unsigned int i = 0; i < moduleIndex_.size(); ++i ) {
+      const SiPixelModuleIndex::Module & module = moduleIndex_.module(i);
+      std::ostringstream group;
+      if ( module.subdet == PixelSubdetector::PixelBarrel ) 
+	group << "BPix" << module.layer;
+      else
+	group << "FPix" << module.disk;
+      std::vector<std::string>::const_iterator it = 
+	std::find(modulePriority_.begin(), modulePriority_.end(), group.str());
+      modulePriorities_[i] = it - modulePriority_.begin();
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  //!  Same as clusterize(), but the DetUnits are taken in the order of
+  //!  ModulePriority by a SiPixelClusteringTask, which is not resumed
+  //!  once the TimeBudget is used up.  The clusters are kept aside and
+  //!  written in the input order at the end, as the output has to be
+  //!  sorted by DetId.
+  //---------------------------------------------------------------------------
+  template<typename InputCollection>
+  void SiPixelClusterProducer::clusterizeWithDeadline(const InputCollection                & input, 
+						      edm::ESHandle<TrackerGeometry>       & geom,
+						      edmNew::DetSetVector<SiPixelCluster> & output) {
+    typedef typename InputCollection::const_iterator Iterator;
+    typedef SiPixelClusteringTask<InputCollection> Task;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::chrono::duration<double,std::milli> budget(timeBudget_);
+
+    // The DetUnits sorted by priority, the input order is kept within a group
+    std::vector<std::vector<Iterator> > groups(modulePriority_.size()+1);
+    std::vector<std::pair<uint32_t,unsigned int> > inputOrder;
+    for ( Iterator DSViter = input.begin(); DSViter != input.end(); ++DSViter ) {
+      uint32_t detid = (*DSViter).detId();
+      groups[priority(detid)].push_back(DSViter);
+      inputOrder.push_back(std::make_pair(detid, inputOrder.size()));
+    }
+    std::vector<Iterator> order;
+    order.reserve(inputOrder.size());
+    for ( unsigned int g = 0; g < groups.size(); ++g ) 
+      order.insert(order.end(), groups[g].begin(), groups[g].end());
+
+    // The clusters in the order of the priorities, the clock is read
+    // between the batches of DeadlineCheckInterval DetUnits
+    struct Module : public Task::ModuleClusterizer {
+      Module(SiPixelClusterProducer & p, edm::ESHandle<TrackerGeometry> & g) : producer(p), geom(g) {}
+      void clusterize(const typename Task::DetUnit & input, edmNew::DetSetVector<SiPixelCluster>::FastFiller & spc) {
+	producer.clusterizeModule(input, geom, spc);
+      }
+      SiPixelClusterProducer & producer;
+      edm::ESHandle<TrackerGeometry> & geom;
+    } module(*this, geom);
+    edmNew::DetSetVector<SiPixelCluster> byPriority;
+    Task task(module, order, byPriority, deadlineCheckInterval_, maxTotalClusters_);
+    while ( task.resume() ) {
+      if ( timeBudget_ > 0. && std::chrono::steady_clock::now() - start > budget ) {
+	incomplete_ = true;
+	break;
+      }
+    }
+
+    if ( task.tooManyClusters() ) {
+      edm::LogError("TooManyClusters") <<  "Limit on the number of clusters exceeded. An empty cluster collection will be produced instead.\n";
+      incomplete_ = true;   // the empty output is not the clusters of the event
+      return;
+    }
+    if ( incomplete_ )
+      edm::LogWarning("SiPixelClusterProducer") << "time budget of " << timeBudget_ << " ms exhausted after "
+						<< task.numberOfDetUnits() << " of " << order.size() << " DetUnits";
+
+    // Back to the input order
+    std::sort(inputOrder.begin(), inputOrder.end());
+    std::vector<std::pair<unsigned int,edmNew::DetSetVector<SiPixelCluster>::const_iterator> > sets;
+    for ( edmNew::DetSetVector<SiPixelCluster>::const_iterator it = byPriority.begin(); it != byPriority.end(); ++it ) {
+      uint32_t detid = it->detId();
+      sets.push_back(std::make_pair(std::lower_bound(inputOrder.begin(), inputOrder.end(), 
+						     std::make_pair(detid, 0u))->second, it));
+    }
+    std::sort(sets.begin(), sets.end());
+    output.reserve(sets.size(), byPriority.dataSize());
+    for ( unsigned int i = 0; i < sets.size(); ++i ) {
+      edmNew::DetSetVector<SiPixelCluster>::FastFiller spc(output, sets[i].second->detId());
+      for ( edmNew::DetSetVector<SiPixelCluster>::DetSet::const_iterator ci = sets[i].second->begin(); 
+	    ci != sets[i].second->end(); ++ci ) 
+	spc.push_back(*ci);
+    }
+  }
+
 }  // end of namespace cms
@@ -0,0 +1,23 @@
+import FWCore.ParameterSet.Config as cms
+
+#
+# Calibrate the pixel digis once per event.  A clusterizer uses them with
+#   siPixelClusters.calibratedSrc = cms.InputTag("siPixelCalibDigis")
+# in which case its own calibration parameters are not used.
+#
+from CondTools.SiPixel.SiPixelGainCalibrationService_cfi import *
+siPixelCalibDigis = cms.EDProducer("SiPixelCalibDigiProducer",
+    SiPixelGainCalibrationServiceParameters,
+    src = cms.InputTag("siPixelDigis"),
+    MissCalibrate = cms.untracked.bool(True),
+    VCaltoElectronGain = cms.int32(65),
+    VCaltoElectronOffset = cms.int32(-414),
+    # **************************************
+    # ****  payLoadType Options         ****
+    # ****  HLT - column granularity    ****
+    # ****  Offline - gain:col/ped:pix  ****
+    # **************************************
+    payloadType = cms.string('Offline'),
+    # Optional (column, row) order of the pixels of each DetUnit
+    #   SortDigis = cms.untracked.bool(True),
+)
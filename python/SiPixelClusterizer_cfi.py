@@ -19,8 +19,44 @@ siPixelClusters = cms.EDProducer("SiPixelClusterProducer",
     payloadType = cms.string('Offline'),
     SeedThreshold = cms.int32(1000),
     ClusterThreshold = cms.double(4000.0),
+    # Optional thresholds in ADC counts (times the column gain), the
+    # larger of both thresholds is used, e.g.
+    #   ChannelThresholdInADC = cms.double(5.),
+    #   SeedThresholdInADC = cms.double(5.),
+    #   ClusterThresholdInADC = cms.double(10.),
+    # and in units of the noise of the column, sqrt(NoiseInElectrons^2 +
+    # (NoiseInADC*gain)^2), e.g.
+    #   ChannelThresholdInNoiseUnits = cms.double(5.),
+    #   SeedThresholdInNoiseUnits = cms.double(5.),
+    #   ClusterThresholdInNoiseUnits = cms.double(10.),
+    #   NoiseInElectrons = cms.double(150.),
+    #   NoiseInADC = cms.double(0.29),
+    # Optional counting of the clusters only (SiPixelClusterCounts), e.g.
+    #   CountingOnly = cms.bool(True),
+    #   CountingMethod = cms.string('Euler'),       # or 'Components', exact
+    #   CountingThresholds = cms.bool(True),        # False: every digi counts
+    #   CountingReport = cms.untracked.bool(True),  # error against the clusters
+    # Optional (column, row) order of the digis of each DetUnit, for
+    # simulated or mixed inputs
+    #   SortDigis = cms.untracked.bool(True),
     # **************************************
     maxNumberOfClusters = cms.int32(-1), # -1 means no limit.
+    # Optional time budget per event (HLT), the DetUnits beyond it are
+    # skipped and the bool "Incomplete" is set, e.g.
+    #   TimeBudget = cms.double(5.),           # ms, 0 means no limit
+    #   DeadlineCheckInterval = cms.int32(8),  # DetUnits between clock checks
+    #   ModulePriority = cms.vstring('BPix1','BPix2','BPix3','FPix1','FPix2'),
+)
+
+# Online learning and masking of hot pixels, switched on by
+#   siPixelClusters.HotPixelMasking = siPixelHotPixelMasking
+siPixelHotPixelMasking = cms.PSet(
+    MaxRate = cms.double(0.05),                 # fraction of events
+    WindowLumiSections = cms.uint32(5),
+    MinEvents = cms.uint32(200),
+    SketchWidthBits = cms.uint32(18),
+    SketchDepth = cms.uint32(4),
+    OutputFile = cms.untracked.string(''),      # empty: mask goes to the log
 )
 
 
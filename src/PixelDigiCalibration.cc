@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------
+//! \class PixelDigiCalibration
+//! \brief Translate the pixel charge from ADC counts to electrons.
+//!
+//! Moved out of PixelThresholdClusterizer::calibrate() so that the same
+//! conversion can be run once per event by SiPixelCalibDigiProducer.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/PixelDigiCalibration.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/SiPixelDetId/interface/PXBDetId.h"
+
+
+//----------------------------------------------------------------------------
+//! Constructor: read the conversion constants.
+//----------------------------------------------------------------------------
+PixelDigiCalibration::PixelDigiCalibration(edm::ParameterSet const& conf) :
+  theSiPixelGainCalibrationService_(0), detid_(0), theLayer_(0)
+{
+  theConversionFactor =
+    conf.getParameter<int>("VCaltoElectronGain");
+  theOffset =
+    conf.getParameter<int>("VCaltoElectronOffset");
+  if ( conf.exists("AdcFullScaleStack") ) theStackADC_=conf.getParameter<int>("AdcFullScaleStack");
+  else
+    theStackADC_=255;
+  if ( conf.exists("FirstStackLayer") ) theFirstStack_=conf.getParameter<int>("FirstStackLayer");
+  else
+    theFirstStack_=5;
+
+  // Get the constants for the miss-calibration studies
+  doMissCalibrate_=conf.getUntrackedParameter<bool>("MissCalibrate",true);
+}
+
+//----------------------------------------------------------------------------
+//! Cache the DetUnit, the layer is needed for the stack layers only.
+//----------------------------------------------------------------------------
+void PixelDigiCalibration::setDetId(uint32_t detid)
+{
+  detid_ = detid;
+  theLayer_ = 0;
+  if (DetId(detid_).subdetId()==1){ theLayer_ = PXBDetId(detid_).layer();}
+}
+
+//----------------------------------------------------------------------------
+// Calibrate adc counts to electrons
+//-----------------------------------------------------------------
+int PixelDigiCalibration::calibrate(int adc, int col, int row) const
+{
+  int electrons = 0;
+
+  if ( doMissCalibrate_ )
+    {
+      // do not perform calibration if pixel is dead!
+
+      if ( !theSiPixelGainCalibrationService_->isDead(detid_,col,row) &&
+	   !theSiPixelGainCalibrationService_->isNoisy(detid_,col,row) )
+	{
+
+	  // Linear approximation of the TANH response
+	  // Pixel(0,0,0)
+	  //const float gain = 2.95; // 1 ADC = 2.95 VCALs (1/0.339)
+	  //const float pedestal = -83.; // -28/0.339
+	  // Roc-0 average
+	  //const float gain = 1./0.357; // 1 ADC = 2.80 VCALs
+	  //const float pedestal = -28.2 * gain; // -79.
+
+	  float DBgain     = theSiPixelGainCalibrationService_->getGain(detid_, col, row);
+	  float DBpedestal = theSiPixelGainCalibrationService_->getPedestal(detid_, col, row) * DBgain;
+
+
+	  // Roc-6 average
+	  //const float gain = 1./0.313; // 1 ADC = 3.19 VCALs
+	  //const float pedestal = -6.2 * gain; // -19.8
+	  //
+	  float vcal = adc * DBgain - DBpedestal;
+
+	  // atanh calibration
+	  // Roc-6 average
+	  //const float p0 = 0.00492;
+	  //const float p1 = 1.998;
+	  //const float p2 = 90.6;
+	  //const float p3 = 134.1;
+	  // Roc-6 average
+	  //const float p0 = 0.00382;
+	  //const float p1 = 0.886;
+	  //const float p2 = 112.7;
+	  //const float p3 = 113.0;
+	  //float vcal = ( atanh( (adc-p3)/p2) + p1)/p0;
+
+	  electrons = int( vcal * theConversionFactor + theOffset);
+	}
+    }
+  else
+    { // No misscalibration in the digitizer
+      // Simple (default) linear gain
+      const float gain = 135.; // 1 ADC = 135 electrons
+      const float pedestal = 0.; //
+      electrons = int(adc * gain + pedestal);
+      if (theLayer_>=theFirstStack_) {
+	if (theStackADC_==1&&adc==1)
+	  {
+	    electrons = int(255*135); // Arbitrarily use overflow value.
+	  }
+	if (theStackADC_>1&&theStackADC_!=255&&adc>=1)
+	  {
+	    const float gain = 135.; // 1 ADC = 135 electrons
+	    electrons = int((adc-1) * gain * 255/float(theStackADC_-1));
+	  }
+      }
+    }
+
+  return electrons;
+}
+
+//----------------------------------------------------------------------------
+// Slope of the ADC -> electrons conversion, used to express the noise
+// in electrons
+//-----------------------------------------------------------------
+float PixelDigiCalibration::electronsPerADC(int col, int row) const
+{
+  if ( !doMissCalibrate_ ) return 135.;
+
+  if ( theSiPixelGainCalibrationService_->isDead(detid_,col,row) ||
+       theSiPixelGainCalibrationService_->isNoisy(detid_,col,row) ) return 0.;
+
+  return theSiPixelGainCalibrationService_->getGain(detid_, col, row) * theConversionFactor;
+}
@@ -25,14 +25,18 @@
 #include "CondFormats/SiPixelObjects/interface/SiPixelGainCalibrationOffline.h"
 // Geometry
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
+#include "Geometry/TrackerGeometryBuilder/interface/TrackerGeometry.h"
 #include "Geometry/CommonTopologies/interface/PixelTopology.h"
 //#include "Geometry/CommonTopologies/RectangularPixelTopology.h"
-#include "DataFormats/SiPixelDetId/interface/PXBDetId.h"
+// MessageLogger
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 
 // STL
 #include <stack>
 #include <vector>
 #include <iostream>
+#include <limits>
+#include <cmath>
 using namespace std;
 
 //----------------------------------------------------------------------------
@@ -42,7 +46,9 @@ using namespace std;
 //----------------------------------------------------------------------------
 PixelThresholdClusterizer::PixelThresholdClusterizer
   (edm::ParameterSet const& conf) :
-    conf_(conf), bufferAlreadySet(false), theNumOfRows(0), theNumOfCols(0), detid_(0) 
+    conf_(conf), bufferAlreadySet(false), 
+    thePixelThresholds(0), theSeedThresholds(0), theMinPixelThreshold(0), theModuleClusterThreshold(0),
+    theNumOfRows(0), theNumOfCols(0), detid_(0), calibratedInput_(false), theMaskedPixels_(0), theCalibration(conf)
 {
   // Get thresholds in electrons
   thePixelThreshold   = 
@@ -51,25 +57,77 @@ PixelThresholdClusterizer::PixelThresholdClusterizer
     conf_.getParameter<int>("SeedThreshold");
   theClusterThreshold = 
     conf_.getParameter<double>("ClusterThreshold");
-  theConversionFactor = 
-    conf_.getParameter<int>("VCaltoElectronGain");
-  theOffset = 
-    conf_.getParameter<int>("VCaltoElectronOffset");
-  if ( conf_.exists("AdcFullScaleStack") ) theStackADC_=conf_.getParameter<int>("AdcFullScaleStack");
-  else 
-    theStackADC_=255;
-  if ( conf_.exists("FirstStackLayer") ) theFirstStack_=conf_.getParameter<int>("FirstStackLayer");
-  else
-    theFirstStack_=5;
+
+  // Optional thresholds in ADC counts, converted with the gains, 0 = not used
+  thePixelThresholdInADC = 
+    conf_.exists("ChannelThresholdInADC") ? conf_.getParameter<double>("ChannelThresholdInADC") : 0.;
+  theSeedThresholdInADC = 
+    conf_.exists("SeedThresholdInADC") ? conf_.getParameter<double>("SeedThresholdInADC") : 0.;
+  theClusterThresholdInADC = 
+    conf_.exists("ClusterThresholdInADC") ? conf_.getParameter<double>("ClusterThresholdInADC") : 0.;
+  doADCThresholds = ( thePixelThresholdInADC > 0. || 
+		      theSeedThresholdInADC > 0. || 
+		      theClusterThresholdInADC > 0. );
+
+  // Optional thresholds in units of the noise, 0 = not used
+  thePixelThresholdInNoiseUnits = 
+    conf_.exists("ChannelThresholdInNoiseUnits") ? conf_.getParameter<double>("ChannelThresholdInNoiseUnits") : 0.;
+  theSeedThresholdInNoiseUnits = 
+    conf_.exists("SeedThresholdInNoiseUnits") ? conf_.getParameter<double>("SeedThresholdInNoiseUnits") : 0.;
+  theClusterThresholdInNoiseUnits = 
+    conf_.exists("ClusterThresholdInNoiseUnits") ? conf_.getParameter<double>("ClusterThresholdInNoiseUnits") : 0.;
+  theNoiseInElectrons = 
+    conf_.exists("NoiseInElectrons") ? conf_.getParameter<double>("NoiseInElectrons") : 0.;
+  theNoiseInADC = 
+    conf_.exists("NoiseInADC") ? conf_.getParameter<double>("NoiseInADC") : 1./std::sqrt(12.);
+  doNoiseThresholds = ( thePixelThresholdInNoiseUnits > 0. || 
+			theSeedThresholdInNoiseUnits > 0. || 
+			theClusterThresholdInNoiseUnits > 0. );
   
   // Get the constants for the miss-calibration studies
-  doMissCalibrate=conf_.getUntrackedParameter<bool>("MissCalibrate",true); 
+  doMissCalibrate = theCalibration.doMissCalibrate();
   doSplitClusters = conf.getParameter<bool>("SplitClusters");
+  doSortDigis = conf.getUntrackedParameter<bool>("SortDigis",false);
   theBuffer.setSize( theNumOfRows, theNumOfCols );
+  theKernel = select_kernel( theNumOfRows, theNumOfCols );
+
+  // Counting only
+  theCounting = EulerCounting;
+  std::string counting = 
+    conf_.exists("CountingMethod") ? conf_.getParameter<std::string>("CountingMethod") : "Euler";
+  if ( counting == "Components" ) 
+    theCounting = ComponentCounting;
+  else if ( counting != "Euler" ) 
+    edm::LogError("PixelThresholdClusterizer") << "CountingMethod " << counting 
+					       << " is invalid, possible choices: Euler, Components";
+  doCountingThresholds = 
+    conf_.exists("CountingThresholds") ? conf_.getParameter<bool>("CountingThresholds") : true;
 }
 /////////////////////////////////////////////////////////////////////////////
 PixelThresholdClusterizer::~PixelThresholdClusterizer() {}
 
+//----------------------------------------------------------------------------
+//!  The calibration needs the gain service as well.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::setSiPixelGainCalibrationService( SiPixelGainCalibrationServiceBase* in)
+{
+  theSiPixelGainCalibrationService_ = in;
+  theCalibration.setSiPixelGainCalibrationService(in);
+}
+
+//----------------------------------------------------------------------------
+//!  Memory held for the current DetUnit: the pixel buffer, the occupancy
+//!  bitmap and the threshold table.
+//----------------------------------------------------------------------------
+std::size_t PixelThresholdClusterizer::memoryUsage() const 
+{
+  std::size_t bytes = std::size_t(theNumOfRows)*theNumOfCols*sizeof(int);
+  if ( binary_readout() ) 
+    bytes += std::size_t((theNumOfRows+63)/64)*theNumOfCols*sizeof(SiPixelOccupancyBitmap::Word);
+  if ( doADCThresholds || doNoiseThresholds ) bytes += 2*theNumOfCols*sizeof(int);
+  return bytes;
+}
+
 //----------------------------------------------------------------------------
 //!  Prepare the Clusterizer to work on a particular DetUnit.  Re-init the
 //!  size of the panel/plaquette (so update nrows and ncols), 
@@ -83,24 +141,143 @@ bool PixelThresholdClusterizer::setup(const PixelGeomDetUnit * pixDet)
   int nrows = topol.nrows();      // rows in x
   int ncols = topol.ncolumns();   // cols in y
   
+  return setup(nrows, ncols);
+}
+
+bool PixelThresholdClusterizer::setup(int nrows, int ncols) 
+{
+  // The pixel coordinates of the clusters are unsigned shorts.
+  if ( nrows > std::numeric_limits<unsigned short>::max() || 
+       ncols > std::numeric_limits<unsigned short>::max() ) 
+    {
+      edm::LogError("PixelThresholdClusterizer") 
+	<< "DetUnit of " << nrows << " x " << ncols 
+	<< " pixels is too large for the cluster coordinates, skipped";
+      return false;
+    }
+  
   theNumOfRows = nrows;  // Set new sizes
   theNumOfCols = ncols;
   
-  if ( nrows > theBuffer.rows() || 
-       ncols > theBuffer.columns() ) 
-    { // change only when a larger is needed
-      //if( nrows != theNumOfRows || ncols != theNumOfCols ) {
-      //cout << " PixelThresholdClusterizer: pixel buffer redefined to " 
-      // << nrows << " * " << ncols << endl;      
-      //theNumOfRows = nrows;  // Set new sizes
-      //theNumOfCols = ncols;
-      // Resize the buffer
-      theBuffer.setSize(nrows,ncols);  // Modify
-      bufferAlreadySet = true;
-    }
+  // The buffer is empty here, so it can take the exact size of this
+  // DetUnit; the memory is only reallocated when a larger one is needed.
+  //cout << " PixelThresholdClusterizer: pixel buffer redefined to " 
+  // << nrows << " * " << ncols << endl;      
+  theBuffer.reshape(nrows,ncols);
+  bufferAlreadySet = true;
+  
+  theKernel = select_kernel(nrows,ncols);
   
   return true;   
 }
+
+//----------------------------------------------------------------------------
+//!  New gain IOV: the threshold tables of all the pixel DetUnits, with
+//!  the ROC size of their topology.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::newGainCalibration( const TrackerGeometry & geom )
+{
+  theThresholdTables.clear();
+  if ( !doADCThresholds && !doNoiseThresholds ) return;
+
+  for (TrackerGeometry::DetUnitContainer::const_iterator it = geom.detUnits().begin(); 
+       it != geom.detUnits().end(); ++it) 
+    {
+      const PixelGeomDetUnit * pixDet = dynamic_cast<const PixelGeomDetUnit*>(*it);
+      if ( !pixDet ) continue;
+      const PixelTopology & topol = pixDet->specificTopology();
+      const uint32_t detid = pixDet->geographicalId().rawId();
+      make_threshold_table( detid, topol.nrows(), topol.ncolumns(), topol.rowsperroc(), 
+			    theThresholdTables[detid] );
+    }
+}
+
+//----------------------------------------------------------------------------
+//!  Select the thresholds of the current DetUnit: the table made for it at
+//!  the gain IOV, or the flat thresholds shared by all DetUnits without
+//!  thresholds in ADC counts or noise units.  A DetUnit without table
+//!  (not in the geometry given at the IOV) has the flat thresholds too.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::setup_thresholds()
+{
+  if ( int(theFlatThresholds.pixel.size()) < theNumOfCols ) 
+    {
+      theFlatThresholds.pixel.assign(theNumOfCols, thePixelThreshold);
+      theFlatThresholds.seed.assign(theNumOfCols, theSeedThreshold);
+      theFlatThresholds.minPixel = thePixelThreshold;
+      theFlatThresholds.cluster = theClusterThreshold;
+    }
+
+  const ThresholdTable * table = &theFlatThresholds;
+  if ( doADCThresholds || doNoiseThresholds ) 
+    {
+      std::map<uint32_t,ThresholdTable>::const_iterator it = theThresholdTables.find(detid_);
+      if ( it != theThresholdTables.end() && int(it->second.pixel.size()) == theNumOfCols ) 
+	table = &it->second;
+    }
+  
+  thePixelThresholds = &table->pixel[0];
+  theSeedThresholds = &table->seed[0];
+  theMinPixelThreshold = table->minPixel;
+  theModuleClusterThreshold = table->cluster;
+}
+
+//----------------------------------------------------------------------------
+//!  Thresholds per column: the largest of the threshold in electrons, the
+//!  threshold in ADC counts times the gain of the column and the threshold
+//!  in noise units times the noise of the column.  The gain payloads have
+//!  at most column granularity within a ROC, so the gain of a column is
+//!  the mean over its ROCs, each taken at its first good pixel; the noise
+//!  of a ROC is sqrt(NoiseInElectrons^2 + (NoiseInADC*gain)^2), averaged
+//!  the same way.  The cluster threshold uses the mean gain and noise of
+//!  the DetUnit.  Columns without a good pixel are switched off.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::make_threshold_table( uint32_t detid, int nrows, int ncols, int rowsPerROC, 
+						      ThresholdTable & table )
+{
+  if ( rowsPerROC <= 0 ) rowsPerROC = nrows;
+  theCalibration.setDetId(detid);
+  table.pixel.assign(ncols, std::numeric_limits<int>::max());
+  table.seed.assign(ncols, std::numeric_limits<int>::max());
+  table.minPixel = std::numeric_limits<int>::max();
+  
+  float sumGain = 0., sumNoise = 0.;
+  int nGood = 0;
+  for (int col = 0; col < ncols; ++col) 
+    {
+      float colGain = 0., colNoise = 0.;
+      int nROCs = 0;
+      for (int first = 0; first < nrows; first += rowsPerROC) 
+	{
+	  const int last = std::min(first + rowsPerROC, nrows);
+	  float gain = 0.;
+	  for (int row = first; row < last && gain <= 0.; ++row) 
+	    gain = theCalibration.electronsPerADC(col,row);
+	  if ( gain <= 0. ) continue;
+	  colGain += gain;
+	  colNoise += std::sqrt(theNoiseInElectrons*theNoiseInElectrons + 
+				theNoiseInADC*gain*theNoiseInADC*gain);
+	  ++nROCs;
+	}
+      if ( nROCs == 0 ) continue;
+      colGain /= nROCs;
+      colNoise /= nROCs;
+      
+      table.pixel[col] = std::max(thePixelThreshold, int(thePixelThresholdInADC * colGain));
+      table.pixel[col] = std::max(table.pixel[col], int(thePixelThresholdInNoiseUnits * colNoise));
+      table.seed[col]  = std::max(theSeedThreshold,  int(theSeedThresholdInADC * colGain));
+      table.seed[col]  = std::max(table.seed[col],  int(theSeedThresholdInNoiseUnits * colNoise));
+      table.minPixel = std::min(table.minPixel, table.pixel[col]);
+      sumGain += colGain;
+      sumNoise += colNoise;
+      ++nGood;
+    }
+  
+  table.cluster = theClusterThreshold;
+  if ( nGood > 0 ) 
+    table.cluster = std::max(theClusterThreshold, std::max(theClusterThresholdInADC * sumGain/nGood,
+							   theClusterThresholdInNoiseUnits * sumNoise/nGood));
+}
 //----------------------------------------------------------------------------
 //!  \brief Cluster pixels.
 //!  This method operates on a matrix of pixels
@@ -120,15 +297,108 @@ void PixelThresholdClusterizer::clusterizeDetUnit( const edm::DetSet<PixelDigi>
   //if (begin == end) cout << " PixelThresholdClusterizer::clusterizeDetUnit - No digis to clusterize";
   
   //  Set up the clusterization on this DetId.
-  if ( !setup(pixDet) ) 
+  if ( !begin_detunit(input.detId(), pixDet, false) ) 
     return;
+  if ( doSortDigis ) theSorter.sort(begin, end);
   
-  detid_ = input.detId();
+  //  Binary readout layers are done without the matrix
+  if ( binary_readout() && clusterize_binary(begin, end, output) ) 
+    return;
   
   //  Copy PixelDigis to the buffer array; select the seed pixels
   //  on the way, and store them in theSeeds.
   copy_to_buffer(begin, end);
   
+  (this->*theKernel)(output);
+  
+  //  Need to clean unused pixels from the buffer array.
+  clear_buffer(begin, end);
+  
+}
+
+//----------------------------------------------------------------------------
+//!  \brief Cluster pixels which were calibrated beforehand.
+//!  Same as above, the charges are taken as they are and the gain
+//!  calibration service is not used.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::clusterizeDetUnit( const SiPixelCalibratedDigiCollection::Module & input,
+						   const PixelGeomDetUnit * pixDet,
+						   const std::vector<short>& badChannels,
+                                                   edmNew::DetSetVector<SiPixelCluster>::FastFiller& output) {
+  
+  if ( !begin_detunit(input.detId(), pixDet, true) ) 
+    return;
+  
+  copy_to_buffer(input);
+  (this->*theKernel)(output);
+  clear_buffer(input);
+}
+
+//----------------------------------------------------------------------------
+//!  Everything which depends on the DetUnit only: sizes, calibration,
+//!  masked pixels and thresholds.  The DetId and layer of the calibration
+//!  are set for calibrated input too (it is cheap), so that no reader of
+//!  theCalibration sees those of a previous DetUnit.
+//----------------------------------------------------------------------------
+bool PixelThresholdClusterizer::begin_detunit( uint32_t detid, const PixelGeomDetUnit * pixDet, bool calibrated ) 
+{
+  if ( !setup(pixDet) ) 
+    return false;
+  
+  return begin_detunit(detid, calibrated);
+}
+
+bool PixelThresholdClusterizer::begin_detunit( uint32_t detid, bool calibrated ) 
+{
+  detid_ = detid;
+  calibratedInput_ = calibrated;
+  theCalibration.setDetId(detid_);
+  theMaskedPixels_ = theHotPixelMasker_ ? theHotPixelMasker_->maskedPixels(detid_) : 0;
+  setup_thresholds();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//!  \brief The topology table: the cluster search instantiated for each
+//!  known DetUnit size, the runtime version for the others.
+//----------------------------------------------------------------------------
+PixelThresholdClusterizer::Kernel 
+PixelThresholdClusterizer::select_kernel( int nrows, int ncols ) 
+{
+  static const struct { int rows; int cols; Kernel kernel; } kernels[] = {
+    { 160, 416, &PixelThresholdClusterizer::make_clusters_fixed<160,416> },  // BPix full module
+    {  80, 416, &PixelThresholdClusterizer::make_clusters_fixed< 80,416> },  // BPix half module
+    {  80, 104, &PixelThresholdClusterizer::make_clusters_fixed< 80,104> },  // FPix 1x2
+    {  80, 260, &PixelThresholdClusterizer::make_clusters_fixed< 80,260> },  // FPix 1x5
+    { 160, 156, &PixelThresholdClusterizer::make_clusters_fixed<160,156> },  // FPix 2x3
+    { 160, 208, &PixelThresholdClusterizer::make_clusters_fixed<160,208> },  // FPix 2x4
+    { 160, 260, &PixelThresholdClusterizer::make_clusters_fixed<160,260> }   // FPix 2x5
+  };
+  for (unsigned int i = 0; i < sizeof(kernels)/sizeof(kernels[0]); ++i) 
+    if ( kernels[i].rows == nrows && kernels[i].cols == ncols ) return kernels[i].kernel;
+  return &PixelThresholdClusterizer::make_clusters_runtime;
+}
+
+template<int NROWS, int NCOLS>
+void PixelThresholdClusterizer::make_clusters_fixed( edmNew::DetSetVector<SiPixelCluster>::FastFiller& output ) 
+{
+  make_clusters( SiPixelFixedTopology<NROWS,NCOLS>(), output );
+}
+
+void PixelThresholdClusterizer::make_clusters_runtime( edmNew::DetSetVector<SiPixelCluster>::FastFiller& output ) 
+{
+  make_clusters( SiPixelRuntimeTopology(theNumOfRows,theNumOfCols), output );
+}
+
+//----------------------------------------------------------------------------
+//!  \brief Make the clusters around the seeds found by copy_to_buffer().
+//----------------------------------------------------------------------------
+template<class Topology>
+void PixelThresholdClusterizer::make_clusters( const Topology& topo,
+					       edmNew::DetSetVector<SiPixelCluster>::FastFiller& output ) 
+{
+  const int * buffer = theBuffer.data();
+  
   //  At this point we know the number of seeds on this DetUnit, and thus
   //  also the maximal number of possible clusters, so resize theClusters
   //  in order to make vector<>::push_back() efficient.
@@ -142,14 +412,15 @@ void PixelThresholdClusterizer::clusterizeDetUnit( const edm::DetSet<PixelDigi>
       
       // Gavril : The charge of seeds that were already inlcuded in clusters is set to 1 electron
       // so we don't want to call "make_cluster" for these cases 
-      if ( theBuffer(theSeeds[i]) >= theSeedThreshold ) 
+      const SiPixelCluster::PixelPos & seed = theSeeds[i];
+      if ( buffer[topo.index(seed.row(),seed.col())] >= theSeedThresholds[seed.col()] ) 
 	{  // Is this seed still valid?
 	  //  Make a cluster around this seed
-	  SiPixelCluster cluster = make_cluster( theSeeds[i] , output);
+	  SiPixelCluster cluster = make_cluster( topo, seed, output);
 	  
 	  //  Check if the cluster is above threshold  
 	  // (TO DO: one is signed, other unsigned, gcc warns...)
-	  if ( cluster.charge() >= theClusterThreshold) 
+	  if ( cluster.charge() >= theModuleClusterThreshold) 
 	    {
 	      //	cout << "putting in this cluster" << endl;
 	      output.push_back( cluster );
@@ -159,10 +430,6 @@ void PixelThresholdClusterizer::clusterizeDetUnit( const edm::DetSet<PixelDigi>
   
   // Erase the seeds.
   theSeeds.clear();
-  
-  //  Need to clean unused pixels from the buffer array.
-  clear_buffer(begin, end);
-  
 }
 
 //----------------------------------------------------------------------------
@@ -191,11 +458,12 @@ void PixelThresholdClusterizer::copy_to_buffer( DigiIterator begin, DigiIterator
     {
       int row = di->row();
       int col = di->column();
+      if ( theMaskedPixels_ && isMasked(row,col) ) continue;
       int adc = calibrate(di->adc(),col,row); // convert ADC -> electrons
-      if ( adc >= thePixelThreshold) 
+      if ( adc >= thePixelThresholds[col]) 
 	{
 	  theBuffer.set_adc( row, col, adc);
-	  if ( adc >= theSeedThreshold) 
+	  if ( adc >= theSeedThresholds[col]) 
 	    { 
 	      theSeeds.push_back( SiPixelCluster::PixelPos(row,col) );
 	    }
@@ -204,76 +472,339 @@ void PixelThresholdClusterizer::copy_to_buffer( DigiIterator begin, DigiIterator
 }
 
 //----------------------------------------------------------------------------
-// Calibrate adc counts to electrons
-//-----------------------------------------------------------------
-int PixelThresholdClusterizer::calibrate(int adc, int col, int row) 
+//! \brief Same for pixels which are already in electrons.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::clear_buffer( const SiPixelCalibratedDigiCollection::Module & input ) 
 {
-  int electrons = 0;
-  int layer= 0;
-  if (DetId(detid_).subdetId()==1){ layer = PXBDetId(detid_).layer();}
+  for (unsigned int i = 0; i != input.size(); ++i) 
+    {
+      theBuffer.set_adc( input.row(i), input.column(i), 0 );
+    }
+}
 
-  if ( doMissCalibrate ) 
+void PixelThresholdClusterizer::copy_to_buffer( const SiPixelCalibratedDigiCollection::Module & input ) 
+{
+  for (unsigned int i = 0; i != input.size(); ++i) 
     {
-      // do not perform calibration if pixel is dead!
-      
-      if ( !theSiPixelGainCalibrationService_->isDead(detid_,col,row) && 
-	   !theSiPixelGainCalibrationService_->isNoisy(detid_,col,row) )
+      int col = input.column(i);
+      int adc = input.electrons(i);
+      if ( adc >= thePixelThresholds[col]) 
 	{
+	  int row = input.row(i);
+	  if ( theMaskedPixels_ && isMasked(row,col) ) continue;
+	  theBuffer.set_adc( row, col, adc);
+	  if ( adc >= theSeedThresholds[col]) 
+	    { 
+	      theSeeds.push_back( SiPixelCluster::PixelPos(row,col) );
+	    }
+	}
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//!  \brief Count the clusters of a DetUnit on the occupancy bitmap.
+//!  Neither the seed nor the cluster threshold is applied, nor the pixel
+//!  threshold with CountingThresholds=false (no calibration at all then).
+//----------------------------------------------------------------------------
+int PixelThresholdClusterizer::countClusters( const edm::DetSet<PixelDigi> & input, const PixelGeomDetUnit * pixDet ) 
+{
+  if ( !begin_detunit(input.detId(), pixDet, false) ) 
+    return 0;
+  
+  theBitmap.setSize( theNumOfRows, theNumOfCols );
+  int minCol = theNumOfCols;
+  int maxCol = -1;
+  for ( DigiIterator di = input.begin(); di != input.end(); ++di ) 
+    {
+      int row = di->row();
+      int col = di->column();
+      if ( theMaskedPixels_ && isMasked(row,col) ) continue;
+      if ( doCountingThresholds && calibrate(di->adc(),col,row) < thePixelThresholds[col] ) continue;
+      theBitmap.set(row,col);
+      minCol = std::min(minCol,col);
+      maxCol = std::max(maxCol,col);
+    }
+  int count = count_bitmap(minCol, maxCol);
+  for ( DigiIterator di = input.begin(); di != input.end(); ++di ) 
+    theBitmap.clear_word( di->row(), di->column() );
+  return count;
+}
+
+int PixelThresholdClusterizer::countClusters( const SiPixelCalibratedDigiCollection::Module & input, 
+					      const PixelGeomDetUnit * pixDet ) 
+{
+  if ( !begin_detunit(input.detId(), pixDet, true) ) 
+    return 0;
+  
+  theBitmap.setSize( theNumOfRows, theNumOfCols );
+  int minCol = theNumOfCols;
+  int maxCol = -1;
+  for (unsigned int i = 0; i != input.size(); ++i) 
+    {
+      int row = input.row(i);
+      int col = input.column(i);
+      if ( theMaskedPixels_ && isMasked(row,col) ) continue;
+      if ( doCountingThresholds && input.electrons(i) < thePixelThresholds[col] ) continue;
+      theBitmap.set(row,col);
+      minCol = std::min(minCol,col);
+      maxCol = std::max(maxCol,col);
+    }
+  int count = count_bitmap(minCol, maxCol);
+  for (unsigned int i = 0; i != input.size(); ++i) 
+    theBitmap.clear_word( input.row(i), input.column(i) );
+  return count;
+}
+
+int PixelThresholdClusterizer::count_bitmap( int minCol, int maxCol ) 
+{
+  if ( maxCol < minCol ) return 0;
+  if ( theCounting == EulerCounting ) return euler_number(minCol, maxCol);
+  
+  bitmap_runs(minCol, maxCol);
+  int count = 0;
+  for (unsigned int i = 0; i < theRuns.size(); ++i) 
+    if ( find_run(i) == int(i) ) ++count;
+  return count;
+}
+
+//----------------------------------------------------------------------------
+//!  \brief Euler number (8-connectivity) of the fired pixels.
+//!
+//!  Sets minus holes = (Q1 - Q3 - 2 QD)/4, with Q1 (Q3) the number of 2x2
+//!  windows holding one (three) fired pixels and QD those holding two on a
+//!  diagonal, the windows overlapping the border included.  The windows of
+//!  two neighbour columns are classified for 64 rows at once: bit k of a
+//!  word stands for the window of rows k-1 and k.  Holes need a ring of 8
+//!  pixels, so this is the number of clusters but in dense DetUnits.
+//----------------------------------------------------------------------------
+int PixelThresholdClusterizer::euler_number( int minCol, int maxCol ) const 
+{
+  typedef SiPixelOccupancyBitmap::Word Word;
+  const int nwords = theBitmap.wordsPerColumn();
+  const bool fullWord = ( theNumOfRows == 64*nwords );   // one more window below
+  long q1 = 0, q3 = 0, qd = 0;
+  for (int col = minCol-1; col <= maxCol; ++col) 
+    {
+      const Word * left  = ( col >= minCol ) ? theBitmap.column(col) : 0;
+      const Word * right = ( col+1 <= maxCol ) ? theBitmap.column(col+1) : 0;
+      Word leftCarry = 0, rightCarry = 0;
+      for (int iw = 0; iw <= nwords; ++iw) 
+	{
+	  if ( iw == nwords && !fullWord ) break;
+	  Word a1 = ( left && iw < nwords ) ? left[iw] : 0;
+	  Word b1 = ( right && iw < nwords ) ? right[iw] : 0;
+	  Word a0 = (a1 << 1) | leftCarry;    // the row above
+	  Word b0 = (b1 << 1) | rightCarry;
+	  leftCarry = a1 >> 63;
+	  rightCarry = b1 >> 63;
 	  
-	  // Linear approximation of the TANH response
-	  // Pixel(0,0,0)
-	  //const float gain = 2.95; // 1 ADC = 2.95 VCALs (1/0.339)
-	  //const float pedestal = -83.; // -28/0.339
-	  // Roc-0 average
-	  //const float gain = 1./0.357; // 1 ADC = 2.80 VCALs 
-	  //const float pedestal = -28.2 * gain; // -79.
-	  
-	  float DBgain     = theSiPixelGainCalibrationService_->getGain(detid_, col, row);
-	  float DBpedestal = theSiPixelGainCalibrationService_->getPedestal(detid_, col, row) * DBgain;
-	  
-	  
-	  // Roc-6 average
-	  //const float gain = 1./0.313; // 1 ADC = 3.19 VCALs 
-	  //const float pedestal = -6.2 * gain; // -19.8
-	  // 
-	  float vcal = adc * DBgain - DBpedestal;
-	  
-	  // atanh calibration 
-	  // Roc-6 average
-	  //const float p0 = 0.00492;
-	  //const float p1 = 1.998;
-	  //const float p2 = 90.6;
-	  //const float p3 = 134.1; 
-	  // Roc-6 average
-	  //const float p0 = 0.00382;
-	  //const float p1 = 0.886;
-	  //const float p2 = 112.7;
-	  //const float p3 = 113.0; 
-	  //float vcal = ( atanh( (adc-p3)/p2) + p1)/p0;
-	  
-	  electrons = int( vcal * theConversionFactor + theOffset); 
+	  Word odd = a0 ^ a1 ^ b0 ^ b1;
+	  Word pairs = (a0 & a1) | (b0 & b1);
+	  q1 += __builtin_popcountll( odd & ~pairs );
+	  q3 += __builtin_popcountll( odd & pairs );
+	  qd += __builtin_popcountll( (a0 & b1 & ~a1 & ~b0) | (a1 & b0 & ~a0 & ~b1) );
+	}
+    }
+  return (q1 - q3 - 2*qd)/4;
+}
+
+//----------------------------------------------------------------------------
+//!  The runs of fired pixels of the bitmap columns minCol...maxCol, the
+//!  runs of neighbouring columns joined in theRunParent.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::bitmap_runs( int minCol, int maxCol ) 
+{
+  typedef SiPixelOccupancyBitmap::Word Word;
+  theRuns.clear();
+  theColumnRuns.resize(theNumOfCols+1);
+  const int nwords = theBitmap.wordsPerColumn();
+  for (int col = minCol; col <= maxCol; ++col) 
+    {
+      theColumnRuns[col] = theRuns.size();
+      const Word * words = theBitmap.column(col);
+      for (int iw = 0; iw < nwords; ++iw) 
+	{
+	  Word x = words[iw];
+	  while ( x ) 
+	    {
+	      int start = __builtin_ctzll(x);
+	      Word rest = ~(x >> start);
+	      int len = rest ? __builtin_ctzll(rest) : 64-start;
+	      int first = iw*64 + start;
+	      if ( start == 0 && !theRuns.empty() && 
+		   theRuns.back().col == col && theRuns.back().last == first-1 ) 
+		theRuns.back().last = first+len-1;   // run continues from the previous word
+	      else 
+		{
+		  PixelRun run = { col, first, first+len-1 };
+		  theRuns.push_back(run);
+		}
+	      x = ( start+len >= 64 ) ? 0 : x & ~( ((Word(1) << len) - 1) << start );
+	    }
+	}
+    }
+  theColumnRuns[maxCol+1] = theRuns.size();
+  
+  // Connect the runs of neighbouring columns
+  const int nruns = theRuns.size();
+  theRunParent.resize(nruns);
+  for (int i = 0; i < nruns; ++i) theRunParent[i] = i;
+  for (int col = minCol+1; col <= maxCol; ++col) 
+    connect_columns( theRuns, theColumnRuns[col-1], theColumnRuns[col], theColumnRuns[col+1], theRunParent );
+}
+
+//----------------------------------------------------------------------------
+//!  \brief Cluster a binary readout DetUnit on the occupancy bitmap.
+//!
+//!  1) the hits above threshold are set in the bitmap, 
+//!  2) the runs of set bits of each column are extracted word by word,
+//!  3) runs of neighbouring columns overlapping within one row (8-fold 
+//!     connectivity, as in make_cluster) are merged with a union-find,
+//!  4) the clusters are made in the order of their first seed, as the 
+//!     matrix algorithm does.
+//!  Returns false, having done nothing, if the DetUnit has to go through
+//!  the matrix after all: a hit with a real ADC value, or a cluster larger 
+//!  than the matrix algorithm can hold.
+//----------------------------------------------------------------------------
+bool PixelThresholdClusterizer::clusterize_binary( DigiIterator begin, DigiIterator end,
+						   edmNew::DetSetVector<SiPixelCluster>::FastFiller& output ) 
+{
+  const unsigned int MAXSIZE = 256;  // as AccretionCluster
+  
+  // All the hits have the same charge, the overflow value of calibrate()
+  const int charge = calibrate(1, 0, 0);
+  
+  theBitmap.setSize( theNumOfRows, theNumOfCols );
+  
+  int minCol = theNumOfCols;
+  int maxCol = -1;
+  DigiIterator di = begin;
+  for ( ; di != end; ++di ) 
+    {
+      if ( di->adc() != 1 ) break;
+      int row = di->row();
+      int col = di->column();
+      if ( theMaskedPixels_ && isMasked(row,col) ) continue;
+      if ( charge < thePixelThresholds[col] ) continue;
+      theBitmap.set(row,col);
+      minCol = std::min(minCol,col);
+      maxCol = std::max(maxCol,col);
+    }
+  bool done = ( di == end );
+  
+  // Runs of fired pixels along the columns
+  theRuns.clear();
+  if ( done && maxCol >= 0 ) 
+    {
+      bitmap_runs(minCol, maxCol);
+      
+      // Components, with their runs grouped together
+      std::vector<int> npix;
+      group_runs(npix);
+      for (unsigned int k = 0; k < npix.size(); ++k) 
+	if ( npix[k] > int(MAXSIZE) ) done = false;
+      
+      if ( done ) 
+	{
+	  // Make the clusters in the order of the seeds
+	  typedef unsigned short UShort;
+	  UShort adc[MAXSIZE], x[MAXSIZE], y[MAXSIZE];
+	  for ( di = begin; di != end; ++di ) 
+	    {
+	      int row = di->row();
+	      int col = di->column();
+	      if ( charge < theSeedThresholds[col] || !theBitmap.test(row,col) ) continue;
+	      
+	      int r = theColumnRuns[col];
+	      while ( theRuns[r].last < row ) ++r;
+	      int k = theComponentOf[r];
+	      if ( npix[k] < 0 ) continue;   // already done
+	      
+	      if ( npix[k]*float(charge) >= theModuleClusterThreshold ) 
+		{
+		  unsigned int isize = 0;
+		  UShort xmin = theNumOfRows, ymin = theNumOfCols;
+		  for (int j = theComponentFirst[k]; j != theComponentFirst[k+1]; ++j) 
+		    {
+		      const PixelRun & run = theRuns[theComponentRuns[j]];
+		      ymin = std::min(ymin, UShort(run.col));
+		      xmin = std::min(xmin, UShort(run.first));
+		      for (int ir = run.first; ir <= run.last; ++ir, ++isize) 
+			{
+			  adc[isize] = charge; x[isize] = ir; y[isize] = run.col;
+			}
+		    }
+		  output.push_back( SiPixelCluster(isize, adc, x, y, xmin, ymin) );
+		}
+	      npix[k] = -1;
+	    }
+	}
+    }
+  
+  // Leave the bitmap empty
+  for ( di = begin; di != end; ++di ) 
+    theBitmap.clear_word( di->row(), di->column() );
+  
+  return done;
+}
+
+int PixelThresholdClusterizer::find_root( std::vector<int> & parent, int run ) 
+{
+  while ( parent[run] != run ) 
+    {
+      parent[run] = parent[parent[run]];  // path halving
+      run = parent[run];
+    }
+  return run;
+}
+
+//----------------------------------------------------------------------------
+//!  Join the touching runs of two neighbouring columns, the runs of the
+//!  first column are [a,b), those of the second [b,bend).  The root of a
+//!  set is always its first run.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::connect_columns( const std::vector<PixelRun> & runs, 
+						 int a, int b, int bend, std::vector<int> & parent ) 
+{
+  const int aend = b;
+  while ( a < aend && b < bend ) 
+    {
+      const PixelRun & ra = runs[a];
+      const PixelRun & rb = runs[b];
+      if ( rb.first <= ra.last+1 && ra.first <= rb.last+1 ) 
+	{
+	  int pa = find_root(parent,a), pb = find_root(parent,b);
+	  if ( pa != pb ) parent[std::max(pa,pb)] = std::min(pa,pb);
 	}
+      if ( ra.last+1 <= rb.last ) ++a; else ++b;
     }
-  else 
-    { // No misscalibration in the digitizer
-      // Simple (default) linear gain 
-      const float gain = 135.; // 1 ADC = 135 electrons
-      const float pedestal = 0.; //
-      electrons = int(adc * gain + pedestal);
-      if (layer>=theFirstStack_) {
-	if (theStackADC_==1&&adc==1)
-	  {
-	    electrons = int(255*135); // Arbitrarily use overflow value.
-	  }
-	if (theStackADC_>1&&theStackADC_!=255&&adc>=1)
-	  {
-	    const float gain = 135.; // 1 ADC = 135 electrons
-	    electrons = int((adc-1) * gain * 255/float(theStackADC_-1));
-	  }
-      }
+}
+
+//----------------------------------------------------------------------------
+//!  Number the connected sets of theRuns and list the runs of each one in
+//!  theComponentRuns, npix gets the number of pixels per component.
+//----------------------------------------------------------------------------
+void PixelThresholdClusterizer::group_runs( std::vector<int> & npix ) 
+{
+  const int nruns = theRuns.size();
+  theComponentOf.resize(nruns);
+  int ncomp = 0;
+  for (int i = 0; i < nruns; ++i) 
+    theComponentOf[i] = ( find_run(i) == i ) ? ncomp++ : theComponentOf[find_run(i)];
+  theComponentFirst.assign(ncomp+1, 0);
+  npix.assign(ncomp, 0);
+  for (int i = 0; i < nruns; ++i) 
+    {
+      ++theComponentFirst[theComponentOf[i]+1];
+      npix[theComponentOf[i]] += theRuns[i].last - theRuns[i].first + 1;
     }
+  for (int k = 0; k < ncomp; ++k) 
+    theComponentFirst[k+1] += theComponentFirst[k];
   
-  return electrons;
+  theComponentRuns.resize(nruns);
+  std::vector<int> fill(theComponentFirst.begin(), theComponentFirst.end()-1);
+  for (int i = 0; i < nruns; ++i) theComponentRuns[fill[theComponentOf[i]]++] = i;
 }
 
 
@@ -282,11 +813,13 @@ namespace {
   struct AccretionCluster {
     typedef unsigned short UShort;
     static constexpr UShort MAXSIZE = 256;
+    // the minima start at the size of the DetUnit, i.e. beyond any pixel
+    AccretionCluster( int nrows, int ncols) : xmin(nrows), ymin(ncols) {}
     UShort adc[256];
     UShort x[256];
     UShort y[256];
-    UShort xmin=16000;
-    UShort ymin=16000;
+    UShort xmin;
+    UShort ymin;
     unsigned int isize=0;
     unsigned int curr=0;
 
@@ -311,10 +844,13 @@ namespace {
 //----------------------------------------------------------------------------
 //!  \brief The actual clustering algorithm: group the neighboring pixels around the seed.
 //----------------------------------------------------------------------------
+template<class Topology>
 SiPixelCluster 
-PixelThresholdClusterizer::make_cluster( const SiPixelCluster::PixelPos& pix, 
+PixelThresholdClusterizer::make_cluster( const Topology& topo,
+					 const SiPixelCluster::PixelPos& pix, 
 					 edmNew::DetSetVector<SiPixelCluster>::FastFiller& output) 
 {
+  int * buffer = theBuffer.data();
   
   //First we acquire the seeds for the clusters
   int seed_adc;
@@ -326,20 +862,21 @@ PixelThresholdClusterizer::make_cluster( const SiPixelCluster::PixelPos& pix,
   //The only difference between dead/noisy pixels and standard ones is that for dead/noisy pixels,
   //We consider the charge of the pixel to always be zero.
 
-  if ( doMissCalibrate &&
+  // Calibrated input has the dead and noisy pixels at zero already
+  if ( doMissCalibrate && !calibratedInput_ &&
        (theSiPixelGainCalibrationService_->isDead(detid_,pix.col(),pix.row()) || 
 	theSiPixelGainCalibrationService_->isNoisy(detid_,pix.col(),pix.row())) )
     {
       seed_adc = 0;
-      theBuffer.set_adc(pix, 1);
+      buffer[topo.index(pix.row(),pix.col())] = 1;
     }
   else
     {
-      seed_adc = theBuffer(pix.row(), pix.col());
-      theBuffer.set_adc( pix, 1);
+      seed_adc = buffer[topo.index(pix.row(),pix.col())];
+      buffer[topo.index(pix.row(),pix.col())] = 1;
     }
   
-  AccretionCluster acluster;
+  AccretionCluster acluster( topo.rows(), topo.columns() );
   acluster.add(pix, seed_adc);
   
   //Here we search all pixels adjacent to all pixels in the cluster.
@@ -352,12 +889,14 @@ PixelThresholdClusterizer::make_cluster( const SiPixelCluster::PixelPos& pix,
 	{
 	  for ( auto c = acluster.y[curInd]-1; c <= acluster.y[curInd]+1; ++c) 
 	    {
-	      if ( theBuffer(r,c) >= thePixelThreshold) 
+	      if ( !topo.inside(r,c) ) continue;
+	      int & adc = buffer[topo.index(r,c)];
+	      if ( adc >= theMinPixelThreshold) 
 		{
 		  
 		  SiPixelCluster::PixelPos newpix(r,c);
-		  if (!acluster.add( newpix, theBuffer(r,c))) goto endClus;
-		  theBuffer.set_adc( newpix, 1);
+		  if (!acluster.add( newpix, adc)) goto endClus;
+		  adc = 1;
 		}
 	     
 
@@ -404,14 +943,14 @@ PixelThresholdClusterizer::make_cluster( const SiPixelCluster::PixelPos& pix,
 	{
 	  //consider each found dead pixel
 	  SiPixelCluster::PixelPos deadpix = dead_pixel_stack.top(); dead_pixel_stack.pop();
-	  theBuffer.set_adc(deadpix, 1);
+	  buffer[topo.index(deadpix.row(),deadpix.col())] = 1;
 	 
 	  //Clusterize the split cluster using the dead pixel as a seed
-	  SiPixelCluster second_cluster = make_cluster(deadpix, output);
+	  SiPixelCluster second_cluster = make_cluster(topo, deadpix, output);
 	  
 	  //If both clusters would normally have been found by the clusterizer, put them into output
-	  if ( second_cluster.charge() >= theClusterThreshold && 
-	       first_cluster.charge() >= theClusterThreshold )
+	  if ( second_cluster.charge() >= theModuleClusterThreshold && 
+	       first_cluster.charge() >= theModuleClusterThreshold )
 	    {
 	      output.push_back( second_cluster );
 	      have_second_cluster = true;	
@@ -430,7 +969,7 @@ PixelThresholdClusterizer::make_cluster( const SiPixelCluster::PixelPos& pix,
 	}
       
       //Remember to also add the first cluster if we added the second one.
-      if ( first_cluster.charge() >= theClusterThreshold && have_second_cluster) 
+      if ( first_cluster.charge() >= theModuleClusterThreshold && have_second_cluster) 
 	{
 	  output.push_back( first_cluster );
 	}
@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------
+//! \class SiPixelClusterCache
+//! \brief Share the clusters of identical SiPixelClusterProducers.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterCache.h"
+#include "FWCore/Utilities/interface/Digest.h"
+
+
+SiPixelClusterCache& SiPixelClusterCache::instance()
+{
+  static SiPixelClusterCache theCache;
+  return theCache;
+}
+
+//----------------------------------------------------------------------------
+//! The module label and type are the only parameters which differ
+//! between two otherwise identical clustering modules.
+//----------------------------------------------------------------------------
+std::string SiPixelClusterCache::configDigest(const edm::ParameterSet& conf)
+{
+  edm::ParameterSet pset(conf);
+  pset.eraseSimpleParameter("@module_label");
+  pset.eraseSimpleParameter("@module_type");
+  pset.eraseSimpleParameter("@module_edm_type");
+  cms::Digest md5alg(pset.toString());
+  return md5alg.digest().toString();
+}
+
+void SiPixelClusterCache::setEvent(const edm::EventID& event)
+{
+  if ( event != event_ ) {
+    entries_.clear();
+    event_ = event;
+  }
+}
+
+bool SiPixelClusterCache::find(const edm::EventID& event,
+			       const edm::ProductID& input,
+			       const std::string& config,
+			       uint64_t mask,
+			       edm::ProductID& clusters)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  setEvent(event);
+  std::map<Key, edm::ProductID>::const_iterator it = entries_.find(Key(input,config,mask));
+  if ( it == entries_.end() ) return false;
+  clusters = it->second;
+  return true;
+}
+
+void SiPixelClusterCache::insert(const edm::EventID& event,
+				 const edm::ProductID& input,
+				 const std::string& config,
+				 uint64_t mask,
+				 const edm::ProductID& clusters)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  setEvent(event);
+  entries_.insert(std::make_pair(Key(input,config,mask), clusters));
+}
+
+boost::shared_ptr<SiPixelHotPixelMasker> SiPixelClusterCache::masker(const std::string& config,
+								     const edm::ParameterSet& conf,
+								     bool& first)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  boost::shared_ptr<SiPixelHotPixelMasker> & m = maskers_[config];
+  first = !m;
+  if ( first ) m.reset(new SiPixelHotPixelMasker(conf));
+  return m;
+}
+
+void SiPixelClusterCache::copy(const Collection& shared, Collection& output)
+{
+  output.reserve(shared.size(), shared.dataSize());
+  for (Collection::const_iterator it = shared.begin(); it != shared.end(); ++it) {
+    Collection::FastFiller ff(output, it->detId());
+    for (Collection::DetSet::const_iterator ci = it->begin(); ci != it->end(); ++ci)
+      ff.push_back(*ci);
+  }
+}
@@ -0,0 +1,122 @@
+//----------------------------------------------------------------------------
+//! \class SiPixelHotPixelMasker
+//! \brief Learn the noisy pixels from the data and mask them.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelHotPixelMasker.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+SiPixelHotPixelMasker::SiPixelHotPixelMasker(const edm::ParameterSet& conf) :
+  maxRate_( conf.getParameter<double>("MaxRate") ),
+  window_( conf.getParameter<unsigned int>("WindowLumiSections") ),
+  minEvents_( conf.getParameter<unsigned int>("MinEvents") ),
+  widthBits_( conf.getParameter<unsigned int>("SketchWidthBits") ),
+  depth_( conf.getParameter<unsigned int>("SketchDepth") ),
+  outputFile_( conf.getUntrackedParameter<std::string>("OutputFile","") ),
+  nEvents_(0),
+  counted_(false),
+  nMasked_(0),
+  maskDigest_(0)
+{
+  if ( window_ < 1 ) window_ = 1;
+  if ( depth_ < 1 ) depth_ = 1;
+  widthBits_ = std::max(4u, std::min(widthBits_, 28u));
+
+  // large odd constants, well mixing in the high bits
+  static const uint64_t odd[] = { 0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+				  0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL,
+				  0xff51afd7ed558ccdULL, 0xc4ceb9fe1a85ec53ULL,
+				  0x94d049bb133111ebULL, 0xbf58476d1ce4e5b9ULL };
+  const unsigned int nOdd = sizeof(odd)/sizeof(odd[0]);
+  if ( depth_ > nOdd ) depth_ = nOdd;
+  multipliers_.assign(odd, odd+depth_);
+
+  sketch_.assign(depth_ << widthBits_, 0);
+}
+
+void SiPixelHotPixelMasker::fill(const edm::DetSet<PixelDigi>& digis)
+{
+  const uint32_t detid = digis.detId();
+  for (edm::DetSet<PixelDigi>::const_iterator di = digis.begin(); di != digis.end(); ++di)
+    fill(detid, di->row(), di->column());
+}
+
+void SiPixelHotPixelMasker::fill(const SiPixelCalibratedDigiCollection::Module& pixels)
+{
+  const uint32_t detid = pixels.detId();
+  for (unsigned int i = 0; i != pixels.size(); ++i)
+    fill(detid, pixels.row(i), pixels.column(i));
+}
+
+uint32_t SiPixelHotPixelMasker::estimate(uint64_t k) const
+{
+  const unsigned int width = 1u << widthBits_;
+  uint32_t count = 0xffffffff;
+  for (unsigned int i = 0; i < depth_; ++i)
+    count = std::min(count, sketch_[i*width + bucket(k,i)]);
+  return count;
+}
+
+//----------------------------------------------------------------------------
+//! Move the window by one lumi section and decide on the candidates.
+//----------------------------------------------------------------------------
+void SiPixelHotPixelMasker::endLumiBlock()
+{
+  windowEvents_.push_back(nEvents_);
+  if ( windowEvents_.size() > window_ ) windowEvents_.pop_front();
+  const uint32_t nWindow = std::accumulate(windowEvents_.begin(), windowEvents_.end(), 0u);
+
+  masked_.clear();
+  maskedRates_.clear();
+  nMasked_ = 0;
+
+  std::map<uint64_t, std::deque<uint32_t> >::iterator it = candidates_.begin();
+  while ( it != candidates_.end() ) {
+    std::deque<uint32_t> & counts = it->second;
+    const uint32_t count = estimate(it->first);
+    // a new candidate from the first events of the lumi section only
+    if ( counts.empty() && count <= 0.5*maxRate_*nEvents_ ) {
+      candidates_.erase(it++);
+      continue;
+    }
+    counts.push_back( count );
+    if ( counts.size() > window_ ) counts.pop_front();
+    const uint32_t nFired = std::accumulate(counts.begin(), counts.end(), 0u);
+    const float rate = nWindow > 0 ? float(nFired)/nWindow : 0.;
+
+    if ( nWindow >= minEvents_ && rate > maxRate_ ) {
+      const uint32_t detid = uint32_t(it->first >> 32);
+      masked_[detid].push_back( uint32_t(it->first & 0xffffffff) );
+      maskedRates_[it->first] = rate;
+      ++nMasked_;
+    }
+
+    // forget the pixels which stay well below the limit for a whole window
+    if ( counts.size() == window_ && rate < 0.5*maxRate_ ) candidates_.erase(it++);
+    else ++it;
+  }
+
+  // the keys come sorted, so are the channels of each DetUnit,
+  // and the digest (FNV-1a over the keys) does not depend on the history
+  maskDigest_ = 0;
+  if ( nMasked_ > 0 ) {
+    maskDigest_ = 0xcbf29ce484222325ULL;
+    for (std::map<uint64_t, float>::const_iterator it = maskedRates_.begin(); it != maskedRates_.end(); ++it)
+      maskDigest_ = (maskDigest_ ^ it->first) * 0x100000001b3ULL;
+  }
+
+  std::fill(sketch_.begin(), sketch_.end(), 0);
+  nEvents_ = 0;
+}
+
+void SiPixelHotPixelMasker::write(std::ostream& out) const
+{
+  for (std::map<uint64_t, float>::const_iterator it = maskedRates_.begin(); it != maskedRates_.end(); ++it) {
+    const uint32_t ch = uint32_t(it->first & 0xffffffff);
+    out << uint32_t(it->first >> 32) << " " << (ch >> 16) << " " << (ch & 0xffff)
+	<< " " << it->second << "\n";
+  }
+}
@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------
+//! \class SiPixelModuleIndex
+//! \brief Dense index 0..N-1 of the pixel DetUnits of the geometry.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelModuleIndex.h"
+#include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
+#include "Geometry/Records/interface/TrackerDigiGeometryRecord.h"
+#include "Geometry/CommonTopologies/interface/PixelTopology.h"
+#include "FWCore/Framework/interface/ESHandle.h"
+#include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
+#include "DataFormats/SiPixelDetId/interface/PXBDetId.h"
+#include "DataFormats/SiPixelDetId/interface/PXFDetId.h"
+#include "DataFormats/SiPixelDetId/interface/PixelBarrelName.h"
+
+#include <algorithm>
+#include <utility>
+
+
+bool SiPixelModuleIndex::update(const edm::EventSetup& es)
+{
+  unsigned long long cacheId = es.get<TrackerDigiGeometryRecord>().cacheIdentifier();
+  if ( cacheId == cacheId_ && !modules_.empty() ) return false;
+  cacheId_ = cacheId;
+  edm::ESHandle<TrackerGeometry> geom;
+  es.get<TrackerDigiGeometryRecord>().get( geom );
+  build(*geom);
+  return true;
+}
+
+void SiPixelModuleIndex::build(const TrackerGeometry& geom)
+{
+  std::vector<std::pair<uint32_t,const PixelGeomDetUnit*> > units;
+  const TrackerGeometry::DetUnitContainer & detUnits = geom.detUnits();
+  for ( TrackerGeometry::DetUnitContainer::const_iterator it = detUnits.begin(); it != detUnits.end(); ++it ) {
+    const PixelGeomDetUnit * pixDet = dynamic_cast<const PixelGeomDetUnit*>(*it);
+    if ( pixDet == 0 ) continue;
+    uint32_t detid = pixDet->geographicalId().rawId();
+    int subdet = DetId(detid).subdetId();
+    if ( subdet == PixelSubdetector::PixelBarrel || subdet == PixelSubdetector::PixelEndcap )
+      units.push_back(std::make_pair(detid, pixDet));
+  }
+  std::sort(units.begin(), units.end());
+
+  detIds_.clear();
+  modules_.clear();
+  for ( unsigned int i = 0; i < units.size(); ++i ) {
+    if ( !detIds_.empty() && detIds_.back() == units[i].first ) continue;
+    detIds_.push_back(units[i].first);
+    const PixelTopology & topology = units[i].second->specificTopology();
+    Module m;
+    m.detId = units[i].first;
+    m.subdet = DetId(m.detId).subdetId();
+    m.rows = topology.nrows();
+    m.columns = topology.ncolumns();
+    m.rocRows = m.rows / topology.rowsperroc();
+    m.rocColumns = m.columns / topology.colsperroc();
+    m.layer = m.ladder = m.module = m.ladderName = m.moduleName = 0;
+    m.side = m.disk = m.blade = m.panel = 0;
+    m.half = false;
+    if ( m.subdet == PixelSubdetector::PixelBarrel ) {
+      PXBDetId pdetId(m.detId);
+      m.layer  = pdetId.layer();
+      m.ladder = pdetId.ladder();
+      m.module = pdetId.module();
+      PixelBarrelName pbn(pdetId);
+      PixelBarrelName::Shell sh = pbn.shell();
+      m.ladderName = pbn.ladderName();
+      m.moduleName = pbn.moduleName();
+      m.half = pbn.isHalfModule();
+      if ( sh == PixelBarrelName::mO || sh == PixelBarrelName::mI ) m.moduleName = -m.moduleName;
+      if ( sh == PixelBarrelName::mO || sh == PixelBarrelName::pO ) m.ladderName = -m.ladderName;
+    } else {
+      PXFDetId pdetId(m.detId);
+      m.side   = pdetId.side();
+      m.disk   = pdetId.disk();
+      m.blade  = pdetId.blade();
+      m.panel  = pdetId.panel();
+      m.module = pdetId.module();
+    }
+    modules_.push_back(m);
+  }
+}
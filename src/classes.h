@@ -0,0 +1,17 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_classes_h
+#define RecoLocalTracker_SiPixelClusterizer_classes_h
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelCalibratedDigiCollection.h"
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterCounts.h"
+#include "DataFormats/Common/interface/Wrapper.h"
+
+namespace {
+  struct dictionary {
+    SiPixelCalibratedDigiCollection calibDigis;
+    edm::Wrapper<SiPixelCalibratedDigiCollection> calibDigisWrapper;
+    SiPixelClusterCounts clusterCounts;
+    edm::Wrapper<SiPixelClusterCounts> clusterCountsWrapper;
+  };
+}
+
+#endif
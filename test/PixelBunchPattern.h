@@ -0,0 +1,178 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_PixelBunchPattern_H
+#define RecoLocalTracker_SiPixelClusterizer_PixelBunchPattern_H
+
+//----------------------------------------------------------------------------
+//! \class PixelBunchPattern
+//! \brief Bunch type of each bx, from LHC filling schemes given per run range.
+//!
+//! A scheme is a list of trains: the colliding bunches from-to, and the
+//! non colliding bunches of beam 1 and beam 2, every spacing bx.  It is
+//! expanded once into a table of all bx slots, so find() is one array
+//! access.  setRun() picks the scheme of the run (the default one if no
+//! scheme lists it) and costs nothing while the run does not change.
+//!
+//! The schemes file has one block per fill, '#' starts a comment:
+//!
+//!   fill 2201 180241 180252     # fill, first and last run
+//!   limit 1841                  # bx after it are invalid
+//!   spacing 2                   # bx between bunches of a train
+//!   train 7 24 1 5 25 29        # collisions, beam1 and beam2 from-to,
+//!   train 66 137 -1 -1 -1 -1    # -1 -1 if none
+//----------------------------------------------------------------------------
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+
+class PixelBunchPattern
+{
+ public:
+  //! The codes of the old getBX::find()
+  enum BunchType { Invalid = -1, Empty = 0, Beam1 = 1, Beam2 = 2, Collision = 3,
+		   CollisionPlus1 = 4, Beam1Plus1 = 5, Beam2Plus1 = 6 };
+  //! Slots for bx 0 (simulation) to 3564
+  enum { NumberOfBx = 3565 };
+
+  struct Train { int from, to, beam1From, beam1To, beam2From, beam2To; };
+
+  PixelBunchPattern() : default_(-1), current_(-1), run_(-1), table_(0) {}
+
+  //! Add a scheme for the runs firstRun-lastRun, returns its number
+  inline int addScheme( int fill, int firstRun, int lastRun, int limit, int spacing,
+			const std::vector<Train> & trains);
+  //! Add the schemes of a file, false (and a message) on a format error
+  inline bool load( const std::string & fileName);
+  //! Scheme of the runs without one of their own
+  void setDefault( int scheme) { default_ = scheme; run_ = -1; }
+
+  //! Select the scheme of the run, true if it changed
+  inline bool setRun( int run);
+  //! Fill of the selected scheme, -1 if none
+  int fill() const { return current_ < 0 ? -1 : schemes_[current_].fill; }
+
+  //! Bunch type of bx in the selected scheme
+  int find( int bx) const {
+    return ( table_ == 0 || bx < 0 || bx >= NumberOfBx ) ? int(Invalid) : int(table_[bx]);
+  }
+
+ private:
+  struct Scheme {
+    int fill, firstRun, lastRun;
+    std::vector<signed char> types;   // per bx
+  };
+  static void mark( std::vector<signed char> & types, int from, int to, int spacing,
+		    int type, int typePlus1) {
+    if ( from < 0 ) return;
+    for (int b = from; b <= to && b < NumberOfBx; b += spacing)
+      {
+	if ( b+1 < NumberOfBx ) types[b+1] = typePlus1;
+	types[b] = type;
+      }
+  }
+
+  std::vector<Scheme> schemes_;
+  int default_, current_, run_;
+  const signed char * table_;
+};
+
+
+int PixelBunchPattern::addScheme( int fill, int firstRun, int lastRun, int limit, int spacing,
+				  const std::vector<Train> & trains)
+{
+  Scheme s;
+  s.fill = fill;
+  s.firstRun = firstRun;
+  s.lastRun = lastRun;
+  s.types.assign(NumberOfBx, Empty);
+  if ( spacing < 1 ) spacing = 1;
+  // backwards, so that the first train and the collisions win as in getBX
+  for (int t = int(trains.size()) - 1; t >= 0; --t)
+    {
+      const Train & tr = trains[t];
+      mark(s.types, tr.beam2From, tr.beam2To, spacing, Beam2, Beam2Plus1);
+      mark(s.types, tr.beam1From, tr.beam1To, spacing, Beam1, Beam1Plus1);
+      mark(s.types, tr.from, tr.to, spacing, Collision, CollisionPlus1);
+    }
+  for (int bx = limit + 1; bx < NumberOfBx; ++bx) if ( bx >= 0 ) s.types[bx] = Invalid;
+
+  schemes_.push_back(s);
+  run_ = -1;   // the tables moved, select again
+  table_ = 0;
+  return schemes_.size() - 1;
+}
+
+bool PixelBunchPattern::load( const std::string & fileName)
+{
+  std::ifstream in(fileName.c_str());
+  if ( !in )
+    {
+      std::cout << " PixelBunchPattern: cannot open " << fileName << std::endl;
+      return false;
+    }
+
+  int fill = -1, firstRun = 0, lastRun = 0, limit = NumberOfBx - 1, spacing = 1;
+  std::vector<Train> trains;
+  const unsigned int before = schemes_.size();
+  std::string line;
+  int lineNumber = 0, schemes = 0;
+  while ( true )
+    {
+      bool more = bool(std::getline(in, line));
+      ++lineNumber;
+      if ( more ) line = line.substr(0, line.find('#'));
+      std::istringstream is(more ? line : std::string("fill"));
+      std::string key;
+      if ( !(is >> key) ) continue;
+
+      if ( key == "fill" )
+	{
+	  if ( fill >= 0 )
+	    {
+	      addScheme(fill, firstRun, lastRun, limit, spacing, trains);
+	      ++schemes;
+	    }
+	  if ( !more ) break;
+	  trains.clear();
+	  limit = NumberOfBx - 1;
+	  spacing = 1;
+	  if ( is >> fill >> firstRun >> lastRun ) continue;
+	}
+      else if ( fill >= 0 && key == "limit" && (is >> limit) ) continue;
+      else if ( fill >= 0 && key == "spacing" && (is >> spacing) ) continue;
+      else if ( fill >= 0 && key == "train" )
+	{
+	  Train t;
+	  if ( is >> t.from >> t.to >> t.beam1From >> t.beam1To >> t.beam2From >> t.beam2To )
+	    {
+	      trains.push_back(t);
+	      continue;
+	    }
+	}
+      std::cout << " PixelBunchPattern: " << fileName << ":" << lineNumber
+		<< " bad line '" << line << "', file skipped" << std::endl;
+      schemes_.resize(before);
+      run_ = -1;
+      table_ = 0;
+      return false;
+    }
+  std::cout << " PixelBunchPattern: " << schemes << " schemes from " << fileName << std::endl;
+  return true;
+}
+
+bool PixelBunchPattern::setRun( int run)
+{
+  if ( run == run_ ) return false;
+  run_ = run;
+  int selected = default_;
+  for (unsigned int i = 0; i < schemes_.size(); ++i)
+    if ( run >= schemes_[i].firstRun && run <= schemes_[i].lastRun ) { selected = i; break; }
+  const bool changed = ( selected != current_ );
+  current_ = selected;
+  table_ = ( current_ < 0 ) ? 0 : &schemes_[current_].types[0];
+  return changed;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_PixelBxAccumulator_H
+#define RecoLocalTracker_SiPixelClusterizer_PixelBxAccumulator_H
+
+//----------------------------------------------------------------------------
+//! \class PixelBxAccumulator
+//! \brief Per bunch crossing histograms, filled privately and added per LS.
+//!
+//! The analyzers fill a dozen of 4000 bin histograms vs bx for every event
+//! and every cluster.  Here a channel is one booked histogram (TH1 or
+//! TProfile), possibly shared by several layers, and fill() goes to a
+//! private copy of it, cloned at book() and not attached to any directory.
+//! flush() adds the copies to the booked histograms with TH1::Add(), which
+//! sums the bin contents, errors, TProfile bin entries, statistics and
+//! entries as the direct Fill() calls would give, and resets them; call it
+//! at endLuminosityBlock and once more at endJob.  The booked histograms
+//! are only touched in flush().  Not thread safe: the analyzers are legacy
+//! EDAnalyzers, run in one thread.  A histogram booked as null (not made)
+//! is skipped, its entries dropped.
+//!
+//!   int ch = acc.book(hcharClubx, 3);     // layers 1-3 to one profile
+//!   acc.fill(ch, bx, charge, layer-1);
+//----------------------------------------------------------------------------
+
+#include <TH1.h>
+#include <TProfile.h>
+
+#include <vector>
+#include <sstream>
+
+
+class PixelBxAccumulator
+{
+ public:
+  //! Entries for bx 0 (simulation) to 3564
+  enum { NumberOfBx = 3565 };
+
+  PixelBxAccumulator() : nOutOfRange(0) {}
+  inline ~PixelBxAccumulator();
+
+  //! A channel with layers slots per bx, all flushed into h
+  int book( TH1 * h, int layers = 1) { return book( std::vector<TH1*>(layers, h) ); }
+  //! A channel flushed layer by layer into perLayer (entries may repeat)
+  inline int book( const std::vector<TH1*> & perLayer);
+
+  //! One entry, for a TH1
+  void fill( int channel, int bx, int layer = 0) {
+    TH1 * h = copy(channel, bx, layer);
+    if ( h ) h->Fill(double(bx));
+  }
+  //! One entry of value y, for a TProfile
+  void fill( int channel, int bx, double y, int layer = 0) {
+    TH1 * h = copy(channel, bx, layer);
+    if ( h ) h->Fill(double(bx), y);
+  }
+
+  //! Add the private copies to the histograms and reset them
+  inline void flush();
+  //! Entries given to fill() outside the bx or layer range, they are dropped
+  unsigned long outOfRange() const { return nOutOfRange; }
+
+ private:
+  //! A booked histogram and its private copy
+  struct Pair {
+    TH1 * booked;
+    TH1 * copy;                     // owned, null if booked is
+  };
+
+  PixelBxAccumulator( const PixelBxAccumulator &);
+  PixelBxAccumulator & operator=( const PixelBxAccumulator &);
+
+  TH1 * copy( int channel, int bx, int layer) {
+    if ( channel < 0 || channel >= int(channels.size()) || bx < 0 || bx >= NumberOfBx ||
+	 layer < 0 || layer >= int(channels[channel].size()) ) {
+      ++nOutOfRange;
+      return 0;
+    }
+    return pairs[channels[channel][layer]].copy;
+  }
+
+  std::vector<Pair> pairs;                       // one per distinct booked histogram
+  std::vector<std::vector<unsigned int> > channels; // per layer, the index in pairs
+  unsigned long nOutOfRange;
+};
+
+
+PixelBxAccumulator::~PixelBxAccumulator()
+{
+  for (unsigned int i = 0; i < pairs.size(); ++i) delete pairs[i].copy;
+}
+
+int PixelBxAccumulator::book( const std::vector<TH1*> & perLayer)
+{
+  std::vector<unsigned int> layers;
+  for (unsigned int layer = 0; layer < perLayer.size(); ++layer)
+    {
+      TH1 * h = perLayer[layer];
+      unsigned int i = 0;
+      while ( i < pairs.size() && pairs[i].booked != h ) ++i;
+      if ( i == pairs.size() )
+	{
+	  Pair p = { h, 0 };
+	  if ( h )
+	    {
+	      std::ostringstream name;
+	      name << h->GetName() << "_bxAccumulator";
+	      p.copy = static_cast<TH1*>( h->Clone(name.str().c_str()) );
+	      p.copy->SetDirectory(0);
+	      p.copy->Reset();
+	    }
+	  pairs.push_back(p);
+	}
+      layers.push_back(i);
+    }
+  channels.push_back(layers);
+  return channels.size() - 1;
+}
+
+void PixelBxAccumulator::flush()
+{
+  for (unsigned int i = 0; i < pairs.size(); ++i)
+    {
+      Pair & p = pairs[i];
+      if ( !p.copy || p.copy->GetEntries() == 0. ) continue;
+      p.booked->Add(p.copy);
+      p.copy->Reset();
+    }
+}
+
+#endif
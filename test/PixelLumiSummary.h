@@ -0,0 +1,111 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_PixelLumiSummary_H
+#define RecoLocalTracker_SiPixelClusterizer_PixelLumiSummary_H
+
+//----------------------------------------------------------------------------
+//! \class PixelLumiSummary
+//! \brief Per lumi section averages, appended to a text file at each endLumi.
+//!
+//! The profiles vs lumi section of the analyzers have a fixed range and are
+//! written only at endJob.  Here each quantity keeps, for the current lumi
+//! section only, the number of entries and the sum and sum of squares of
+//! its values.  endLumi() appends one line with the entries, mean and rms
+//! of every quantity, flushes the file and starts the next lumi section,
+//! so the memory does not depend on the length of the run and the lumi
+//! sections done are on disk if the job dies.  The file is only appended
+//! to; each job first writes a '#' line with the column names:
+//!
+//!   # run ls clus_n clus_mean clus_rms pix_n pix_mean pix_rms ...
+//!   180250 12 2201 1463.5 402.1 2201 5832.7 1711.9 ...
+//!
+//!   int clus = summary.add("clus");       // before open()
+//!   summary.fill(clus, numberOfClusters);
+//----------------------------------------------------------------------------
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+
+
+class PixelLumiSummary
+{
+ public:
+  PixelLumiSummary() : lumis_(0) {}
+
+  //! A quantity, returns its number for fill()
+  int add( const std::string & name) {
+    names_.push_back(name);
+    stats_.push_back(Stat());
+    return stats_.size() - 1;
+  }
+  //! Append to the file, false (and a message) if it cannot be opened
+  inline bool open( const std::string & fileName);
+  bool isOpen() const { return out_.is_open(); }
+
+  void fill( int q, double value) {
+    Stat & s = stats_[q];
+    ++s.n;
+    s.sum += value;
+    s.sum2 += value*value;
+  }
+
+  //! Write the current lumi section and start the next one
+  inline void endLumi( int run, int lumiBlock);
+  //! Lumi sections written
+  unsigned long lumis() const { return lumis_; }
+
+ private:
+  struct Stat {
+    Stat() : n(0), sum(0), sum2(0) {}
+    unsigned long n;
+    double sum, sum2;
+  };
+
+  std::vector<std::string> names_;
+  std::vector<Stat> stats_;     // current lumi section
+  std::ofstream out_;
+  unsigned long lumis_;
+};
+
+
+bool PixelLumiSummary::open( const std::string & fileName)
+{
+  out_.open(fileName.c_str(), std::ios::out | std::ios::app);
+  if ( !out_ )
+    {
+      std::cout << " PixelLumiSummary: cannot open " << fileName << std::endl;
+      out_.close();
+      return false;
+    }
+  out_ << "# run ls";
+  for (unsigned int q = 0; q < names_.size(); ++q)
+    out_ << " " << names_[q] << "_n " << names_[q] << "_mean " << names_[q] << "_rms";
+  out_ << std::endl;
+  return true;
+}
+
+void PixelLumiSummary::endLumi( int run, int lumiBlock)
+{
+  if ( out_.is_open() )
+    {
+      out_ << run << " " << lumiBlock;
+      for (unsigned int q = 0; q < stats_.size(); ++q)
+	{
+	  const Stat & s = stats_[q];
+	  double mean = 0, rms = 0;
+	  if ( s.n > 0 )
+	    {
+	      mean = s.sum/s.n;
+	      double var = s.sum2/s.n - mean*mean;
+	      rms = var > 0 ? std::sqrt(var) : 0.;
+	    }
+	  out_ << " " << s.n << " " << mean << " " << rms;
+	}
+      out_ << std::endl;   // on disk at each lumi section
+      ++lumis_;
+    }
+  for (unsigned int q = 0; q < stats_.size(); ++q) stats_[q] = Stat();
+}
+
+#endif
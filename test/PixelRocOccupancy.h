@@ -0,0 +1,152 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_PixelRocOccupancy_H
+#define RecoLocalTracker_SiPixelClusterizer_PixelRocOccupancy_H
+
+//----------------------------------------------------------------------------
+//! \class PixelRocOccupancy
+//! \brief Hits per ROC of all BPix and FPix modules, with per-LS snapshots.
+//!
+//! The ROCs of the modules of a SiPixelModuleIndex are numbered
+//! contiguously, module after module, so that one counter per ROC is a
+//! flat array.  The ROC of a pixel is the simplified address of the
+//! analyzers: col/52 + (row/80)*(ROCs along the columns); a half module
+//! has only its first row of ROCs.
+//!
+//! The hits are counted in shards, one per filling thread, so no atomics
+//! are needed.  endLumi() folds the shards into the totals and returns the
+//! hits of the lumi section as a sparse snapshot (the ROCs with hits
+//! only), that the caller may keep or look at and drop; the shards are
+//! then zero again for the next lumi section.  Only the last snapshot is
+//! held, so the memory does not grow with the number of lumi sections.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelModuleIndex.h"
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+
+class PixelRocOccupancy
+{
+ public:
+  //! The ROCs with hits in one lumi section, in ROC order
+  struct Snapshot {
+    int lumiBlock;
+    std::vector<uint32_t> rocs;        // global ROC numbers
+    std::vector<uint32_t> counts;
+  };
+
+  explicit PixelRocOccupancy(unsigned int shards = 1) : shards_(shards > 0 ? shards : 1) {}
+
+  //! ROC layout of the index; the counts are cleared if it changed
+  inline bool setLayout( const SiPixelModuleIndex & index);
+
+  unsigned int numberOfModules() const { return rocColumns_.size(); }
+  unsigned int numberOfRocs() const { return offsets_.empty() ? 0 : offsets_.back(); }
+  unsigned int numberOfRocs( int module) const { return offsets_[module+1] - offsets_[module]; }
+  //! ROCs in the first row, the others are in the second row
+  unsigned int rocsPerRow( int module) const { return rocColumns_[module]; }
+  //! Global ROC number, -1 if out of the module
+  int rocIndex( int module, int roc) const {
+    if ( module < 0 || module >= int(numberOfModules()) || roc < 0 || roc >= int(numberOfRocs(module)) ) return -1;
+    return offsets_[module] + roc;
+  }
+
+  //! One hit, module = index in the SiPixelModuleIndex
+  void fill( int module, int col, int row, unsigned int shard = 0) {
+    if ( module < 0 || module >= int(numberOfModules()) ) return;
+    unsigned int roc = col/52 + (row/80)*rocColumns_[module];
+    if ( roc < numberOfRocs(module) ) ++shards_[shard][offsets_[module] + roc];
+  }
+
+  //! Fold the hits of the lumi section into the totals
+  inline const Snapshot & endLumi( int lumiBlock);
+  const Snapshot & lastSnapshot() const { return snapshot_; }
+  //! Hits of one ROC in the last snapshot
+  inline uint32_t lastCount( int rocIndex) const;
+
+  //! Total hits of a ROC, -1 if there is no such ROC
+  double count( int module, int roc) const {
+    int index = rocIndex(module, roc);
+    return index < 0 ? -1. : double(totals_[index]);
+  }
+  //! Hits per ROC with hits of the module, and the hits of each row of ROCs
+  inline float moduleAverage( int module, float & half1, float & half2) const;
+
+ private:
+  std::vector<unsigned int> offsets_;          // first ROC of each module, and the end
+  std::vector<unsigned int> rocColumns_;       // ROCs per row of each module
+  std::vector<std::vector<uint32_t> > shards_;  // hits of this lumi section
+  std::vector<uint64_t> totals_;
+  Snapshot snapshot_;
+};
+
+
+bool PixelRocOccupancy::setLayout( const SiPixelModuleIndex & index)
+{
+  std::vector<unsigned int> offsets(1, 0), rocColumns;
+  for (unsigned int i = 0; i < index.size(); ++i)
+    {
+      const SiPixelModuleIndex::Module & m = index.module(i);
+      rocColumns.push_back(m.rocColumns);
+      offsets.push_back(offsets.back() + m.rocRows*m.rocColumns);
+    }
+  if ( offsets == offsets_ && rocColumns == rocColumns_ ) return false;
+
+  offsets_.swap(offsets);
+  rocColumns_.swap(rocColumns);
+  for (unsigned int s = 0; s < shards_.size(); ++s) shards_[s].assign(numberOfRocs(), 0);
+  totals_.assign(numberOfRocs(), 0);
+  snapshot_ = Snapshot();
+  return true;
+}
+
+const PixelRocOccupancy::Snapshot & PixelRocOccupancy::endLumi( int lumiBlock)
+{
+  snapshot_.lumiBlock = lumiBlock;
+  snapshot_.rocs.clear();
+  snapshot_.counts.clear();
+  const unsigned int n = numberOfRocs();
+  for (unsigned int r = 0; r < n; ++r)
+    {
+      uint32_t hits = 0;
+      for (unsigned int s = 0; s < shards_.size(); ++s)
+	{
+	  hits += shards_[s][r];
+	  shards_[s][r] = 0;
+	}
+      if ( hits == 0 ) continue;
+      totals_[r] += hits;
+      snapshot_.rocs.push_back(r);
+      snapshot_.counts.push_back(hits);
+    }
+  return snapshot_;
+}
+
+uint32_t PixelRocOccupancy::lastCount( int rocIndex) const
+{
+  std::vector<uint32_t>::const_iterator it =
+    std::lower_bound(snapshot_.rocs.begin(), snapshot_.rocs.end(), uint32_t(rocIndex));
+  if ( it == snapshot_.rocs.end() || *it != uint32_t(rocIndex) ) return 0;
+  return snapshot_.counts[it - snapshot_.rocs.begin()];
+}
+
+float PixelRocOccupancy::moduleAverage( int module, float & half1, float & half2) const
+{
+  half1 = 0; half2 = 0;
+  if ( module < 0 || module >= int(numberOfModules()) ) return -1.;
+  float count = 0;
+  int rocs = 0;
+  for (unsigned int roc = 0; roc < numberOfRocs(module); ++roc)
+    {
+      float tmp = float(totals_[offsets_[module] + roc]);
+      count += tmp;
+      if ( roc < rocColumns_[module] ) half1 += tmp;
+      else half2 += tmp;
+      if ( tmp > 0 ) ++rocs;
+    }
+  if ( rocs > 0 ) count /= float(rocs);  // per ROC with hits
+  return count;
+}
+
+#endif
@@ -31,10 +31,7 @@
 #include "DataFormats/Common/interface/Ref.h"
 #include "DataFormats/DetId/interface/DetId.h"
 
-#include "DataFormats/SiPixelDetId/interface/PXBDetId.h" 
-#include "DataFormats/SiPixelDetId/interface/PXFDetId.h" 
 #include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
-#include "DataFormats/SiPixelDetId/interface/PixelBarrelName.h"
 
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetType.h"
@@ -44,6 +41,8 @@
 #include "Geometry/CommonDetUnit/interface/GeomDetUnit.h"
 #include "Geometry/CommonTopologies/interface/PixelTopology.h"
 
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelModuleIndex.h"
+
 // For L1
 #include "L1Trigger/GlobalTriggerAnalyzer/interface/L1GtUtils.h"
 #include "DataFormats/L1GlobalTrigger/interface/L1GlobalTriggerReadoutSetupFwd.h"
@@ -69,6 +68,7 @@
 #include <TF1.h>
 #include <TH2F.h>
 #include <TH1F.h>
+#include <TTree.h>
 
 #define HISTOS
 
@@ -91,6 +91,7 @@ class ReadPixClusters : public edm::EDAnalyzer {
   edm::InputTag src_;
   bool printLocal;
   int countEvents, countAllEvents;
+  SiPixelModuleIndex moduleIndex; // dense module numbering
   double sumClusters;
 
   //TFile* hFile;
@@ -130,6 +131,15 @@ class ReadPixClusters : public edm::EDAnalyzer {
 
   TH1F *hclusPerDisk1,*hclusPerDisk2,*hclusPerDisk3,*hclusPerDisk4;
 
+  // Optional per cluster ntuple, one entry per event with one column per 
+  // quantity, the clusters of the event are buffered in the arrays
+  TTree * ntuple;
+  int ntupleMaxClusters, ntupleBasketSize;
+  unsigned long ntupleDropped;
+  int ntRun, ntEvent, ntLumi, ntBx, ntClusters;
+  std::vector<int> ntModule, ntLayer, ntDisk, ntSize, ntSizeX, ntSizeY;
+  std::vector<float> ntCharge, ntX, ntY;
+
 };
 
 /////////////////////////////////////////////////////////////////
@@ -137,6 +147,10 @@ class ReadPixClusters : public edm::EDAnalyzer {
 ReadPixClusters::ReadPixClusters(edm::ParameterSet const& conf) 
   : conf_(conf), src_(conf.getParameter<edm::InputTag>( "src" )) { 
   printLocal = conf.getUntrackedParameter<bool>("Verbosity",false);
+  ntuple = 0;
+  ntupleDropped = 0;
+  ntupleMaxClusters = conf.getUntrackedParameter<int>("NtupleMaxClusters",0); // 0 no ntuple
+  ntupleBasketSize = conf.getUntrackedParameter<int>("NtupleBasketSize",256000);
   //src_ =  conf.getParameter<edm::InputTag>( "src" );
   cout<<" Construct "<<printLocal<<endl;
 
@@ -342,6 +356,28 @@ void ReadPixClusters::beginJob() {
 
   htest = fs->make<TH1F>( "htest", "FPix R", 300, -15., 15.);
 
+  if(ntupleMaxClusters>0) {
+    // large baskets, the per cluster columns are long
+    ntuple = fs->make<TTree>("clusters","pixel clusters, one entry per event");
+    ntModule.resize(ntupleMaxClusters); ntLayer.resize(ntupleMaxClusters); ntDisk.resize(ntupleMaxClusters);
+    ntSize.resize(ntupleMaxClusters); ntSizeX.resize(ntupleMaxClusters); ntSizeY.resize(ntupleMaxClusters);
+    ntCharge.resize(ntupleMaxClusters); ntX.resize(ntupleMaxClusters); ntY.resize(ntupleMaxClusters);
+    ntuple->Branch("run",  &ntRun,  "run/I");
+    ntuple->Branch("event",&ntEvent,"event/I");
+    ntuple->Branch("lumi", &ntLumi, "lumi/I");
+    ntuple->Branch("bx",   &ntBx,   "bx/I");
+    ntuple->Branch("ncl",  &ntClusters,"ncl/I");
+    ntuple->Branch("module",&ntModule[0],"module[ncl]/I",ntupleBasketSize); // SiPixelModuleIndex
+    ntuple->Branch("layer",&ntLayer[0], "layer[ncl]/I", ntupleBasketSize);  // 1-3, 0 fpix
+    ntuple->Branch("disk", &ntDisk[0],  "disk[ncl]/I",  ntupleBasketSize);  // -2..2, negative -z
+    ntuple->Branch("size", &ntSize[0],  "size[ncl]/I",  ntupleBasketSize);
+    ntuple->Branch("sizeX",&ntSizeX[0], "sizeX[ncl]/I", ntupleBasketSize);
+    ntuple->Branch("sizeY",&ntSizeY[0], "sizeY[ncl]/I", ntupleBasketSize);
+    ntuple->Branch("charge",&ntCharge[0],"charge[ncl]/F",ntupleBasketSize); // ke
+    ntuple->Branch("x",    &ntX[0],     "x[ncl]/F",     ntupleBasketSize);  // row
+    ntuple->Branch("y",    &ntY[0],     "y[ncl]/F",     ntupleBasketSize);  // column
+  }
+
 #endif
 
   countEvents=0;
@@ -351,6 +387,8 @@ void ReadPixClusters::beginJob() {
 }
 // ------------ method called to at the end of the job  ------------
 void ReadPixClusters::endJob(){
+  if(ntuple) cout<<" ntuple: "<<ntuple->GetEntries()<<" events, "<<ntupleDropped
+		 <<" clusters over the "<<ntupleMaxClusters<<" per event dropped"<<endl;
   sumClusters = sumClusters/float(countEvents);
   cout << " End PixelClusTest, events all/with hits=  " << countAllEvents<<"/"<<countEvents<<" "
        <<sumClusters<<" "<<printLocal<<endl;
@@ -366,6 +404,8 @@ void ReadPixClusters::analyze(const edm::Event& e,
   edm::ESHandle<TrackerGeometry> geom;
   es.get<TrackerDigiGeometryRecord>().get( geom );
   const TrackerGeometry& theTracker(*geom);
+  if( moduleIndex.update(es) ) 
+    cout<<" module index for "<<moduleIndex.size()<<" pixel modules"<<endl;
 
   countAllEvents++;
   int run       = e.id().run();
@@ -399,6 +439,7 @@ void ReadPixClusters::analyze(const edm::Event& e,
   horbit->Fill(float(orbit));
 
   countEvents++;
+  ntClusters = 0;
   int numberOfDetUnits = 0;
   int numberOfClusters = 0;
   int numberOfPixels = 0;
@@ -492,8 +533,6 @@ void ReadPixClusters::analyze(const edm::Event& e,
     unsigned int layerC=0;
     unsigned int ladderC=0;
     unsigned int zindex=0;
-    int shell  = 0; // shell id // Shell { mO = 1, mI = 2 , pO =3 , pI =4 };
-    int sector = 0; // 1-8
     int ladder = 0; // 1-22
     int layer  = 0; // 1-3
     int module = 0; // 1-4
@@ -510,15 +549,22 @@ void ReadPixClusters::analyze(const edm::Event& e,
 
     edmNew::DetSet<SiPixelCluster>::const_iterator clustIt;
 
+    // Module ids from the index, decoded once per geometry
+    int moduleIdx = moduleIndex.index(detid);
+    if(moduleIdx<0) {
+      cout<<" det "<<detid<<" not in the pixel geometry "<<endl;
+      continue;
+    }
+    const SiPixelModuleIndex::Module & pixModule = moduleIndex.module(moduleIdx);
+
     // Subdet id, pix barrel=1, forward=2
     if(subid==2) {  // forward
 
-      PXFDetId pdetId = PXFDetId(detid);       
-      disk=pdetId.disk(); //1,2,3
-      blade=pdetId.blade(); //1-24
-      moduleF=pdetId.module(); //
-      side=pdetId.side(); //size=1 for -z, 2 for +z
-      panel=pdetId.panel(); //panel=1
+      disk=pixModule.disk; //1,2,3
+      blade=pixModule.blade; //1-24
+      moduleF=pixModule.module; //
+      side=pixModule.side; //size=1 for -z, 2 for +z
+      panel=pixModule.panel; //panel=1
       
       if(printLocal) cout<<" forward det, disk "<<disk<<", blade "
 			 <<blade<<", module "<<moduleF<<", side "<<side<<", panel "
@@ -546,36 +592,23 @@ void ReadPixClusters::analyze(const edm::Event& e,
       //hcolsB->Fill(float(cols));
       //hrowsB->Fill(float(rows));
       
-      PXBDetId pdetId = PXBDetId(detid);
-      //unsigned int detTypeP=pdetId.det();
-      //unsigned int subidP=pdetId.subdetId();
       // Barell layer = 1,2,3
-      layerC=pdetId.layer();
+      layerC=pixModule.layer;
       // Barrel ladder id 1-20,32,44.
-      ladderC=pdetId.ladder();
+      ladderC=pixModule.ladder;
       // Barrel Z-index=1,8
-      zindex=pdetId.module();
-
-      // Convert to online 
-      PixelBarrelName pbn(pdetId);
-      // Shell { mO = 1, mI = 2 , pO =3 , pI =4 };
-      PixelBarrelName::Shell sh = pbn.shell(); //enum
-      sector = pbn.sectorName();
-      ladder = pbn.ladderName();
-      layer  = pbn.layerName();
-      module = pbn.moduleName();
-      half  = pbn.isHalfModule();
-      shell = int(sh);
-      // change the module sign for z<0
-      if(shell==1 || shell==2) module = -module;
-      // change ladeer sign for Outer )x<0)
-      if(shell==1 || shell==3) ladder = -ladder;
+      zindex=pixModule.module;
+
+      // Online, ladder negative for x<0, module negative for z<0
+      ladder = pixModule.ladderName;
+      layer  = pixModule.layer;
+      module = pixModule.moduleName;
+      half  = pixModule.half;
       
       if(printLocal) { 
 	cout<<" Barrel layer, ladder, module "
 	    <<layerC<<" "<<ladderC<<" "<<zindex<<" "
-	    <<sh<<"("<<shell<<") "<<sector<<" "<<layer<<" "<<ladder<<" "
-	    <<module<<" "<<half<< endl;
+	    <<layer<<" "<<ladder<<" "<<module<<" "<<half<< endl;
 	//cout<<" Barrel det, thick "<<detThick<<" "
 	//  <<" layer, ladder, module "
 	//  <<layer<<" "<<ladder<<" "<<zindex<<endl;
@@ -622,6 +655,21 @@ void ReadPixClusters::analyze(const edm::Event& e,
 		    <<x<<" "<<y<<" "<<minPixelRow<<" "<<maxPixelRow<<" "<<minPixelCol<<" "
 		    <<maxPixelCol<<" "<<edgeHitX<<" "<<edgeHitY<<endl;
 
+      if(ntuple) {
+	if(ntClusters<ntupleMaxClusters) {
+	  ntModule[ntClusters] = moduleIdx;
+	  ntLayer[ntClusters]  = layer;
+	  ntDisk[ntClusters]   = (side==1) ? -int(disk) : int(disk);
+	  ntSize[ntClusters]   = size;
+	  ntSizeX[ntClusters]  = sizeX;
+	  ntSizeY[ntClusters]  = sizeY;
+	  ntCharge[ntClusters] = ch;
+	  ntX[ntClusters]      = x;
+	  ntY[ntClusters]      = y;
+	  ++ntClusters;
+	} else ++ntupleDropped;
+      }
+
       // Get the pixels in the Cluster
       const vector<SiPixelCluster::Pixel>& pixelsVec = clustIt->pixels();
       if(printLocal) cout<<" Pixels in this cluster "<<endl;
@@ -888,6 +936,11 @@ void ReadPixClusters::analyze(const edm::Event& e,
     
   } // detunits loop
 
+  if(ntuple) {
+    ntRun = run; ntEvent = event; ntLumi = lumiBlock; ntBx = bx;
+    ntuple->Fill();
+  }
+
   
 
   if( 0 ) {
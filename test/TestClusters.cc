@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <vector>
 
 #include "DataFormats/Common/interface/Handle.h"
 #include "FWCore/Framework/interface/ESHandle.h"
@@ -31,10 +32,7 @@
 #include "DataFormats/Common/interface/Ref.h"
 #include "DataFormats/DetId/interface/DetId.h"
 
-#include "DataFormats/SiPixelDetId/interface/PXBDetId.h" 
-#include "DataFormats/SiPixelDetId/interface/PXFDetId.h" 
 #include "DataFormats/SiPixelDetId/interface/PixelSubdetector.h"
-#include "DataFormats/SiPixelDetId/interface/PixelBarrelName.h"
 
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetUnit.h"
 #include "Geometry/TrackerGeometryBuilder/interface/PixelGeomDetType.h"
@@ -83,559 +81,35 @@
 #include <TH1F.h>
 #include <TProfile.h>
 
-using namespace std;
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelModuleIndex.h"
+#include "RecoLocalTracker/SiPixelClusterizer/test/PixelBxAccumulator.h"
+#include "RecoLocalTracker/SiPixelClusterizer/test/PixelRocOccupancy.h"
+#include "RecoLocalTracker/SiPixelClusterizer/test/PixelBunchPattern.h"
+#include "RecoLocalTracker/SiPixelClusterizer/test/PixelLumiSummary.h"
 
-#define HISTOS
-#define L1
-//#define HLT
-//#define HI
-#define ROC_EFF
-#define Lumi
+using namespace std;
 
-#define BX
 
 //=======================================================================
-#ifdef BX
-class getBX {
-
-public:
-  getBX(void);
-  ~getBX(void);
-  int find(int bx);
-
-private:
-  int limit;
-  int trains;
-  int train_start[40];
-  int train_stop[40];
-  int beam1_start[40];
-  int beam1_stop[40];
-  int beam2_start[40];
-  int beam2_stop[40];
+// 50ns fill scheme of 2011 (22 trains), for the runs not in the BunchPatternFile
+// collisions, beam1 and beam2 from-to
+const PixelBunchPattern::Train defaultTrains[] = {
+  {   7,  24,    1,    5,   25,   29}, {  66, 137, -1, -1, -1, -1}, { 146, 217, -1, -1, -1, -1},
+  { 226, 297, -1, -1, -1, -1}, { 306, 377, -1, -1, -1, -1}, { 413, 484, -1, -1, -1, -1},
+  { 493, 564, -1, -1, -1, -1}, { 573, 644, -1, -1, -1, -1}, { 653, 724, -1, -1, -1, -1},
+  { 773, 844, -1, -1, -1, -1}, { 853, 924, -1, -1, -1, -1}, { 960,1031, -1, -1, -1, -1},
+  {1040,1111, -1, -1, -1, -1}, {1120,1191, -1, -1, -1, -1}, {1200,1271, -1, -1, -1, -1},
+  {1307,1378, -1, -1, -1, -1}, {1387,1458, -1, -1, -1, -1}, {1467,1538, -1, -1, -1, -1},
+  {1547,1618, -1, -1, -1, -1},
+  {1667,1726, 1727, 1734, 1655, 1666},
+  {1735,1738, -1, -1, -1, -1},
+  {1747,1806, 1807, 1818, 1739, 1745}
 };
-
-getBX::getBX(void) {
-  limit=1841;
-  trains = 22;
-  int count = 0;
-
-  // train 1
-  train_start[count] = 7;
-  train_stop[count] = 24;
-  beam1_start[count] = 1;
-  beam1_stop[count] = 5;
-  beam2_start[count] = 25;
-  beam2_stop[count] = 29;
-
-  // train 2
-  count++;
-  train_start[count] = 66;
-  train_stop[count] = 137;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 3
-  count++;
-  train_start[count] = 146;
-  train_stop[count] = 217;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 4
-  count++;
-  train_start[count] = 226;
-  train_stop[count] = 297;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 5
-  count++;
-  train_start[count] = 306;
-  train_stop[count] = 377;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 6
-  count++;
-  train_start[count] = 413;
-  train_stop[count] = 484;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 7
-  count++;
-  train_start[count] = 493;
-  train_stop[count] = 564;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 8
-  count++;
-  train_start[count] = 573;
-  train_stop[count] = 644;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 9
-  count++;
-  train_start[count] = 653;
-  train_stop[count] = 724;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 10
-  count++;
-  train_start[count] = 773;
-  train_stop[count] = 844;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-
-  // train 11
-  count++;
-  train_start[count] = 853;
-  train_stop[count] = 924;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 12
-  count++;
-  train_start[count] = 960;
-  train_stop[count] = 1031;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 13
-  count++;
-  train_start[count] = 1040;
-  train_stop[count] = 1111;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 14
-  count++;
-  train_start[count] = 1120;
-  train_stop[count] = 1191;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 15
-  count++;
-  train_start[count] = 1200;
-  train_stop[count] = 1271;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 16
-  count++;
-  train_start[count] = 1307;
-  train_stop[count] = 1378;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 17
-  count++;
-  train_start[count] = 1387;
-  train_stop[count] = 1458;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 18
-  count++;
-  train_start[count] = 1467;
-  train_stop[count] = 1538;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 19
-  count++;
-  train_start[count] = 1547;
-  train_stop[count] = 1618;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 20
-  count++;
-  train_start[count] = 1667;
-  train_stop[count] = 1726;
-  beam1_start[count] = 1727;
-  beam1_stop[count] = 1734;
-  beam2_start[count] = 1655;
-  beam2_stop[count] = 1666;
-
-  // train 21
-  count++;
-  train_start[count] = 1735;
-  train_stop[count] = 1738;
-  beam1_start[count] = -1;
-  beam1_stop[count] = -1;
-  beam2_start[count] = -1;
-  beam2_stop[count] = -1;
-
-  // train 22
-  count++;
-  train_start[count] = 1747;
-  train_stop[count]  = 1806;
-  beam1_start[count] = 1807;
-  beam1_stop[count]  = 1818;
-  beam2_start[count] = 1739;
-  beam2_stop[count]  = 1745;
-
-  cout<<" number of trains "<<trains<<" "<<limit<<endl;
-}
-
-getBX::~getBX(void) {
-}
-
-int getBX::find(int bx) {
-  // invalid -1, empty 0. beam1 1, beam2 2, collision 3, collison+1 4, beam1+1 5,  beam2+1 6 
-
-  if(bx>limit) return (-1);
-  //cout<<bx<<endl;
-
-  // Check collisions
-  for(int train=0;train<trains;++train) {
-    //cout<<bx<<" "<<train<<endl;
-
-    for(int b=train_start[train];b<=train_stop[train];b+=2) {
-      //cout<<bx<<" "<<train<<" "<<b<<endl;
-      if(bx == b) return (3);  // collision
-      else if(bx == (b+1)) return (4); // collision+1
-    }
-    
-    if(beam1_start[train]!= -1) {
-      for(int b=beam1_start[train];b<=beam1_stop[train];b+=2) {
-	//cout<<bx<<" "<<train<<" "<<b<<endl;
-	if(bx == b) return (1);  // beam1
-	else if(bx == (b+1)) return (5); // beam1+1
-      }
-    }
- 
-    if(beam2_start[train]!= -1) {
-      for(int b=beam2_start[train];b<=beam2_stop[train];b+=2) {
-	//cout<<bx<<" "<<train<<" "<<b<<endl;
-	if(bx == b) return (2);  // beam1
-	else if(bx == (b+1)) return (6); // beam1+1
-      }
-    }
-
-  }  // loop trains
- 
-  //cout<<bx<<endl;
-
-  return 0; // return no collision 
-}
-
-#endif
-//=========================================================================
-
-
-
-//=======================================================================
-
-// decode a simplified ROC address
- int rocId(int col, int row) {
-   int rocRow = row/80;
-   int rocCol = col/52;
-   int rocId = rocCol + rocRow*8;
-   return rocId;
- }
-
+const int defaultLimit = 1841;
 //=========================================================================
-#ifdef ROC_EFF
-
-class rocEfficiency {
-public:
-  rocEfficiency(void);
-  ~rocEfficiency(void);
-  void addPixel(int layer, int ladder, int module, int roc);
-  float getRoc(int layer, int ladder, int module, int roc);
-  float getModule(int layer, int ladder, int module, float & half1, float & half2);
-  //int analyzeModule(int layer, int ladder, int module);
-
-  // return array index
-  inline int transformLadder1(int ladder) {
-    if(ladder>10 || ladder<-10 || ladder==0) {
-      cout<<" wrong ladder-1 id "<<ladder<<cout;
-      return (-1);
-    }
-    if(ladder<0) return (ladder+10);
-    else return (ladder+10-1);
-  };
-  inline int transformLadder2(int ladder) {
-    if(ladder>16 || ladder<-16 || ladder==0) {
-      cout<<" wrong ladder-2 id "<<ladder<<cout;
-      return (-1);
-    }
-    if(ladder<0) return (ladder+16);
-    else return (ladder+16-1);
-  };
-  inline int transformLadder3(int ladder) {
-    if(ladder>22 || ladder<-22 || ladder==0) {
-      cout<<" wrong ladder-3 id "<<ladder<<cout;
-      return (-1);
-    }
-    if(ladder<0) return (ladder+22);
-    else return (ladder+22-1);
-  };
-  inline int transformModule(int module) {
-    if(module>4 || module<-4 || module==0) {
-      cout<<" wrong module id "<<module<<cout;
-      return (-1);
-    }
-    if(module<0) return (module+4);
-    else return (module+4-1);
-  };
-
-
-private:
-  int pixelsLayer1[20][8][16];
-  int pixelsLayer2[32][8][16];
-  int pixelsLayer3[44][8][16];
-};
-
-rocEfficiency::rocEfficiency(void) {
-
-  cout<<" clear"<<endl;
-  for(int lad1=0;lad1<20;++lad1)
-    for(int mod1=0;mod1<8;++mod1)
-      for(int roc1=0;roc1<16;++roc1)
-        pixelsLayer1[lad1][mod1][roc1]=0;
-
-  for(int lad2=0;lad2<32;++lad2)
-    for(int mod2=0;mod2<8;++mod2)
-      for(int roc2=0;roc2<16;++roc2)
-        pixelsLayer2[lad2][mod2][roc2]=0;
-
-  for(int lad3=0;lad3<44;++lad3)
-    for(int mod3=0;mod3<8;++mod3)
-      for(int roc3=0;roc3<16;++roc3)
-        pixelsLayer3[lad3][mod3][roc3]=0;
-
-}
-
-rocEfficiency::~rocEfficiency(void) {
-//   cout<<" clear"<<endl;
-//   for(int lad1=0;lad1<20;++lad1)
-//     for(int mod1=0;mod1<8;++mod1)
-//       for(int col1=0;col1<416;++col1)
-//      for(int row1=0;row1<160;++row1)
-//        if(pixelsLayer1[lad1][mod1][col1][row1]>0)
-//          cout<<lad1<<" "<<mod1<<" "<<col1<<" "<<row1<<" "
-//              <<pixelsLayer1[lad1][mod1][col1][row1] <<endl;
-}
-
-void rocEfficiency::addPixel(int layer, int ladder, int module, int roc) {
-
-  if(roc<0 || roc>=16) {
-    cout<<" wrong roc number "<<roc<<endl;
-    return;
-  }
-
-  int module0 = transformModule(module);
-  if(module0<0 ||module0>=8) {
-    cout<<" wrong module index "<<module0<<" "<<module<<endl;
-    return;
-  }
-
-  int ladder0=0;
-  switch(layer) {
-  case 1:
-    ladder0 = transformLadder1(ladder);
-    //cout<<layer<<" "<<ladder0<<" "<<module0<<" "<<col<<" "<<row<<endl;
-    if(ladder0<0 || ladder0>=20)
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-    else
-      pixelsLayer1[ladder0][module0][roc]++;
-    break;
-  case 2:
-    ladder0 = transformLadder2(ladder);
-    if(ladder0<0 || ladder0>=32)
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-    else
-      pixelsLayer2[ladder0][module0][roc]++;
-    break;
-  case 3:
-    ladder0 = transformLadder3(ladder);
-    if(ladder0<0 || ladder0>=44)
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-    else
-      pixelsLayer3[ladder0][module0][roc]++;
-    break;
-  default:
-    break;
-  }
-}
-
-float rocEfficiency::getRoc(int layer, int ladder, int module, int roc) {
-
-  if(roc<0 || roc>=16) {
-    cout<<" wrong roc number "<<roc<<endl;
-    return -1.;
-  }
-  int module0 = transformModule(module);
-  if(module0<0 ||module0>=8) {
-    cout<<" wrong module index "<<module0<<" "<<module<<endl;
-    return -1.;
-  }
-
-  float count=0.;
-  int ladder0=0;
-
-  switch(layer) {
-  case 1:
-    if( (abs(ladder)==1 || abs(ladder)==10) && roc>7 ) { // find half modules
-      count = -1.;  // invalid
-    } else {
-      ladder0 = transformLadder1(ladder);
-      if(ladder0<0 || ladder0>=20) {
-        cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-        count=-1.;
-      } else
-        count = float(pixelsLayer1[ladder0][module0][roc]);
-      //if(ladder0==10 && module0==5 && col==9 && row==0) cout<<count<<endl;
-    }
-    break;
-  case 2:
-    if( (abs(ladder)==1 || abs(ladder)==16) && roc>7 ) { // find half modules
-      count = -1.;  // invalid
-    } else {
-      ladder0 = transformLadder2(ladder);
-      if(ladder0<0 || ladder0>=32) {
-        cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-        count=-1.;
-      } else
-        count = float(pixelsLayer2[ladder0][module0][roc]);
-    }
-    break;
-  case 3:
-    if( (abs(ladder)==1 || abs(ladder)==22) && roc>7 ) { // find half modules
-      count = -1;  // invalid
-    } else {
-      ladder0 = transformLadder3(ladder);
-      if(ladder0<0 || ladder0>=44) {
-        cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-        count=-1.;
-      } else
-        count = float(pixelsLayer3[ladder0][module0][roc]);
-    }
-    break;
-  default:
-    break;
-  }
-  return count;
-}
-
-// Return counts averaged per ROC (count per module / number of full ROCs ) 
-float rocEfficiency::getModule(int layer, int ladder, int module, float & half1, float & half2 ) {
-  half1=0; half2=0;
-  int module0 = transformModule(module);
-  if(module0<0 ||module0>=8) {
-    cout<<" wrong module index "<<module0<<" "<<module<<endl;
-    return -1.;
-  }
 
-  float count=0;
-  int rocs=0;
-  int ladder0=0;
 
-  switch(layer) {
-  case 1:
-    ladder0 = transformLadder1(ladder);
-    if(ladder0<0 || ladder0>=20) {
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-      return -1.;
-    }
-    for(int roc=0;roc<16;++roc) {
-      //if( !((abs(ladder)==1 || abs(ladder)==10) && roc>7) ) // treat half-modules
-      float tmp = float(pixelsLayer1[ladder0][module0][roc]);
-      count += tmp;
-      if(roc<8) half1 += tmp; 
-      else      half2 += tmp;
-      if(tmp>0) rocs++;
-    }
-    break;
-
-  case 2:
-    ladder0 = transformLadder2(ladder);
-    if(ladder0<0 || ladder0>=32) {
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-      return -1.;
-    }
-    for(int roc=0;roc<16;++roc) {
-      //if( !((abs(ladder)==1 || abs(ladder)==22) && roc>7) ) // treat half-modules
-      float tmp = float(pixelsLayer2[ladder0][module0][roc]);
-      count += tmp;
-      if(roc<8) half1 += tmp; 
-      else      half2 += tmp;
-      if(tmp>0) rocs++;
-
-    }
-    break;
-
-  case 3:
-    ladder0 = transformLadder3(ladder);
-    if(ladder0<0 || ladder0>=44) {
-      cout<<" wrong ladder index "<<ladder0<<" "<<ladder<<endl;
-      return -1.;
-    }
-    for(int roc=0;roc<16;++roc) {
-      //if( !((abs(ladder)==1 || abs(ladder)==22) && roc>7) ) // treat half-modules
-      float tmp = float(pixelsLayer3[ladder0][module0][roc]);
-      count += tmp;
-      if(roc<8) half1 += tmp; 
-      else      half2 += tmp;
-      if(tmp>0) rocs++;
 
-    }
-    break;
-
-  default:
-    break;
-  }
-  //cout<<count<<" "<<rocs<<" "<<ladder<<" "<<module<<" "<<ladder0<<" "<<module0<<endl;
-  if(rocs>0) count = count/float(rocs);  // return counts per ROC (full rocs only)
-  if(count<0) cout<<" VERY VERY WRONG "<<count<<endl;
-  return count;
-}
-
-#endif
 
 //==========================================================================================
 
@@ -648,7 +122,9 @@ class TestClusters : public edm::EDAnalyzer {
   virtual void beginRun(const edm::EventSetup& iSetup);
   virtual void beginJob();
   virtual void endJob();
-  
+  virtual void beginLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const& es);
+  virtual void endLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const& es);
+
  private:
   edm::ParameterSet conf_;
   edm::InputTag src_;
@@ -682,9 +158,7 @@ class TestClusters : public edm::EDAnalyzer {
   TH1D *hchargen3,*hchargen4;
   TH2D *hchargen5;
 
-#ifdef BX
   TH1D *hchargebx1,*hchargebx2,*hchargebx3,*hchargebx4,*hchargebx5,*hchargebx6;
-#endif
 
   TH1D *hclusPerDet1,*hclusPerDet2,*hclusPerDet3;
   TH1D *hpixPerDet1,*hpixPerDet2,*hpixPerDet3;
@@ -759,6 +233,15 @@ class TestClusters : public edm::EDAnalyzer {
   TProfile *hpixbx, *hclubx, *hpvbx, *hpixbxn, *hclubxn, *hpvbxn, *hcharClubx, *hcharPixbx,
     *hsizeClubx, *hsizeYClubx;
   TProfile *hinstbx;
+
+  // dense module numbering, for the per module arrays
+  SiPixelModuleIndex moduleIndex;
+
+  // per bx histos filled through the accumulator, merged at the end of each LS
+  PixelBxAccumulator bxAccumulator;
+  enum { cbx, cbx0, cbx1, cbx2, cbx3, cbx4, cbx5, cbx6, cbx7, cbx8, cbx9, cbx10,
+	 cpixbx, cclubx, ccharClubx };
+
   TProfile *hcharCluLumi,*hcharPixLumi,*hsizeCluLumi,*hsizeXCluLumi,*hsizeYCluLumi; 
 
   TProfile *hcluLumi,*hpixLumi;
@@ -769,20 +252,35 @@ class TestClusters : public edm::EDAnalyzer {
   //TProfile *hclusbx11lsn,*hclusbx12lsn,*hclusbx13lsn,*hclusbx14lsn,*hclusbx15lsn,*hclusbx16lsn,*hclusbx17lsn,
   //*hclusbx18lsn,*hclusbx19lsn; 
 
-#ifdef ROC_EFF
-  rocEfficiency * pixEff;
+  PixelRocOccupancy rocOccupancy;
+  struct WatchedRoc { int roc; TH2F * h; float bin; };  // global roc number
+  std::vector<WatchedRoc> watchedRocs;  // followed per lumi section in hrocHits*ls
+  void watchRocs();
 
   TH2F *hbadMap1, *hbadMap2, *hbadMap3;    // modules with bad rocs
   TH2F *hrocHits1ls,*hrocHits2ls,*hrocHits3ls,*hmoduleHits1ls,*hmoduleHits2ls,*hmoduleHits3ls;
   TH1D *hcountInRoc1,*hcountInRoc2,*hcountInRoc3,*hcountInRoc12,*hcountInRoc22,*hcountInRoc32;
-#endif
+  TH1D *hcountInRoc4,*hcountInRoc42;
 
-#ifdef BX
-  getBX * getbx;
-#endif
+  PixelBunchPattern bunchPattern;
 
-  // To correct lumi  
+  // analysis blocks, selected in beginJob from the Features parameter
+  bool doHistos, doL1, doHLT, doHeavyIon, doRocEff, doLumi, doBX;
+  void selectFeatures();
+
+  // To correct lumi
   LumiCorrector * lumiCorrector;
+  // lumi of the current lumi section, set in beginLuminosityBlock
+  float lsLumiAv;              // corrected, per bx
+  std::vector<float> lsLumiBx; // per bx, index = bx
+
+  // HLT menu of the last TriggerResults, the path index is the bit
+  edm::ParameterSetID hltMenu;
+  unsigned int hltPaths;
+
+  // per lumi section averages, appended to the LumiSummaryFile at each endLumi
+  PixelLumiSummary lumiSummary;
+  int lsClus, lsPix, lsClusN, lsPixN, lsPvs, lsInst;
 };
 
 /////////////////////////////////////////////////////////////////
@@ -795,6 +293,10 @@ TestClusters::TestClusters(edm::ParameterSet const& conf)
   //src_ =  conf.getParameter<edm::InputTag>( "src" );
   if(PRINT) cout<<" Construct "<<endl;
 
+  lsLumiAv = 0.;
+  hltPaths = 0;
+  // booked with the histos feature only, the bx accumulator skips them if not
+  hpixbx = 0; hclubx = 0; hcharClubx = 0;
 }
 // Virtual destructor needed.
 TestClusters::~TestClusters() { }  
@@ -808,61 +310,76 @@ void TestClusters::beginRun(const edm::EventSetup& iSetup) {
 void TestClusters::beginJob() {
   cout << "Initialize PixelClusterTest " <<endl;
 
+  selectFeatures();
+
+  // before the booking: with a summary file the clus/pix vs ls profiles are not booked
+  lsClus  = lumiSummary.add("clus");   // clusters per event, as hclusls
+  lsPix   = lumiSummary.add("pix");    // pixels, hpixls
+  lsClusN = lumiSummary.add("clusn");  // clusters/lumi, hcluslsn
+  lsPixN  = lumiSummary.add("pixn");   // pixels/lumi, hpixlsn
+  lsPvs   = lumiSummary.add("pvs");    // good pvs, hpvls
+  lsInst  = lumiSummary.add("inst");   // inst. lumi per bx, hinstlsbx
+  string summaryFile = conf_.getUntrackedParameter<string>("LumiSummaryFile","");
+  if(summaryFile!="" && lumiSummary.open(summaryFile)) 
+    cout<<" per lumi section summaries appended to "<<summaryFile<<endl;
+
   edm::Service<TFileService> fs;
 
   //=====================================================================
 
-  hladder1id = fs->make<TH1D>( "hladder1id", "Ladder L1 id", 23, -11.5, 11.5);
-  hladder2id = fs->make<TH1D>( "hladder2id", "Ladder L2 id", 35, -17.5, 17.5);
-  hladder3id = fs->make<TH1D>( "hladder3id", "Ladder L3 id", 47, -23.5, 23.5);
-  hz1id = fs->make<TH1D>( "hz1id", "Z-index id L1", 11, -5.5, 5.5);
-  hz2id = fs->make<TH1D>( "hz2id", "Z-index id L2", 11, -5.5, 5.5);
-  hz3id = fs->make<TH1D>( "hz3id", "Z-index id L3", 11, -5.5, 5.5);
-
   int sizeH=200;
   float lowH = -0.5;
   float highH = 199.5;
 
-  hclusPerDet1 = fs->make<TH1D>( "hclusPerDet1", "Clus per det l1",
-			    sizeH, lowH, highH);
-  hclusPerDet2 = fs->make<TH1D>( "hclusPerDet2", "Clus per det l2",
-			    sizeH, lowH, highH);
-  hclusPerDet3 = fs->make<TH1D>( "hclusPerDet3", "Clus per det l3",
-			    sizeH, lowH, highH);
-
-  sizeH=1000;
-  highH = 1999.5;
-  hpixPerDet1 = fs->make<TH1D>( "hpixPerDet1", "Pix per det l1",
-			    sizeH, lowH, highH);
-  hpixPerDet2 = fs->make<TH1D>( "hpixPerDet2", "Pix per det l2",
-			    sizeH, lowH, highH);
-  hpixPerDet3 = fs->make<TH1D>( "hpixPerDet3", "Pix per det l3",
-			    sizeH, lowH, highH);
-
-  hpixPerDet11 = fs->make<TH1D>( "hpixPerDet11", "Pix per det l1 - ring 1",
-			    sizeH, lowH, highH);
-  hpixPerDet12 = fs->make<TH1D>( "hpixPerDet12", "Pix per det l1 - ring 2",
-			    sizeH, lowH, highH);
-  hpixPerDet13 = fs->make<TH1D>( "hpixPerDet13", "Pix per det l1 - ring 3",
-			    sizeH, lowH, highH);
-  hpixPerDet14 = fs->make<TH1D>( "hpixPerDet14", "Pix per det l1 - ring 4",
-			    sizeH, lowH, highH);
-  hpixPerDet21 = fs->make<TH1D>( "hpixPerDet21", "Pix per det l2 - ring 1",
-			    sizeH, lowH, highH);
-  hpixPerDet22 = fs->make<TH1D>( "hpixPerDet22", "Pix per det l2 - ring 2",
-			    sizeH, lowH, highH);
-  hpixPerDet23 = fs->make<TH1D>( "hpixPerDet23", "Pix per det l2 - ring 3",
-			    sizeH, lowH, highH);
-  hpixPerDet24 = fs->make<TH1D>( "hpixPerDet24", "Pix per det l2 - ring 4",
-			    sizeH, lowH, highH);
-  hpixPerDet31 = fs->make<TH1D>( "hpixPerDet31", "Pix per det l3 - ring 1",
-			    sizeH, lowH, highH);
-  hpixPerDet32 = fs->make<TH1D>( "hpixPerDet32", "Pix per det l3 - ring 2",
-			    sizeH, lowH, highH);
-  hpixPerDet33 = fs->make<TH1D>( "hpixPerDet33", "Pix per det l3 - ring 3",
-			    sizeH, lowH, highH);
-  hpixPerDet34 = fs->make<TH1D>( "hpixPerDet34", "Pix per det l3 - ring 4",
-			    sizeH, lowH, highH);
+  // per pixel, cluster and module histos
+  if(doHistos) {
+    hladder1id = fs->make<TH1D>( "hladder1id", "Ladder L1 id", 23, -11.5, 11.5);
+    hladder2id = fs->make<TH1D>( "hladder2id", "Ladder L2 id", 35, -17.5, 17.5);
+    hladder3id = fs->make<TH1D>( "hladder3id", "Ladder L3 id", 47, -23.5, 23.5);
+    hz1id = fs->make<TH1D>( "hz1id", "Z-index id L1", 11, -5.5, 5.5);
+    hz2id = fs->make<TH1D>( "hz2id", "Z-index id L2", 11, -5.5, 5.5);
+    hz3id = fs->make<TH1D>( "hz3id", "Z-index id L3", 11, -5.5, 5.5);
+
+    hclusPerDet1 = fs->make<TH1D>( "hclusPerDet1", "Clus per det l1",
+  			    sizeH, lowH, highH);
+    hclusPerDet2 = fs->make<TH1D>( "hclusPerDet2", "Clus per det l2",
+  			    sizeH, lowH, highH);
+    hclusPerDet3 = fs->make<TH1D>( "hclusPerDet3", "Clus per det l3",
+  			    sizeH, lowH, highH);
+
+    sizeH=1000;
+    highH = 1999.5;
+    hpixPerDet1 = fs->make<TH1D>( "hpixPerDet1", "Pix per det l1",
+  			    sizeH, lowH, highH);
+    hpixPerDet2 = fs->make<TH1D>( "hpixPerDet2", "Pix per det l2",
+  			    sizeH, lowH, highH);
+    hpixPerDet3 = fs->make<TH1D>( "hpixPerDet3", "Pix per det l3",
+  			    sizeH, lowH, highH);
+
+    hpixPerDet11 = fs->make<TH1D>( "hpixPerDet11", "Pix per det l1 - ring 1",
+  			    sizeH, lowH, highH);
+    hpixPerDet12 = fs->make<TH1D>( "hpixPerDet12", "Pix per det l1 - ring 2",
+  			    sizeH, lowH, highH);
+    hpixPerDet13 = fs->make<TH1D>( "hpixPerDet13", "Pix per det l1 - ring 3",
+  			    sizeH, lowH, highH);
+    hpixPerDet14 = fs->make<TH1D>( "hpixPerDet14", "Pix per det l1 - ring 4",
+  			    sizeH, lowH, highH);
+    hpixPerDet21 = fs->make<TH1D>( "hpixPerDet21", "Pix per det l2 - ring 1",
+  			    sizeH, lowH, highH);
+    hpixPerDet22 = fs->make<TH1D>( "hpixPerDet22", "Pix per det l2 - ring 2",
+  			    sizeH, lowH, highH);
+    hpixPerDet23 = fs->make<TH1D>( "hpixPerDet23", "Pix per det l2 - ring 3",
+  			    sizeH, lowH, highH);
+    hpixPerDet24 = fs->make<TH1D>( "hpixPerDet24", "Pix per det l2 - ring 4",
+  			    sizeH, lowH, highH);
+    hpixPerDet31 = fs->make<TH1D>( "hpixPerDet31", "Pix per det l3 - ring 1",
+  			    sizeH, lowH, highH);
+    hpixPerDet32 = fs->make<TH1D>( "hpixPerDet32", "Pix per det l3 - ring 2",
+  			    sizeH, lowH, highH);
+    hpixPerDet33 = fs->make<TH1D>( "hpixPerDet33", "Pix per det l3 - ring 3",
+  			    sizeH, lowH, highH);
+    hpixPerDet34 = fs->make<TH1D>( "hpixPerDet34", "Pix per det l3 - ring 4",
+  			    sizeH, lowH, highH);
 
 //   hpixPerDet100 = fs->make<TH1D>( "hpixPerDet100", "Pix per det",
 // 			    sizeH, lowH, highH);
@@ -877,89 +394,73 @@ void TestClusters::beginJob() {
 //   hpixPerDet105 = fs->make<TH1D>( "hpixPerDet105", "Pix per det",
 // 			    sizeH, lowH, highH);
 
-  sizeH=1000;
-  highH = 999.5;
-  hpixPerLink1 = fs->make<TH1D>( "hpixPerLink1", "Pix per link l1",
-			    sizeH, lowH, highH);
-  hpixPerLink2 = fs->make<TH1D>( "hpixPerLink2", "Pix per link l2",
-			    sizeH, lowH, highH);
-  hpixPerLink3 = fs->make<TH1D>( "hpixPerLink3", "Pix per link l3",
-			    sizeH, lowH, highH);
-
-  sizeH=3000;
-#ifdef HI
-  highH = 19999.5;
-#else
-  highH = 2999.5;
-#endif
-
-  hclusPerLay1 = fs->make<TH1D>( "hclusPerLay1", "Clus per layer l1",
-				 sizeH, lowH, highH);
-  hclusPerLay2 = fs->make<TH1D>( "hclusPerLay2", "Clus per layer l2",
-			    sizeH, lowH, highH);
-  hclusPerLay3 = fs->make<TH1D>( "hclusPerLay3", "Clus per layer l3",
-			    sizeH, lowH, highH);
-
-  hclus = fs->make<TH1D>( "hclus", "Clus per event",
-			    sizeH, lowH, 4.*highH);
-  hclusBPix = fs->make<TH1D>( "hclusBPix", "Bpix Clus per event",
-			    sizeH, lowH, 3.*highH);
-  hclusFPix = fs->make<TH1D>( "hclusFPix", "Fpix Clus per event",
-			    sizeH, lowH, highH);
-
-#ifdef HI
-  highH = 3999.5;
-#else
-  highH = 1999.5;
-#endif
-
-  hclusPerDisk1 = fs->make<TH1D>( "hclusPerDisk1", "Clus per disk1",
-			    sizeH, lowH, highH);
-  hclusPerDisk2 = fs->make<TH1D>( "hclusPerDisk2", "Clus per disk2",
-			    sizeH, lowH, highH);
-  hclusPerDisk3 = fs->make<TH1D>( "hclusPerDisk3", "Clus per disk3",
-			    sizeH, lowH, highH);
-  hclusPerDisk4 = fs->make<TH1D>( "hclusPerDisk4", "Clus per disk4",
-			    sizeH, lowH, highH);
-
-#ifdef HI
-  highH = 9999.5;
-#else
-  highH = 3999.5;
-#endif
-
-  hpixPerDisk1 = fs->make<TH1D>( "hpixPerDisk1", "Pix per disk1",
-			    sizeH, lowH, highH);
-  hpixPerDisk2 = fs->make<TH1D>( "hpixPerDisk2", "Pix per disk2",
-			    sizeH, lowH, highH);
-  hpixPerDisk3 = fs->make<TH1D>( "hpixPerDisk3", "Pix per disk3",
-			    sizeH, lowH, highH);
-  hpixPerDisk4 = fs->make<TH1D>( "hpixPerDisk4", "Pix per disk4",
-			    sizeH, lowH, highH);
-
-
-  sizeH=2000;
-#ifdef HI
-  highH = 99999.5;
-#else
-  highH = 14999.5;
-#endif
-
-  hpixPerLay1 = fs->make<TH1D>( "hpixPerLay1", "Pix per layer l1",
-				 sizeH, lowH, highH);
-  hpixPerLay2 = fs->make<TH1D>( "hpixPerLay2", "Pix per layer l2",
-				 sizeH, lowH, highH);
-  hpixPerLay3 = fs->make<TH1D>( "hpixPerLay3", "Pix per layer l3",
-				 sizeH, lowH, highH);
-
-  hdigis = fs->make<TH1D>( "hdigis", "All Digis in clus per event",
-				 sizeH, lowH, 4.*highH);
-  hdigisB = fs->make<TH1D>( "hdigisB", "BPix Digis in clus per event",
-				 sizeH, lowH, 3.*highH);
-  hdigisF = fs->make<TH1D>( "hdigisF", "FPix Digis in clus per event",
-				 sizeH, lowH, highH);
-
-  //#ifdef BX
+    sizeH=1000;
+    highH = 999.5;
+    hpixPerLink1 = fs->make<TH1D>( "hpixPerLink1", "Pix per link l1",
+  			    sizeH, lowH, highH);
+    hpixPerLink2 = fs->make<TH1D>( "hpixPerLink2", "Pix per link l2",
+  			    sizeH, lowH, highH);
+    hpixPerLink3 = fs->make<TH1D>( "hpixPerLink3", "Pix per link l3",
+  			    sizeH, lowH, highH);
+
+    sizeH=3000;
+    highH = doHeavyIon ? 19999.5 : 2999.5;
+
+    hclusPerLay1 = fs->make<TH1D>( "hclusPerLay1", "Clus per layer l1",
+  				 sizeH, lowH, highH);
+    hclusPerLay2 = fs->make<TH1D>( "hclusPerLay2", "Clus per layer l2",
+  			    sizeH, lowH, highH);
+    hclusPerLay3 = fs->make<TH1D>( "hclusPerLay3", "Clus per layer l3",
+  			    sizeH, lowH, highH);
+
+    hclus = fs->make<TH1D>( "hclus", "Clus per event",
+  			    sizeH, lowH, 4.*highH);
+    hclusBPix = fs->make<TH1D>( "hclusBPix", "Bpix Clus per event",
+  			    sizeH, lowH, 3.*highH);
+    hclusFPix = fs->make<TH1D>( "hclusFPix", "Fpix Clus per event",
+  			    sizeH, lowH, highH);
+
+    highH = doHeavyIon ? 3999.5 : 1999.5;
+
+    hclusPerDisk1 = fs->make<TH1D>( "hclusPerDisk1", "Clus per disk1",
+  			    sizeH, lowH, highH);
+    hclusPerDisk2 = fs->make<TH1D>( "hclusPerDisk2", "Clus per disk2",
+  			    sizeH, lowH, highH);
+    hclusPerDisk3 = fs->make<TH1D>( "hclusPerDisk3", "Clus per disk3",
+  			    sizeH, lowH, highH);
+    hclusPerDisk4 = fs->make<TH1D>( "hclusPerDisk4", "Clus per disk4",
+  			    sizeH, lowH, highH);
+
+    highH = doHeavyIon ? 9999.5 : 3999.5;
+
+    hpixPerDisk1 = fs->make<TH1D>( "hpixPerDisk1", "Pix per disk1",
+  			    sizeH, lowH, highH);
+    hpixPerDisk2 = fs->make<TH1D>( "hpixPerDisk2", "Pix per disk2",
+  			    sizeH, lowH, highH);
+    hpixPerDisk3 = fs->make<TH1D>( "hpixPerDisk3", "Pix per disk3",
+  			    sizeH, lowH, highH);
+    hpixPerDisk4 = fs->make<TH1D>( "hpixPerDisk4", "Pix per disk4",
+  			    sizeH, lowH, highH);
+
+
+    sizeH=2000;
+    highH = doHeavyIon ? 99999.5 : 14999.5;
+
+    hpixPerLay1 = fs->make<TH1D>( "hpixPerLay1", "Pix per layer l1",
+  				 sizeH, lowH, highH);
+    hpixPerLay2 = fs->make<TH1D>( "hpixPerLay2", "Pix per layer l2",
+  				 sizeH, lowH, highH);
+    hpixPerLay3 = fs->make<TH1D>( "hpixPerLay3", "Pix per layer l3",
+  				 sizeH, lowH, highH);
+
+    hdigis = fs->make<TH1D>( "hdigis", "All Digis in clus per event",
+  				 sizeH, lowH, 4.*highH);
+    hdigisB = fs->make<TH1D>( "hdigisB", "BPix Digis in clus per event",
+  				 sizeH, lowH, 3.*highH);
+    hdigisF = fs->make<TH1D>( "hdigisF", "FPix Digis in clus per event",
+  				 sizeH, lowH, highH);
+
+    //#ifdef BX
 //   hdigis30 = fs->make<TH1D>("hdigis30","Digis",sizeH,lowH,4.*highH);
 //   hdigis31 = fs->make<TH1D>("hdigis31","Digis",sizeH,lowH,4.*highH);
 //   hdigis32 = fs->make<TH1D>("hdigis32","Digis",sizeH,lowH,4.*highH);
@@ -976,49 +477,45 @@ void TestClusters::beginJob() {
 //   hdigis26 = fs->make<TH1D>("hdigis26","Digis",sizeH,lowH,4.*highH);
 //#endif
 
-  sizeH=1000;
-#ifdef HI
-  highH = 19999.5;
-#else
-  highH = 2999.5;
-#endif
-
-  hclus1 = fs->make<TH1D>("hclus1","Clus per event",sizeH, lowH, highH);
-  hclus2 = fs->make<TH1D>( "hclus2", "Clus per event",sizeH, lowH, highH);
-  //hclus3 = fs->make<TH1D>( "hclus3", "Clus per event",sizeH, lowH, highH);
-  //hclus4 = fs->make<TH1D>( "hclus4", "Clus per event",sizeH, lowH, highH);
-  hclus5 = fs->make<TH1D>( "hclus5", "Clus per event",sizeH, lowH, highH);
-  //hclus6 = fs->make<TH1D>( "hclus6", "Clus per event",sizeH, lowH, highH);
-  //hclus7 = fs->make<TH1D>( "hclus7", "Clus per event",sizeH, lowH, highH);
-  //hclus8 = fs->make<TH1D>( "hclus8", "Clus per event",sizeH, lowH, highH);
-  //hclus9 = fs->make<TH1D>( "hclus9", "Clus per event",sizeH, lowH, highH);
-  //hclus10 = fs->make<TH1D>( "hclus10", "Clus per event",
-  //		    sizeH, lowH, highH);
-  hclus11 = fs->make<TH1D>( "hclus11", "Clus per event",sizeH, lowH, highH);
-  hclus12 = fs->make<TH1D>( "hclus12", "Clus per event",sizeH, lowH, highH);
-  hclus13 = fs->make<TH1D>( "hclus13", "Clus per event",sizeH, lowH, highH);
-  hclus14 = fs->make<TH1D>( "hclus14", "Clus per event",sizeH, lowH, highH);
-  hclus15 = fs->make<TH1D>( "hclus15", "Clus per event",sizeH, lowH, highH);
-  hclus16 = fs->make<TH1D>( "hclus16", "Clus per event",sizeH, lowH, 999.5);
-  //hclus17 = fs->make<TH1D>( "hclus17", "Clus per event",sizeH, lowH, highH);
-  //hclus18 = fs->make<TH1D>( "hclus18", "Clus per event",sizeH, lowH, highH);
-  //hclus19 = fs->make<TH1D>( "hclus19", "Clus per event",sizeH, lowH, highH);
-  //hclus20 = fs->make<TH1D>( "hclus20", "Clus per event",
-  //			    sizeH, lowH, highH);
-  //hclus21 = fs->make<TH1D>( "hclus21", "Clus per event",
-  //		    sizeH, lowH, highH);
-  //hclus22 = fs->make<TH1D>( "hclus22", "Clus per event",
-  //		    sizeH, lowH, highH);
-  //hclus23 = fs->make<TH1D>( "hclus23", "Clus per event",sizeH, lowH, highH);
-  hclus24 = fs->make<TH1D>( "hclus24", "Clus per event",sizeH, lowH, highH);
-  //hclus25 = fs->make<TH1D>( "hclus25", "Clus per event",
-  //		    sizeH, lowH, 999.5);
-  //hclus26 = fs->make<TH1D>( "hclus26", "Clus per event",
-  //		    sizeH, lowH, highH);
-  hclus27 = fs->make<TH1D>( "hclus27", "Clus per event",sizeH, lowH, 999.5);
-  //hclus28 = fs->make<TH1D>( "hclus28", "Clus per event",sizeH, lowH, highH);
-  //hclus29 = fs->make<TH1D>( "hclus29", "Clus per event",
-  //		    sizeH, lowH, highH);
+    sizeH=1000;
+    highH = doHeavyIon ? 19999.5 : 2999.5;
+
+    hclus1 = fs->make<TH1D>("hclus1","Clus per event",sizeH, lowH, highH);
+    hclus2 = fs->make<TH1D>( "hclus2", "Clus per event",sizeH, lowH, highH);
+    //hclus3 = fs->make<TH1D>( "hclus3", "Clus per event",sizeH, lowH, highH);
+    //hclus4 = fs->make<TH1D>( "hclus4", "Clus per event",sizeH, lowH, highH);
+    hclus5 = fs->make<TH1D>( "hclus5", "Clus per event",sizeH, lowH, highH);
+    //hclus6 = fs->make<TH1D>( "hclus6", "Clus per event",sizeH, lowH, highH);
+    //hclus7 = fs->make<TH1D>( "hclus7", "Clus per event",sizeH, lowH, highH);
+    //hclus8 = fs->make<TH1D>( "hclus8", "Clus per event",sizeH, lowH, highH);
+    //hclus9 = fs->make<TH1D>( "hclus9", "Clus per event",sizeH, lowH, highH);
+    //hclus10 = fs->make<TH1D>( "hclus10", "Clus per event",
+    //		    sizeH, lowH, highH);
+    hclus11 = fs->make<TH1D>( "hclus11", "Clus per event",sizeH, lowH, highH);
+    hclus12 = fs->make<TH1D>( "hclus12", "Clus per event",sizeH, lowH, highH);
+    hclus13 = fs->make<TH1D>( "hclus13", "Clus per event",sizeH, lowH, highH);
+    hclus14 = fs->make<TH1D>( "hclus14", "Clus per event",sizeH, lowH, highH);
+    hclus15 = fs->make<TH1D>( "hclus15", "Clus per event",sizeH, lowH, highH);
+    hclus16 = fs->make<TH1D>( "hclus16", "Clus per event",sizeH, lowH, 999.5);
+    //hclus17 = fs->make<TH1D>( "hclus17", "Clus per event",sizeH, lowH, highH);
+    //hclus18 = fs->make<TH1D>( "hclus18", "Clus per event",sizeH, lowH, highH);
+    //hclus19 = fs->make<TH1D>( "hclus19", "Clus per event",sizeH, lowH, highH);
+    //hclus20 = fs->make<TH1D>( "hclus20", "Clus per event",
+    //			    sizeH, lowH, highH);
+    //hclus21 = fs->make<TH1D>( "hclus21", "Clus per event",
+    //		    sizeH, lowH, highH);
+    //hclus22 = fs->make<TH1D>( "hclus22", "Clus per event",
+    //		    sizeH, lowH, highH);
+    //hclus23 = fs->make<TH1D>( "hclus23", "Clus per event",sizeH, lowH, highH);
+    hclus24 = fs->make<TH1D>( "hclus24", "Clus per event",sizeH, lowH, highH);
+    //hclus25 = fs->make<TH1D>( "hclus25", "Clus per event",
+    //		    sizeH, lowH, 999.5);
+    //hclus26 = fs->make<TH1D>( "hclus26", "Clus per event",
+    //		    sizeH, lowH, highH);
+    hclus27 = fs->make<TH1D>( "hclus27", "Clus per event",sizeH, lowH, 999.5);
+    //hclus28 = fs->make<TH1D>( "hclus28", "Clus per event",sizeH, lowH, highH);
+    //hclus29 = fs->make<TH1D>( "hclus29", "Clus per event",
+    //		    sizeH, lowH, highH);
 // #ifdef BX
 //   hclus30=fs->make<TH1D>("hclus30","Clus per event",sizeH, lowH, highH);
 //   hclus31=fs->make<TH1D>("hclus31","Clus per event",sizeH, lowH, highH);
@@ -1032,126 +529,391 @@ void TestClusters::beginJob() {
 //   hclus39=fs->make<TH1D>("hclus39","Clus per event",sizeH, lowH, highH);
 // #endif
 
-  hdetsPerLay1 = fs->make<TH1D>( "hdetsPerLay1", "Full dets per layer l1",
-				 161, -0.5, 160.5);
-  hdetsPerLay3 = fs->make<TH1D>( "hdetsPerLay3", "Full dets per layer l3",
-				 353, -0.5, 352.5);
-  hdetsPerLay2 = fs->make<TH1D>( "hdetsPerLay2", "Full dets per layer l2",
-				 257, -0.5, 256.5);
+    hdetsPerLay1 = fs->make<TH1D>( "hdetsPerLay1", "Full dets per layer l1",
+  				 161, -0.5, 160.5);
+    hdetsPerLay3 = fs->make<TH1D>( "hdetsPerLay3", "Full dets per layer l3",
+  				 353, -0.5, 352.5);
+    hdetsPerLay2 = fs->make<TH1D>( "hdetsPerLay2", "Full dets per layer l2",
+  				 257, -0.5, 256.5);
  
-  hdets = fs->make<TH1D>( "hdets","Dets per event",2000, -0.5, 1999.5);
-  hmaxPixPerDet = fs->make<TH1D>( "hmaxPixPerDet","Max pixels per det",1000, -0.5, 999.5);
-
-  sizeH= 400;
-  lowH = 0.;
-  highH = 100.0; // charge limit in kelec
-  hcharge1 = fs->make<TH1D>( "hcharge1", "Clu charge l1", sizeH, 0.,highH); //in ke
-  hcharge2 = fs->make<TH1D>( "hcharge2", "Clu charge l2", sizeH, 0.,highH);
-  hcharge3 = fs->make<TH1D>( "hcharge3", "Clu charge l3", sizeH, 0.,highH);
-  hcharge4 = fs->make<TH1D>( "hcharge4", "Clu charge d1", sizeH, 0.,highH);
-  hcharge5 = fs->make<TH1D>( "hcharge5", "Clu charge d2", sizeH, 0.,highH);
-  //hchargen = fs->make<TH1D>( "hchargen", "Clu charge", sizeH, 0.,highH);
-  hchargen1 = fs->make<TH1D>( "hchargen1", "Clu charge", sizeH, 0.,highH);
-  hchargen2 = fs->make<TH1D>( "hchargen2", "Clu charge", sizeH, 0.,highH);
-  hchargen3 = fs->make<TH1D>( "hchargen3", "Clu charge", sizeH, 0.,highH);
-  hchargen4 = fs->make<TH1D>( "hchargen4", "Clu charge", sizeH, 0.,highH);
-
-  hchargen5 = fs->make<TH2D>( "hchargen5", "Clu charge-size", sizeH, 0.,highH,10,0.,10.);
-
-  //havCharge1 = fs->make<TH1D>( "havCharge1", "Clu charge l1", sizeH, 0.,2.*highH); //in ke
-  //havCharge2 = fs->make<TH1D>( "havCharge2", "Clu charge l2", sizeH, 0.,2.*highH);
-  //havCharge3 = fs->make<TH1D>( "havCharge3", "Clu charge l3", 110, 0.,1.1);
-  //havCharge4 = fs->make<TH1D>( "havCharge4", "Clu charge d1", sizeH, 0.,2.*highH);
-  //havCharge5 = fs->make<TH1D>( "havCharge5", "Clu charge d2", sizeH, 0.,2.*highH);
-  //havCharge6 = fs->make<TH1D>( "havCharge6", "Clu charge d2", sizeH, 0.,2.*highH);
-
-  //hcharge11 = fs->make<TH1D>( "hcharge11", "Clu charge l1", sizeH, 0.,highH);
-  //hcharge12 = fs->make<TH1D>( "hcharge12", "Clu charge l1", sizeH, 0.,highH);
-  //hcharge13 = fs->make<TH1D>( "hcharge13", "Clu charge l1", sizeH, 0.,highH);
-  //hcharge14 = fs->make<TH1D>( "hcharge14", "Clu charge l1", sizeH, 0.,highH);
-
-#ifdef BX
-  hchargebx1 = fs->make<TH1D>( "hchargebx1", "Clu charge", 100, 0.,highH); //in ke
-  hchargebx2 = fs->make<TH1D>( "hchargebx2", "Clu charge", 100, 0.,highH); //in ke
-  hchargebx3 = fs->make<TH1D>( "hchargebx3", "Clu charge", 100, 0.,highH); //in ke
-  hchargebx4 = fs->make<TH1D>( "hchargebx4", "Clu charge", 100, 0.,highH); //in ke
-  hchargebx5 = fs->make<TH1D>( "hchargebx5", "Clu charge", 100, 0.,highH); //in ke
-  hchargebx6 = fs->make<TH1D>( "hchargebx6", "Clu charge", 100, 0.,highH); //in ke
-#endif
+    hmaxPixPerDet = fs->make<TH1D>( "hmaxPixPerDet","Max pixels per det",1000, -0.5, 999.5);
+
+    sizeH= 400;
+    lowH = 0.;
+    highH = 100.0; // charge limit in kelec
+    hcharge1 = fs->make<TH1D>( "hcharge1", "Clu charge l1", sizeH, 0.,highH); //in ke
+    hcharge2 = fs->make<TH1D>( "hcharge2", "Clu charge l2", sizeH, 0.,highH);
+    hcharge3 = fs->make<TH1D>( "hcharge3", "Clu charge l3", sizeH, 0.,highH);
+    hcharge4 = fs->make<TH1D>( "hcharge4", "Clu charge d1", sizeH, 0.,highH);
+    hcharge5 = fs->make<TH1D>( "hcharge5", "Clu charge d2", sizeH, 0.,highH);
+    //hchargen = fs->make<TH1D>( "hchargen", "Clu charge", sizeH, 0.,highH);
+    hchargen1 = fs->make<TH1D>( "hchargen1", "Clu charge", sizeH, 0.,highH);
+    hchargen2 = fs->make<TH1D>( "hchargen2", "Clu charge", sizeH, 0.,highH);
+    hchargen3 = fs->make<TH1D>( "hchargen3", "Clu charge", sizeH, 0.,highH);
+    hchargen4 = fs->make<TH1D>( "hchargen4", "Clu charge", sizeH, 0.,highH);
+
+    hchargen5 = fs->make<TH2D>( "hchargen5", "Clu charge-size", sizeH, 0.,highH,10,0.,10.);
+
+    //havCharge1 = fs->make<TH1D>( "havCharge1", "Clu charge l1", sizeH, 0.,2.*highH); //in ke
+    //havCharge2 = fs->make<TH1D>( "havCharge2", "Clu charge l2", sizeH, 0.,2.*highH);
+    //havCharge3 = fs->make<TH1D>( "havCharge3", "Clu charge l3", 110, 0.,1.1);
+    //havCharge4 = fs->make<TH1D>( "havCharge4", "Clu charge d1", sizeH, 0.,2.*highH);
+    //havCharge5 = fs->make<TH1D>( "havCharge5", "Clu charge d2", sizeH, 0.,2.*highH);
+    //havCharge6 = fs->make<TH1D>( "havCharge6", "Clu charge d2", sizeH, 0.,2.*highH);
+
+    //hcharge11 = fs->make<TH1D>( "hcharge11", "Clu charge l1", sizeH, 0.,highH);
+    //hcharge12 = fs->make<TH1D>( "hcharge12", "Clu charge l1", sizeH, 0.,highH);
+    //hcharge13 = fs->make<TH1D>( "hcharge13", "Clu charge l1", sizeH, 0.,highH);
+    //hcharge14 = fs->make<TH1D>( "hcharge14", "Clu charge l1", sizeH, 0.,highH);
+
+    if(doBX) {
+      hchargebx1 = fs->make<TH1D>( "hchargebx1", "Clu charge", 100, 0.,highH); //in ke
+      hchargebx2 = fs->make<TH1D>( "hchargebx2", "Clu charge", 100, 0.,highH); //in ke
+      hchargebx3 = fs->make<TH1D>( "hchargebx3", "Clu charge", 100, 0.,highH); //in ke
+      hchargebx4 = fs->make<TH1D>( "hchargebx4", "Clu charge", 100, 0.,highH); //in ke
+      hchargebx5 = fs->make<TH1D>( "hchargebx5", "Clu charge", 100, 0.,highH); //in ke
+      hchargebx6 = fs->make<TH1D>( "hchargebx6", "Clu charge", 100, 0.,highH); //in ke
+    }
  
-  sizeH=300; // 600
-  highH = 60.0; // charge limit in kelec
-  hpixcharge1 = fs->make<TH1D>( "hpixcharge1", "Pix charge l1",sizeH, 0.,highH);//in ke
-  hpixcharge2 = fs->make<TH1D>( "hpixcharge2", "Pix charge l2",sizeH, 0.,highH);
-  hpixcharge3 = fs->make<TH1D>( "hpixcharge3", "Pix charge l3",sizeH, 0.,highH);
-  hpixcharge4 = fs->make<TH1D>( "hpixcharge4", "Pix charge d1",sizeH, 0.,highH);
-  hpixcharge5 = fs->make<TH1D>( "hpixcharge5", "Pix charge d2",sizeH, 0.,highH);
-  //hpixchargen = fs->make<TH1D>( "hpixchargen", "Pix charge",sizeH, 0.,highH);
-  hpixchargen1 = fs->make<TH1D>( "hpixchargen1", "Pix charge",sizeH, 0.,highH);
-  hpixchargen2 = fs->make<TH1D>( "hpixchargen2", "Pix charge",sizeH, 0.,highH);
+    sizeH=300; // 600
+    highH = 60.0; // charge limit in kelec
+    hpixcharge1 = fs->make<TH1D>( "hpixcharge1", "Pix charge l1",sizeH, 0.,highH);//in ke
+    hpixcharge2 = fs->make<TH1D>( "hpixcharge2", "Pix charge l2",sizeH, 0.,highH);
+    hpixcharge3 = fs->make<TH1D>( "hpixcharge3", "Pix charge l3",sizeH, 0.,highH);
+    hpixcharge4 = fs->make<TH1D>( "hpixcharge4", "Pix charge d1",sizeH, 0.,highH);
+    hpixcharge5 = fs->make<TH1D>( "hpixcharge5", "Pix charge d2",sizeH, 0.,highH);
+    //hpixchargen = fs->make<TH1D>( "hpixchargen", "Pix charge",sizeH, 0.,highH);
+    hpixchargen1 = fs->make<TH1D>( "hpixchargen1", "Pix charge",sizeH, 0.,highH);
+    hpixchargen2 = fs->make<TH1D>( "hpixchargen2", "Pix charge",sizeH, 0.,highH);
  
-  //hnpixcharge1 = fs->make<TH1D>( "hnpixcharge1", "Noise pix charge l1",sizeH, 0.,highH); 
-  //hnpixcharge2 = fs->make<TH1D>( "hnpixcharge2", "Noise pix charge l2",sizeH, 0.,highH);
-  //hnpixcharge3 = fs->make<TH1D>( "hnpixcharge3", "Noise pix charge l3",sizeH, 0.,highH);
+    //hnpixcharge1 = fs->make<TH1D>( "hnpixcharge1", "Noise pix charge l1",sizeH, 0.,highH); 
+    //hnpixcharge2 = fs->make<TH1D>( "hnpixcharge2", "Noise pix charge l2",sizeH, 0.,highH);
+    //hnpixcharge3 = fs->make<TH1D>( "hnpixcharge3", "Noise pix charge l3",sizeH, 0.,highH);
  
-  //hcols1 = fs->make<TH1D>( "hcols1", "Layer 1 cols", 500,-0.5,499.5);
-  //hcols2 = fs->make<TH1D>( "hcols2", "Layer 2 cols", 500,-0.5,499.5);
-  //hcols3 = fs->make<TH1D>( "hcols3", "Layer 3 cols", 500,-0.5,499.5);
-  //hrows1 = fs->make<TH1D>( "hrows1", "Layer 1 rows", 200,-0.5,199.5);
-  //hrows2 = fs->make<TH1D>( "hrows2", "Layer 2 rows", 200,-0.5,199.5);
-  //hrows3 = fs->make<TH1D>( "hrows3", "layer 3 rows", 200,-0.5,199.5);
-
-  hpcols1 = fs->make<TH1D>( "hpcols1", "Layer 1 pix cols", 500,-0.5,499.5);
-  hpcols2 = fs->make<TH1D>( "hpcols2", "Layer 2 pix cols", 500,-0.5,499.5);
-  hpcols3 = fs->make<TH1D>( "hpcols3", "Layer 3 pix cols", 500,-0.5,499.5);
+    //hcols1 = fs->make<TH1D>( "hcols1", "Layer 1 cols", 500,-0.5,499.5);
+    //hcols2 = fs->make<TH1D>( "hcols2", "Layer 2 cols", 500,-0.5,499.5);
+    //hcols3 = fs->make<TH1D>( "hcols3", "Layer 3 cols", 500,-0.5,499.5);
+    //hrows1 = fs->make<TH1D>( "hrows1", "Layer 1 rows", 200,-0.5,199.5);
+    //hrows2 = fs->make<TH1D>( "hrows2", "Layer 2 rows", 200,-0.5,199.5);
+    //hrows3 = fs->make<TH1D>( "hrows3", "layer 3 rows", 200,-0.5,199.5);
+
+    hpcols1 = fs->make<TH1D>( "hpcols1", "Layer 1 pix cols", 500,-0.5,499.5);
+    hpcols2 = fs->make<TH1D>( "hpcols2", "Layer 2 pix cols", 500,-0.5,499.5);
+    hpcols3 = fs->make<TH1D>( "hpcols3", "Layer 3 pix cols", 500,-0.5,499.5);
+  
+    hprows1 = fs->make<TH1D>( "hprows1", "Layer 1 pix rows", 200,-0.5,199.5);
+    hprows2 = fs->make<TH1D>( "hprows2", "Layer 2 pix rows", 200,-0.5,199.5);
+    hprows3 = fs->make<TH1D>( "hprows3", "layer 3 pix rows", 200,-0.5,199.5);
+
+
+
+    sizeH=1000;
+    highH = 999.5; // charge limit in kelec
+    hsize1 = fs->make<TH1D>( "hsize1", "layer 1 clu size",sizeH,-0.5,highH);
+    hsize2 = fs->make<TH1D>( "hsize2", "layer 2 clu size",sizeH,-0.5,highH);
+    hsize3 = fs->make<TH1D>( "hsize3", "layer 3 clu size",sizeH,-0.5,highH);
+    //hsizen = fs->make<TH1D>( "hsizen", "clu size",sizeH,-0.5,highH);
+    hsizen1 = fs->make<TH1D>( "hsizen1", "clu size",sizeH,-0.5,highH);
+    hsizen2 = fs->make<TH1D>( "hsizen2", "clu size",sizeH,-0.5,highH);
+
+    hsizex1 = fs->make<TH1D>( "hsizex1", "lay1 clu size in x",
+  		      20,-0.5,19.5);
+    hsizex2 = fs->make<TH1D>( "hsizex2", "lay2 clu size in x",
+  		      20,-0.5,19.5);
+    hsizex3 = fs->make<TH1D>( "hsizex3", "lay3 clu size in x",
+  		      20,-0.5,19.5);
+    //hsizexn = fs->make<TH1D>( "hsizexn", "clu size in x",
+    //	      20,-0.5,19.5);
+    hsizexn1 = fs->make<TH1D>( "hsizexn1", "clu size in x",
+  		      20,-0.5,19.5);
+    hsizexn2 = fs->make<TH1D>( "hsizexn2", "clu size in x",
+  		      20,-0.5,19.5);
+    hsizey1 = fs->make<TH1D>( "hsizey1", "lay1 clu size in y",
+  		      30,-0.5,29.5);
+    hsizey2 = fs->make<TH1D>( "hsizey2", "lay2 clu size in y",
+  		      30,-0.5,29.5);
+    hsizey3 = fs->make<TH1D>( "hsizey3", "lay3 clu size in y",
+  		      30,-0.5,29.5);
+    //hsizeyn = fs->make<TH1D>( "hsizeyn", "lay3 clu size in y",
+    //	      30,-0.5,29.5);
+    hsizeyn1 = fs->make<TH1D>( "hsizeyn1", "lay3 clu size in y",
+  		      30,-0.5,29.5);
+    hsizeyn2 = fs->make<TH1D>( "hsizeyn2", "lay3 clu size in y",
+  		      30,-0.5,29.5);
+
+    hpixDiskR1 = fs->make<TH1D>("hpixDiskR1","pix vs. r, disk 1",200,0.,20.);
+    hpixDiskR2 = fs->make<TH1D>("hpixDiskR2","pix vs. r, disk 2",200,0.,20.);
+
+    hlumi1  = fs->make<TH1D>("hlumi1", "lumi", 2000,0,2000.);
+
+    hl1t1 = fs->make<TH1D>("hl1t1","l1t1",128,-0.5,127.5);
+    hl1a1 = fs->make<TH1D>("hl1a1","l1a1",128,-0.5,127.5);
+
+    //hmbits1 = fs->make<TH1D>("hmbits1","hmbits1",50,-0.5,49.5);
+    //hmbits2 = fs->make<TH1D>("hmbits2","hmbits2",50,-0.5,49.5);
+    //hmbits3 = fs->make<TH1D>("hmbits3","hmbits3",50,-0.5,49.5);
+
+    hlt3 = fs->make<TH1D>("hlt3","hlt3",256,-0.5,255.5);
+
+
+    hgz1 = fs->make<TH1D>("hgz1","layer1, clu global z",600,-30.,30.);
+    hgz2 = fs->make<TH1D>("hgz2","layer2, clu global z",600,-30.,30.);
+    hgz3 = fs->make<TH1D>("hgz3","layer3, clu global z",600,-30.,30.);
+
+    // dets hit per event
+    hDetsMap1 = fs->make<TH2F>("hDetsMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    hDetsMap1->SetOption("colz");
+    hDetsMap2 = fs->make<TH2F>("hDetsMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    hDetsMap2->SetOption("colz");
+    hDetsMap3 = fs->make<TH2F>("hDetsMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    hDetsMap3->SetOption("colz");
+    // clus per det
+    hDetMap1 = fs->make<TH2F>("hDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    hDetMap1->SetOption("colz");
+    hDetMap2 = fs->make<TH2F>("hDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    hDetMap2->SetOption("colz");
+    hDetMap3 = fs->make<TH2F>("hDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    hDetMap3->SetOption("colz");
+    // pix per det
+    hpDetMap1 = fs->make<TH2F>("hpDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    hpDetMap1->SetOption("colz");
+    hpDetMap2 = fs->make<TH2F>("hpDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    hpDetMap2->SetOption("colz");
+    hpDetMap3 = fs->make<TH2F>("hpDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    hpDetMap3->SetOption("colz");
+
+    hsizeDetMap1 = fs->make<TH2F>("hsizeDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    hsizeDetMap1->SetOption("colz");
+    hsizeDetMap2 = fs->make<TH2F>("hsizeDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    hsizeDetMap2->SetOption("colz");
+    hsizeDetMap3 = fs->make<TH2F>("hsizeDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    hsizeDetMap3->SetOption("colz");
+
+    //hsizeXDetMap1 = fs->make<TH2F>("hsizeXDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    //hsizeXDetMap1->SetOption("colz");
+    //hsizeXDetMap2 = fs->make<TH2F>("hsizeXDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    //hsizeXDetMap2->SetOption("colz");
+    //hsizeXDetMap3 = fs->make<TH2F>("hsizeXDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    //hsizeXDetMap3->SetOption("colz");
+
+    //hsizeYDetMap1 = fs->make<TH2F>("hsizeYDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    //hsizeYDetMap1->SetOption("colz");
+    //hsizeYDetMap2 = fs->make<TH2F>("hsizeYDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    //hsizeYDetMap2->SetOption("colz");
+    //hsizeYDetMap3 = fs->make<TH2F>("hsizeYDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    //hsizeYDetMap3->SetOption("colz");
+
   
-  hprows1 = fs->make<TH1D>( "hprows1", "Layer 1 pix rows", 200,-0.5,199.5);
-  hprows2 = fs->make<TH1D>( "hprows2", "Layer 2 pix rows", 200,-0.5,199.5);
-  hprows3 = fs->make<TH1D>( "hprows3", "layer 3 pix rows", 200,-0.5,199.5);
-
-
-
-  sizeH=1000;
-  highH = 999.5; // charge limit in kelec
-  hsize1 = fs->make<TH1D>( "hsize1", "layer 1 clu size",sizeH,-0.5,highH);
-  hsize2 = fs->make<TH1D>( "hsize2", "layer 2 clu size",sizeH,-0.5,highH);
-  hsize3 = fs->make<TH1D>( "hsize3", "layer 3 clu size",sizeH,-0.5,highH);
-  //hsizen = fs->make<TH1D>( "hsizen", "clu size",sizeH,-0.5,highH);
-  hsizen1 = fs->make<TH1D>( "hsizen1", "clu size",sizeH,-0.5,highH);
-  hsizen2 = fs->make<TH1D>( "hsizen2", "clu size",sizeH,-0.5,highH);
-
-  hsizex1 = fs->make<TH1D>( "hsizex1", "lay1 clu size in x",
-		      20,-0.5,19.5);
-  hsizex2 = fs->make<TH1D>( "hsizex2", "lay2 clu size in x",
-		      20,-0.5,19.5);
-  hsizex3 = fs->make<TH1D>( "hsizex3", "lay3 clu size in x",
-		      20,-0.5,19.5);
-  //hsizexn = fs->make<TH1D>( "hsizexn", "clu size in x",
-  //	      20,-0.5,19.5);
-  hsizexn1 = fs->make<TH1D>( "hsizexn1", "clu size in x",
-		      20,-0.5,19.5);
-  hsizexn2 = fs->make<TH1D>( "hsizexn2", "clu size in x",
-		      20,-0.5,19.5);
-  hsizey1 = fs->make<TH1D>( "hsizey1", "lay1 clu size in y",
-		      30,-0.5,29.5);
-  hsizey2 = fs->make<TH1D>( "hsizey2", "lay2 clu size in y",
-		      30,-0.5,29.5);
-  hsizey3 = fs->make<TH1D>( "hsizey3", "lay3 clu size in y",
-		      30,-0.5,29.5);
-  //hsizeyn = fs->make<TH1D>( "hsizeyn", "lay3 clu size in y",
-  //	      30,-0.5,29.5);
-  hsizeyn1 = fs->make<TH1D>( "hsizeyn1", "lay3 clu size in y",
-		      30,-0.5,29.5);
-  hsizeyn2 = fs->make<TH1D>( "hsizeyn2", "lay3 clu size in y",
-		      30,-0.5,29.5);
-
-  hpixDiskR1 = fs->make<TH1D>("hpixDiskR1","pix vs. r, disk 1",200,0.,20.);
-  hpixDiskR2 = fs->make<TH1D>("hpixDiskR2","pix vs. r, disk 2",200,0.,20.);
+    hpixDetMap1 = fs->make<TH2F>( "hpixDetMap1", "pix det layer 1",
+  		      416,0.,416.,160,0.,160.);
+    hpixDetMap2 = fs->make<TH2F>( "hpixDetMap2", "pix det layer 2",
+  		      416,0.,416.,160,0.,160.);
+    hpixDetMap3 = fs->make<TH2F>( "hpixDetMap3", "pix det layer 3",
+  		      416,0.,416.,160,0.,160.);
+
+    hcluDetMap1 = fs->make<TH2F>( "hcluDetMap1", "clu det layer 1",
+  				416,0.,416.,160,0.,160.);
+    hcluDetMap2 = fs->make<TH2F>( "hcluDetMap2", "clu det layer 1",
+  				416,0.,416.,160,0.,160.);
+    hcluDetMap3 = fs->make<TH2F>( "hcluDetMap3", "clu det layer 1",
+  				416,0.,416.,160,0.,160.);
+
+
+    // Special test hitos for inefficiency effects
+    hpixDetMap10 = fs->make<TH2F>( "hpixDetMap10", "pix det layer 1",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap20 = fs->make<TH2F>( "hpixDetMap20", "pix det layer 2",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap30 = fs->make<TH2F>( "hpixDetMap30", "pix det layer 3",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap11 = fs->make<TH2F>( "hpixDetMap11", "pix det layer 1",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap12 = fs->make<TH2F>( "hpixDetMap12", "pix det layer 1",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap13 = fs->make<TH2F>( "hpixDetMap13", "pix det layer 1",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap14 = fs->make<TH2F>( "hpixDetMap14", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap15 = fs->make<TH2F>( "hpixDetMap15", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap16 = fs->make<TH2F>( "hpixDetMap16", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap17 = fs->make<TH2F>( "hpixDetMap17", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap18 = fs->make<TH2F>( "hpixDetMap18", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap19 = fs->make<TH2F>( "hpixDetMap19", "pix det layer 1",
+  				  416,0.,416.,160,0.,160.);
+
+    hpixDetMap21 = fs->make<TH2F>( "hpixDetMap21", "pix det layer 2",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap22 = fs->make<TH2F>( "hpixDetMap22", "pix det layer 2",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap23 = fs->make<TH2F>( "hpixDetMap23", "pix det layer 2",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap24 = fs->make<TH2F>( "hpixDetMap24", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap25 = fs->make<TH2F>( "hpixDetMap25", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap26 = fs->make<TH2F>( "hpixDetMap26", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap27 = fs->make<TH2F>( "hpixDetMap27", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap28 = fs->make<TH2F>( "hpixDetMap28", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap29 = fs->make<TH2F>( "hpixDetMap29", "pix det layer 2",
+  				  416,0.,416.,160,0.,160.);
+
+    hpixDetMap31 = fs->make<TH2F>( "hpixDetMap31", "pix det layer 3",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap32 = fs->make<TH2F>( "hpixDetMap32", "pix det layer 3",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap33 = fs->make<TH2F>( "hpixDetMap33", "pix det layer 3",
+  				 416,0.,416.,160,0.,160.);
+    hpixDetMap34 = fs->make<TH2F>( "hpixDetMap34", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap35 = fs->make<TH2F>( "hpixDetMap35", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap36 = fs->make<TH2F>( "hpixDetMap36", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap37 = fs->make<TH2F>( "hpixDetMap37", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap38 = fs->make<TH2F>( "hpixDetMap38", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+    hpixDetMap39 = fs->make<TH2F>( "hpixDetMap39", "pix det layer 3",
+  				  416,0.,416.,160,0.,160.);
+
+    //h2d1 = fs->make<TH2F>( "h2d1", "2d 1",200,0.,4000.,50,0., 200.);
+    //h2d2 = fs->make<TH2F>( "h2d2", "2d 2", 55,0.,1.1, 150,0., 150.);
+    //h2d3 = fs->make<TH2F>( "h2d3", "2d 3", 55,0.,1.1, 300,0.,4000.);
+
+
+     hclumult1 = fs->make<TProfile>("hclumult1","cluster size layer 1",56,-28.,28.,0.0,100.);
+     hclumult2 = fs->make<TProfile>("hclumult2","cluster size layer 2",56,-28.,28.,0.0,100.);
+     hclumult3 = fs->make<TProfile>("hclumult3","cluster size layer 3",56,-28.,28.,0.0,100.);
+
+     hclumultx1 = fs->make<TProfile>("hclumultx1","cluster x-size layer 1",56,-28.,28.,0.0,100.);
+     hclumultx2 = fs->make<TProfile>("hclumultx2","cluster x-size layer 2",56,-28.,28.,0.0,100.);
+     hclumultx3 = fs->make<TProfile>("hclumultx3","cluster x-size layer 3",56,-28.,28.,0.0,100.);
+
+     hclumulty1 = fs->make<TProfile>("hclumulty1","cluster y-size layer 1",56,-28.,28.,0.0,100.);
+     hclumulty2 = fs->make<TProfile>("hclumulty2","cluster y-size layer 2",56,-28.,28.,0.0,100.);
+     hclumulty3 = fs->make<TProfile>("hclumulty3","cluster y-size layer 3",56,-28.,28.,0.0,100.);
+
+     hcluchar1 = fs->make<TProfile>("hcluchar1","cluster char layer 1",56,-28.,28.,0.0,1000.);
+     hcluchar2 = fs->make<TProfile>("hcluchar2","cluster char layer 2",56,-28.,28.,0.0,1000.);
+     hcluchar3 = fs->make<TProfile>("hcluchar3","cluster char layer 3",56,-28.,28.,0.0,1000.);
+
+     hpixchar1 = fs->make<TProfile>("hpixchar1","pix char layer 1",56,-28.,28.,0.0,1000.);
+     hpixchar2 = fs->make<TProfile>("hpixchar2","pix char layer 2",56,-28.,28.,0.0,1000.);
+     hpixchar3 = fs->make<TProfile>("hpixchar3","pix char layer 3",56,-28.,28.,0.0,1000.);
+
+
+     sizeH = 1000;
+     highH = 3000.; 
+     if(!lumiSummary.isOpen()) {  // else in the summary file, without the ls range limit
+       hclusls = fs->make<TProfile>("hclusls","clus vs ls",sizeH,0.,highH,0.0,30000.);
+       hpixls  = fs->make<TProfile>("hpixls", "pix vs ls ",sizeH,0.,highH,0.0,100000.);
+
+       hcluslsn = fs->make<TProfile>("hcluslsn","clus/lumi",sizeH,0.,highH,0.0,30000.);
+       hpixlsn  = fs->make<TProfile>("hpixlsn", "pix/lumi ",sizeH,0.,highH,0.0,100000.);
+     }
+
+     hcharCluls = fs->make<TProfile>("hcharCluls","clu char vs ls",sizeH,0.,highH,0.0,100.);
+     hcharPixls = fs->make<TProfile>("hcharPixls","pix char vs ls",sizeH,0.,highH,0.0,100.);
+     hsizeCluls = fs->make<TProfile>("hsizeCluls","clu size vs ls",sizeH,0.,highH,0.0,1000.);
+     hsizeXCluls= fs->make<TProfile>("hsizeXCluls","clu size-x vs ls",sizeH,0.,highH,0.0,100.);
+
+
+     sizeH = 100;
+     highH =  10.; 
+     hpixbl   = fs->make<TProfile>("hpixbl",  "pixb vs lumi ", sizeH,0.,highH,0.0,100000.);
+     hclusbl  = fs->make<TProfile>("hclusbl", "clusb vs lumi", sizeH,0.,highH,0.0,30000.);
+     hpixb1l  = fs->make<TProfile>("hpixb1l", "pixb1 vs lumi", sizeH,0.,highH,0.0,100000.);
+     hclusb1l = fs->make<TProfile>("hclusb1l","clusb1 vs lumi",sizeH,0.,highH,0.0,30000.);
+     hpixb2l  = fs->make<TProfile>("hpixb2l", "pixb2 vs lumi ",sizeH,0.,highH,0.0,100000.);
+     hclusb2l = fs->make<TProfile>("hclusb2l","clusb2 vs lumi",sizeH,0.,highH,0.0,30000.);
+     hpixb3l  = fs->make<TProfile>("hpixb3l", "pixb3 vs lumi ",sizeH,0.,highH,0.0,100000.);
+     hclusb3l = fs->make<TProfile>("hclusb3l","clusb3 vs lumi",sizeH,0.,highH,0.0,30000.);
+     hpixfl   = fs->make<TProfile>("hpixfl",  "pixf vs lumi ", sizeH,0.,highH,0.0,100000.);
+     hclusfl  = fs->make<TProfile>("hclusfl", "clusf vs lumi", sizeH,0.,highH,0.0,30000.);
+     hpixfml  = fs->make<TProfile>("hpixfml", "pixfm vs lumi ",sizeH,0.,highH,0.0,100000.);
+     hclusfml = fs->make<TProfile>("hclusfml","clusfm vs lumi",sizeH,0.,highH,0.0,30000.);
+     hpixfpl  = fs->make<TProfile>("hpixfpl", "pixfp vs lumi ",sizeH,0.,highH,0.0,100000.);
+     hclusfpl = fs->make<TProfile>("hclusfpl","clusfp vs lumi",sizeH,0.,highH,0.0,30000.);
+
+     sizeH = 1000;
+     highH = 3000.; 
+     //hpixpvlsn  = fs->make<TProfile>("hpixpvlsn","pix/pv vs ls",sizeH,0.,highH,0.0,100000.);
+     //hclupvlsn  = fs->make<TProfile>("hclupvlsn","clu/pv vs ls",sizeH,0.,highH,0.0,30000.);
+
+     hpixpv  = fs->make<TProfile>("hpixpv","pix vs pv",1000,0.,20000,0.0,1000.);
+     hclupv  = fs->make<TProfile>("hclupv","clu vs pv",1000,0.,10000,0.0,1000.);
+
+     //hbeam1  = fs->make<TProfile>("hbeam1", "beam1 vs ls ",sizeH,0.,highH,0.0,1000.);
+     //hbeam2  = fs->make<TProfile>("hbeam2", "beam2 vs ls ",sizeH,0.,highH,0.0,1000.);
+
+     hpixbx  = fs->make<TProfile>("hpixbx", "pix vs bx ",4000,-0.5,3999.5,0.0,1000000.);
+     hclubx  = fs->make<TProfile>("hclubx", "clu vs bx ",4000,-0.5,3999.5,0.0,1000000.);
+     hpvbx   = fs->make<TProfile>("hpvbx",  "pv vs bx ", 4000,-0.5,3999.5,0.0,1000000.);
+     hpixbxn = fs->make<TProfile>("hpixbxn","pix/lumi vs bx ",4000,-0.5,3999.5,0.0,1000000.);
+     hclubxn = fs->make<TProfile>("hclubxn","clu/lumi vs bx ",4000,-0.5,3999.5,0.0,1000000.);
+     hpvbxn  = fs->make<TProfile>("hpvbxn", "pv/lumi vs bx ", 4000,-0.5,3999.5,0.0,1000000.);
+
+     hcharClubx  = fs->make<TProfile>("hcharClubx", "clu charge vs bx ",4000,-0.5,3999.5,0.0,100.);
+     hcharPixbx  = fs->make<TProfile>("hcharPixbx", "pix charge vs bx ",4000,-0.5,3999.5,0.0,100.);
+     hsizeClubx  = fs->make<TProfile>("hsizeClubx", "clu size vs bx ",4000,-0.5,3999.5,0.0,1000.);
+     hsizeYClubx = fs->make<TProfile>("hsizeYClubx", "clu size-y vs bx ",4000,-0.5,3999.5,0.0,1000.);
+
+     hcluLumi = fs->make<TProfile>("hcluLumi", "clus vs inst lumi",100,0.0,10.,0.0,100000.);
+     hpixLumi = fs->make<TProfile>("hpixLumi", "pixs vs inst lumi",100,0.0,10.,0.0,100000.);
+     hcharCluLumi = fs->make<TProfile>("hcharCluLumi", "clu char vs inst lumi",100,0.0,10.,0.0,100.);
+     hcharPixLumi = fs->make<TProfile>("hcharPixLumi", "pix char vs inst lumi",100,0.0,10.,0.0,100.);
+     hsizeCluLumi = fs->make<TProfile>("hsizeCluLumi", "clu size vs inst lumi",100,0.0,10.,0.0,100.);
+     hsizeXCluLumi = fs->make<TProfile>("hsizeXCluLumi", "clu size-x vs inst lumi",100,0.0,10.,0.0,100.);
+     hsizeYCluLumi = fs->make<TProfile>("hsizeYCluLumi", "clu size-y vs inst lumi",100,0.0,10.,0.0,100.);
+
+     //hclus13ls  = fs->make<TProfile>("hclus13ls", "clus1/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
+     //hclus23ls  = fs->make<TProfile>("hclus23ls", "clus2/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
+     //hclus12ls  = fs->make<TProfile>("hclus12ls", "clus1/clus2 vs ls", sizeH,0.,highH,0.0,30000.);
+     //hclusf3ls  = fs->make<TProfile>("hclusf3ls", "clusf/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
 
+//    hclusbx1lsn  = fs->make<TProfile>("hclusbx1lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx2lsn  = fs->make<TProfile>("hclusbx2lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx3lsn  = fs->make<TProfile>("hclusbx3lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx4lsn  = fs->make<TProfile>("hclusbx4lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx5lsn  = fs->make<TProfile>("hclusbx5lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx6lsn  = fs->make<TProfile>("hclusbx6lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx7lsn  = fs->make<TProfile>("hclusbx7lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx8lsn  = fs->make<TProfile>("hclusbx8lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx9lsn  = fs->make<TProfile>("hclusbx9lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+
+//    hclusbx11lsn  = fs->make<TProfile>("hclusbx11lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx12lsn  = fs->make<TProfile>("hclusbx12lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx13lsn  = fs->make<TProfile>("hclusbx13lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx14lsn  = fs->make<TProfile>("hclusbx14lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx15lsn  = fs->make<TProfile>("hclusbx15lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx16lsn  = fs->make<TProfile>("hclusbx16lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx17lsn  = fs->make<TProfile>("hclusbx17lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx18lsn  = fs->make<TProfile>("hclusbx18lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+//    hclusbx19lsn  = fs->make<TProfile>("hclusbx19lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+
+     //hclusls2 = fs->make<TH2F>("hclusls2","clus bs ls", 300,0.,900.,100,0.,5000.);
+     //hpixls2  = fs->make<TH2F>("hpixls2", "pix per ls ",300,0.,900.,100,0.,20000.);
+     //h2pixpv  = fs->make<TH2F>("h2pixpv","pix vs pv",100,0.,40000, 25,0.0,50.);
+     //h2clupv  = fs->make<TH2F>("h2clupv","clu vs pv",100,0.,20000, 25,0.0,50.);
+
+     //hclusls1 = fs->make<TH1D>("hclusls1","av clus/lumi",200,0.,2000.);
+     //hpixls1  = fs->make<TH1D>("hpixls1", "av pix/lumi ",500,0.,5000.);
+
+     //hintg  = fs->make<TH1D>("hintg", "intg lumi",100,0.0,1000.);
+  } // histos
+
+  // event histos
+  hdets = fs->make<TH1D>( "hdets","Dets per event",2000, -0.5, 1999.5);
   hevent = fs->make<TH1D>("hevent","event",100,0,10000000.);
   //horbit = fs->make<TH1D>("horbit","orbit",100, 0,100000000.);
 
-  hlumi1  = fs->make<TH1D>("hlumi1", "lumi", 2000,0,2000.);
   hlumi0  = fs->make<TH1D>("hlumi0", "lumi", 2000,0,2000.);
   hlumi   = fs->make<TH1D>("hlumi", "lumi",   2000,0,2000.);
   hlumi10 = fs->make<TH1D>("hlumi10", "lumi10",   2000,0,2000.);
@@ -1179,312 +941,72 @@ void TestClusters::beginJob() {
   hbx0    = fs->make<TH1D>("hbx0",   "bx",   4000,0,4000.);  
   hbx    = fs->make<TH1D>("hbx",   "bx",     4000,0,4000.);  
 
-  hl1a    = fs->make<TH1D>("hl1a",   "l1a",   128,-0.5,127.5);
-  hl1t    = fs->make<TH1D>("hl1t",   "l1t",   128,-0.5,127.5);
-  hltt    = fs->make<TH1D>("hltt",   "ltt",   128,-0.5,127.5);
-  hl1t1 = fs->make<TH1D>("hl1t1","l1t1",128,-0.5,127.5);
-  hl1a1 = fs->make<TH1D>("hl1a1","l1a1",128,-0.5,127.5);
-
-  //hmbits1 = fs->make<TH1D>("hmbits1","hmbits1",50,-0.5,49.5);
-  //hmbits2 = fs->make<TH1D>("hmbits2","hmbits2",50,-0.5,49.5);
-  //hmbits3 = fs->make<TH1D>("hmbits3","hmbits3",50,-0.5,49.5);
-
-  hlt1 = fs->make<TH1D>("hlt1","hlt1",256,-0.5,255.5);
-  hlt2 = fs->make<TH1D>("hlt2","hlt2",256,-0.5,255.5);
-  hlt3 = fs->make<TH1D>("hlt3","hlt3",256,-0.5,255.5);
-
-
-  hgz1 = fs->make<TH1D>("hgz1","layer1, clu global z",600,-30.,30.);
-  hgz2 = fs->make<TH1D>("hgz2","layer2, clu global z",600,-30.,30.);
-  hgz3 = fs->make<TH1D>("hgz3","layer3, clu global z",600,-30.,30.);
-
-  // dets hit per event
-  hDetsMap1 = fs->make<TH2F>("hDetsMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  hDetsMap1->SetOption("colz");
-  hDetsMap2 = fs->make<TH2F>("hDetsMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  hDetsMap2->SetOption("colz");
-  hDetsMap3 = fs->make<TH2F>("hDetsMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  hDetsMap3->SetOption("colz");
-  // clus per det
-  hDetMap1 = fs->make<TH2F>("hDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  hDetMap1->SetOption("colz");
-  hDetMap2 = fs->make<TH2F>("hDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  hDetMap2->SetOption("colz");
-  hDetMap3 = fs->make<TH2F>("hDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  hDetMap3->SetOption("colz");
-  // pix per det
-  hpDetMap1 = fs->make<TH2F>("hpDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  hpDetMap1->SetOption("colz");
-  hpDetMap2 = fs->make<TH2F>("hpDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  hpDetMap2->SetOption("colz");
-  hpDetMap3 = fs->make<TH2F>("hpDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  hpDetMap3->SetOption("colz");
-
-  hsizeDetMap1 = fs->make<TH2F>("hsizeDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  hsizeDetMap1->SetOption("colz");
-  hsizeDetMap2 = fs->make<TH2F>("hsizeDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  hsizeDetMap2->SetOption("colz");
-  hsizeDetMap3 = fs->make<TH2F>("hsizeDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  hsizeDetMap3->SetOption("colz");
-
-  //hsizeXDetMap1 = fs->make<TH2F>("hsizeXDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  //hsizeXDetMap1->SetOption("colz");
-  //hsizeXDetMap2 = fs->make<TH2F>("hsizeXDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  //hsizeXDetMap2->SetOption("colz");
-  //hsizeXDetMap3 = fs->make<TH2F>("hsizeXDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  //hsizeXDetMap3->SetOption("colz");
-
-  //hsizeYDetMap1 = fs->make<TH2F>("hsizeYDetMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  //hsizeYDetMap1->SetOption("colz");
-  //hsizeYDetMap2 = fs->make<TH2F>("hsizeYDetMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  //hsizeYDetMap2->SetOption("colz");
-  //hsizeYDetMap3 = fs->make<TH2F>("hsizeYDetMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  //hsizeYDetMap3->SetOption("colz");
-
-  
-  hpixDetMap1 = fs->make<TH2F>( "hpixDetMap1", "pix det layer 1",
-		      416,0.,416.,160,0.,160.);
-  hpixDetMap2 = fs->make<TH2F>( "hpixDetMap2", "pix det layer 2",
-		      416,0.,416.,160,0.,160.);
-  hpixDetMap3 = fs->make<TH2F>( "hpixDetMap3", "pix det layer 3",
-		      416,0.,416.,160,0.,160.);
-
-  hcluDetMap1 = fs->make<TH2F>( "hcluDetMap1", "clu det layer 1",
-				416,0.,416.,160,0.,160.);
-  hcluDetMap2 = fs->make<TH2F>( "hcluDetMap2", "clu det layer 1",
-				416,0.,416.,160,0.,160.);
-  hcluDetMap3 = fs->make<TH2F>( "hcluDetMap3", "clu det layer 1",
-				416,0.,416.,160,0.,160.);
-
-
-  // Special test hitos for inefficiency effects
-  hpixDetMap10 = fs->make<TH2F>( "hpixDetMap10", "pix det layer 1",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap20 = fs->make<TH2F>( "hpixDetMap20", "pix det layer 2",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap30 = fs->make<TH2F>( "hpixDetMap30", "pix det layer 3",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap11 = fs->make<TH2F>( "hpixDetMap11", "pix det layer 1",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap12 = fs->make<TH2F>( "hpixDetMap12", "pix det layer 1",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap13 = fs->make<TH2F>( "hpixDetMap13", "pix det layer 1",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap14 = fs->make<TH2F>( "hpixDetMap14", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap15 = fs->make<TH2F>( "hpixDetMap15", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap16 = fs->make<TH2F>( "hpixDetMap16", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap17 = fs->make<TH2F>( "hpixDetMap17", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap18 = fs->make<TH2F>( "hpixDetMap18", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap19 = fs->make<TH2F>( "hpixDetMap19", "pix det layer 1",
-				  416,0.,416.,160,0.,160.);
-
-  hpixDetMap21 = fs->make<TH2F>( "hpixDetMap21", "pix det layer 2",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap22 = fs->make<TH2F>( "hpixDetMap22", "pix det layer 2",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap23 = fs->make<TH2F>( "hpixDetMap23", "pix det layer 2",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap24 = fs->make<TH2F>( "hpixDetMap24", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap25 = fs->make<TH2F>( "hpixDetMap25", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap26 = fs->make<TH2F>( "hpixDetMap26", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap27 = fs->make<TH2F>( "hpixDetMap27", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap28 = fs->make<TH2F>( "hpixDetMap28", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap29 = fs->make<TH2F>( "hpixDetMap29", "pix det layer 2",
-				  416,0.,416.,160,0.,160.);
-
-  hpixDetMap31 = fs->make<TH2F>( "hpixDetMap31", "pix det layer 3",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap32 = fs->make<TH2F>( "hpixDetMap32", "pix det layer 3",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap33 = fs->make<TH2F>( "hpixDetMap33", "pix det layer 3",
-				 416,0.,416.,160,0.,160.);
-  hpixDetMap34 = fs->make<TH2F>( "hpixDetMap34", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap35 = fs->make<TH2F>( "hpixDetMap35", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap36 = fs->make<TH2F>( "hpixDetMap36", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap37 = fs->make<TH2F>( "hpixDetMap37", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap38 = fs->make<TH2F>( "hpixDetMap38", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-  hpixDetMap39 = fs->make<TH2F>( "hpixDetMap39", "pix det layer 3",
-				  416,0.,416.,160,0.,160.);
-
-  //h2d1 = fs->make<TH2F>( "h2d1", "2d 1",200,0.,4000.,50,0., 200.);
-  //h2d2 = fs->make<TH2F>( "h2d2", "2d 2", 55,0.,1.1, 150,0., 150.);
-  //h2d3 = fs->make<TH2F>( "h2d3", "2d 3", 55,0.,1.1, 300,0.,4000.);
-
-
-   hclumult1 = fs->make<TProfile>("hclumult1","cluster size layer 1",56,-28.,28.,0.0,100.);
-   hclumult2 = fs->make<TProfile>("hclumult2","cluster size layer 2",56,-28.,28.,0.0,100.);
-   hclumult3 = fs->make<TProfile>("hclumult3","cluster size layer 3",56,-28.,28.,0.0,100.);
-
-   hclumultx1 = fs->make<TProfile>("hclumultx1","cluster x-size layer 1",56,-28.,28.,0.0,100.);
-   hclumultx2 = fs->make<TProfile>("hclumultx2","cluster x-size layer 2",56,-28.,28.,0.0,100.);
-   hclumultx3 = fs->make<TProfile>("hclumultx3","cluster x-size layer 3",56,-28.,28.,0.0,100.);
-
-   hclumulty1 = fs->make<TProfile>("hclumulty1","cluster y-size layer 1",56,-28.,28.,0.0,100.);
-   hclumulty2 = fs->make<TProfile>("hclumulty2","cluster y-size layer 2",56,-28.,28.,0.0,100.);
-   hclumulty3 = fs->make<TProfile>("hclumulty3","cluster y-size layer 3",56,-28.,28.,0.0,100.);
-
-   hcluchar1 = fs->make<TProfile>("hcluchar1","cluster char layer 1",56,-28.,28.,0.0,1000.);
-   hcluchar2 = fs->make<TProfile>("hcluchar2","cluster char layer 2",56,-28.,28.,0.0,1000.);
-   hcluchar3 = fs->make<TProfile>("hcluchar3","cluster char layer 3",56,-28.,28.,0.0,1000.);
-
-   hpixchar1 = fs->make<TProfile>("hpixchar1","pix char layer 1",56,-28.,28.,0.0,1000.);
-   hpixchar2 = fs->make<TProfile>("hpixchar2","pix char layer 2",56,-28.,28.,0.0,1000.);
-   hpixchar3 = fs->make<TProfile>("hpixchar3","pix char layer 3",56,-28.,28.,0.0,1000.);
-
-
-   sizeH = 1000;
-   highH = 3000.; 
-   hclusls = fs->make<TProfile>("hclusls","clus vs ls",sizeH,0.,highH,0.0,30000.);
-   hpixls  = fs->make<TProfile>("hpixls", "pix vs ls ",sizeH,0.,highH,0.0,100000.);
-
-   hcluslsn = fs->make<TProfile>("hcluslsn","clus/lumi",sizeH,0.,highH,0.0,30000.);
-   hpixlsn  = fs->make<TProfile>("hpixlsn", "pix/lumi ",sizeH,0.,highH,0.0,100000.);
-
-   hpvls = fs->make<TProfile>("hpvls","pvs vs ls",sizeH,0.,highH,0.0,10000.);
-   //hpvlsn = fs->make<TProfile>("hpvlsn","pvs/lumi vs ls",sizeH,0.,highH,0.0,1000.);
-
-   hcharCluls = fs->make<TProfile>("hcharCluls","clu char vs ls",sizeH,0.,highH,0.0,100.);
-   hcharPixls = fs->make<TProfile>("hcharPixls","pix char vs ls",sizeH,0.,highH,0.0,100.);
-   hsizeCluls = fs->make<TProfile>("hsizeCluls","clu size vs ls",sizeH,0.,highH,0.0,1000.);
-   hsizeXCluls= fs->make<TProfile>("hsizeXCluls","clu size-x vs ls",sizeH,0.,highH,0.0,100.);
-
-
-   sizeH = 100;
-   highH =  10.; 
-   hpixbl   = fs->make<TProfile>("hpixbl",  "pixb vs lumi ", sizeH,0.,highH,0.0,100000.);
-   hclusbl  = fs->make<TProfile>("hclusbl", "clusb vs lumi", sizeH,0.,highH,0.0,30000.);
-   hpixb1l  = fs->make<TProfile>("hpixb1l", "pixb1 vs lumi", sizeH,0.,highH,0.0,100000.);
-   hclusb1l = fs->make<TProfile>("hclusb1l","clusb1 vs lumi",sizeH,0.,highH,0.0,30000.);
-   hpixb2l  = fs->make<TProfile>("hpixb2l", "pixb2 vs lumi ",sizeH,0.,highH,0.0,100000.);
-   hclusb2l = fs->make<TProfile>("hclusb2l","clusb2 vs lumi",sizeH,0.,highH,0.0,30000.);
-   hpixb3l  = fs->make<TProfile>("hpixb3l", "pixb3 vs lumi ",sizeH,0.,highH,0.0,100000.);
-   hclusb3l = fs->make<TProfile>("hclusb3l","clusb3 vs lumi",sizeH,0.,highH,0.0,30000.);
-   hpixfl   = fs->make<TProfile>("hpixfl",  "pixf vs lumi ", sizeH,0.,highH,0.0,100000.);
-   hclusfl  = fs->make<TProfile>("hclusfl", "clusf vs lumi", sizeH,0.,highH,0.0,30000.);
-   hpixfml  = fs->make<TProfile>("hpixfml", "pixfm vs lumi ",sizeH,0.,highH,0.0,100000.);
-   hclusfml = fs->make<TProfile>("hclusfml","clusfm vs lumi",sizeH,0.,highH,0.0,30000.);
-   hpixfpl  = fs->make<TProfile>("hpixfpl", "pixfp vs lumi ",sizeH,0.,highH,0.0,100000.);
-   hclusfpl = fs->make<TProfile>("hclusfpl","clusfp vs lumi",sizeH,0.,highH,0.0,30000.);
-
-   sizeH = 1000;
-   highH = 3000.; 
-   //hpixpvlsn  = fs->make<TProfile>("hpixpvlsn","pix/pv vs ls",sizeH,0.,highH,0.0,100000.);
-   //hclupvlsn  = fs->make<TProfile>("hclupvlsn","clu/pv vs ls",sizeH,0.,highH,0.0,30000.);
-
-   hpixpv  = fs->make<TProfile>("hpixpv","pix vs pv",1000,0.,20000,0.0,1000.);
-   hclupv  = fs->make<TProfile>("hclupv","clu vs pv",1000,0.,10000,0.0,1000.);
-
-   //hintgls  = fs->make<TProfile>("hintgls", "intg lumi vs ls ",sizeH,0.,highH,0.0,10000.);
-   hinstls  = fs->make<TProfile>("hinstls", "inst bx lumi vs ls ",sizeH,0.,highH,0.0,1000.);
-   hinstlsbx= fs->make<TProfile>("hinstlsbx","inst bx lumi vs ls ",sizeH,0.,highH,0.0,1000.);
-   //hbeam1  = fs->make<TProfile>("hbeam1", "beam1 vs ls ",sizeH,0.,highH,0.0,1000.);
-   //hbeam2  = fs->make<TProfile>("hbeam2", "beam2 vs ls ",sizeH,0.,highH,0.0,1000.);
-
-   hpixbx  = fs->make<TProfile>("hpixbx", "pix vs bx ",4000,-0.5,3999.5,0.0,1000000.);
-   hclubx  = fs->make<TProfile>("hclubx", "clu vs bx ",4000,-0.5,3999.5,0.0,1000000.);
-   hpvbx   = fs->make<TProfile>("hpvbx",  "pv vs bx ", 4000,-0.5,3999.5,0.0,1000000.);
-   hpixbxn = fs->make<TProfile>("hpixbxn","pix/lumi vs bx ",4000,-0.5,3999.5,0.0,1000000.);
-   hclubxn = fs->make<TProfile>("hclubxn","clu/lumi vs bx ",4000,-0.5,3999.5,0.0,1000000.);
-   hpvbxn  = fs->make<TProfile>("hpvbxn", "pv/lumi vs bx ", 4000,-0.5,3999.5,0.0,1000000.);
-
-   hcharClubx  = fs->make<TProfile>("hcharClubx", "clu charge vs bx ",4000,-0.5,3999.5,0.0,100.);
-   hcharPixbx  = fs->make<TProfile>("hcharPixbx", "pix charge vs bx ",4000,-0.5,3999.5,0.0,100.);
-   hsizeClubx  = fs->make<TProfile>("hsizeClubx", "clu size vs bx ",4000,-0.5,3999.5,0.0,1000.);
-   hsizeYClubx = fs->make<TProfile>("hsizeYClubx", "clu size-y vs bx ",4000,-0.5,3999.5,0.0,1000.);
-
-   hinstbx = fs->make<TProfile>("hinstbx", "inst lumi vs bx ",4000,-0.5,3999.5,0.0,100.);
-
-   hcluLumi = fs->make<TProfile>("hcluLumi", "clus vs inst lumi",100,0.0,10.,0.0,100000.);
-   hpixLumi = fs->make<TProfile>("hpixLumi", "pixs vs inst lumi",100,0.0,10.,0.0,100000.);
-   hcharCluLumi = fs->make<TProfile>("hcharCluLumi", "clu char vs inst lumi",100,0.0,10.,0.0,100.);
-   hcharPixLumi = fs->make<TProfile>("hcharPixLumi", "pix char vs inst lumi",100,0.0,10.,0.0,100.);
-   hsizeCluLumi = fs->make<TProfile>("hsizeCluLumi", "clu size vs inst lumi",100,0.0,10.,0.0,100.);
-   hsizeXCluLumi = fs->make<TProfile>("hsizeXCluLumi", "clu size-x vs inst lumi",100,0.0,10.,0.0,100.);
-   hsizeYCluLumi = fs->make<TProfile>("hsizeYCluLumi", "clu size-y vs inst lumi",100,0.0,10.,0.0,100.);
-
-   //hclus13ls  = fs->make<TProfile>("hclus13ls", "clus1/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
-   //hclus23ls  = fs->make<TProfile>("hclus23ls", "clus2/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
-   //hclus12ls  = fs->make<TProfile>("hclus12ls", "clus1/clus2 vs ls", sizeH,0.,highH,0.0,30000.);
-   //hclusf3ls  = fs->make<TProfile>("hclusf3ls", "clusf/clus3 vs ls", sizeH,0.,highH,0.0,30000.);
-
-//    hclusbx1lsn  = fs->make<TProfile>("hclusbx1lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx2lsn  = fs->make<TProfile>("hclusbx2lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx3lsn  = fs->make<TProfile>("hclusbx3lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx4lsn  = fs->make<TProfile>("hclusbx4lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx5lsn  = fs->make<TProfile>("hclusbx5lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx6lsn  = fs->make<TProfile>("hclusbx6lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx7lsn  = fs->make<TProfile>("hclusbx7lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx8lsn  = fs->make<TProfile>("hclusbx8lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx9lsn  = fs->make<TProfile>("hclusbx9lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+  if(doL1) {
+    hl1a    = fs->make<TH1D>("hl1a",   "l1a",   128,-0.5,127.5);
+    hl1t    = fs->make<TH1D>("hl1t",   "l1t",   128,-0.5,127.5);
+    hltt    = fs->make<TH1D>("hltt",   "ltt",   128,-0.5,127.5);
+  }
+  if(doHLT) {
+    hlt1 = fs->make<TH1D>("hlt1","hlt1",256,-0.5,255.5);
+    hlt2 = fs->make<TH1D>("hlt2","hlt2",256,-0.5,255.5);
+  }
 
-//    hclusbx11lsn  = fs->make<TProfile>("hclusbx11lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx12lsn  = fs->make<TProfile>("hclusbx12lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx13lsn  = fs->make<TProfile>("hclusbx13lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx14lsn  = fs->make<TProfile>("hclusbx14lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx15lsn  = fs->make<TProfile>("hclusbx15lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx16lsn  = fs->make<TProfile>("hclusbx16lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx17lsn  = fs->make<TProfile>("hclusbx17lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx18lsn  = fs->make<TProfile>("hclusbx18lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
-//    hclusbx19lsn  = fs->make<TProfile>("hclusbx19lsn", "clus vs ls for bx", sizeH,0.,highH,0.0,30000.);
+  sizeH = 1000;
+  highH = 3000.; 
+  hpvls = fs->make<TProfile>("hpvls","pvs vs ls",sizeH,0.,highH,0.0,10000.);
+  //hpvlsn = fs->make<TProfile>("hpvlsn","pvs/lumi vs ls",sizeH,0.,highH,0.0,1000.);
+  hpvs   = fs->make<TH1D>("hpvs", "pvs",100,-0.5,99.5);
+
+  if(doLumi) {
+    //hintgls  = fs->make<TProfile>("hintgls", "intg lumi vs ls ",sizeH,0.,highH,0.0,10000.);
+    hinstls  = fs->make<TProfile>("hinstls", "inst bx lumi vs ls ",sizeH,0.,highH,0.0,1000.);
+    hinstlsbx= fs->make<TProfile>("hinstlsbx","inst bx lumi vs ls ",sizeH,0.,highH,0.0,1000.);
+    hinstbx = fs->make<TProfile>("hinstbx", "inst lumi vs bx ",4000,-0.5,3999.5,0.0,100.);
+    hinst  = fs->make<TH1D>("hinst", "inst lumi",100,0.0,10.);
+  }
 
-   //hclusls2 = fs->make<TH2F>("hclusls2","clus bs ls", 300,0.,900.,100,0.,5000.);
-   //hpixls2  = fs->make<TH2F>("hpixls2", "pix per ls ",300,0.,900.,100,0.,20000.);
-   //h2pixpv  = fs->make<TH2F>("h2pixpv","pix vs pv",100,0.,40000, 25,0.0,50.);
-   //h2clupv  = fs->make<TH2F>("h2clupv","clu vs pv",100,0.,20000, 25,0.0,50.);
-
-   //hclusls1 = fs->make<TH1D>("hclusls1","av clus/lumi",200,0.,2000.);
-   //hpixls1  = fs->make<TH1D>("hpixls1", "av pix/lumi ",500,0.,5000.);
-
-   //hintg  = fs->make<TH1D>("hintg", "intg lumi",100,0.0,1000.);
-   hinst  = fs->make<TH1D>("hinst", "inst lumi",100,0.0,10.);
-   hpvs   = fs->make<TH1D>("hpvs", "pvs",100,-0.5,99.5);
-
-#ifdef ROC_EFF
-  // dets with bad rocs
-  hbadMap1 = fs->make<TH2F>("hbadMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
-  hbadMap1->SetOption("colz");
-  hbadMap2 = fs->make<TH2F>("hbadMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
-  hbadMap2->SetOption("colz");
-  hbadMap3 = fs->make<TH2F>("hbadMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
-  hbadMap3->SetOption("colz");
-
-  hrocHits1ls = fs->make<TH2F>("hrocHits1ls"," ",1000,0.,3000.,10,0.,10.);
-  hrocHits1ls->SetOption("colz");
-  hrocHits2ls = fs->make<TH2F>("hrocHits2ls"," ",1000,0.,3000.,10,0.,10.);
-  hrocHits2ls->SetOption("colz");
-  hrocHits3ls = fs->make<TH2F>("hrocHits3ls"," ",1000,0.,3000.,10,0.,10.);
-  hrocHits3ls->SetOption("colz");
-
-  hcountInRoc1 = fs->make<TH1D>("hcountInRoc1","roc 1 count",10000,-0.5,999999.5);
-  hcountInRoc2 = fs->make<TH1D>("hcountInRoc2","roc 2 count",10000,-0.5,999999.5);
-  hcountInRoc3 = fs->make<TH1D>("hcountInRoc3","roc 3 count",10000,-0.5,999999.5);
-  hcountInRoc12 = fs->make<TH1D>("hcountInRoc12","roc 1 count norm",500,-0.5,4.5);
-  hcountInRoc22 = fs->make<TH1D>("hcountInRoc22","roc 2 count norm",500,-0.5,4.5);
-  hcountInRoc32 = fs->make<TH1D>("hcountInRoc32","roc 3 count norm",500,-0.5,4.5);
-
-//   hmoduleHits1ls = fs->make<TH2F>("hmoduleHits1ls"," ",3000,0.,3000.,3,0.,3.);
-//   hmoduleHits1ls->SetOption("colz");
-//   hmoduleHits2ls = fs->make<TH2F>("hmoduleHits2ls"," ",3000,0.,3000.,3,0.,3.);
-//   hmoduleHits2ls->SetOption("colz");
-//   hmoduleHits3ls = fs->make<TH2F>("hmoduleHits3ls"," ",3000,0.,3000.,3,0.,3.);
-//   hmoduleHits3ls->SetOption("colz");
-
-#endif // ROC_EFF
+  // booked in the order of the channel enum 
+  TH1 * bxHistos[] = {hbx,hbx0,hbx1,hbx2,hbx3,hbx4,hbx5,hbx6,hbx7,hbx8,hbx9,hbx10,hpixbx,hclubx};
+  for(unsigned int i=0;i<sizeof(bxHistos)/sizeof(bxHistos[0]);++i) {
+    if(bxHistos[i]==0) cout<<" bx histo "<<i<<" not booked, its entries are dropped"<<endl;
+    bxAccumulator.book(bxHistos[i]);
+  }
+  if(hcharClubx==0) cout<<" hcharClubx not booked, its entries are dropped"<<endl;
+  bxAccumulator.book(hcharClubx,3);  // one slot per layer
+
+  if(doRocEff) {
+    // dets with bad rocs
+    hbadMap1 = fs->make<TH2F>("hbadMap1"," ",9,-4.5,4.5,21,-10.5,10.5);
+    hbadMap1->SetOption("colz");
+    hbadMap2 = fs->make<TH2F>("hbadMap2"," ",9,-4.5,4.5,33,-16.5,16.5);
+    hbadMap2->SetOption("colz");
+    hbadMap3 = fs->make<TH2F>("hbadMap3"," ",9,-4.5,4.5,45,-22.5,22.5);
+    hbadMap3->SetOption("colz");
+
+    hrocHits1ls = fs->make<TH2F>("hrocHits1ls"," ",1000,0.,3000.,10,0.,10.);
+    hrocHits1ls->SetOption("colz");
+    hrocHits2ls = fs->make<TH2F>("hrocHits2ls"," ",1000,0.,3000.,10,0.,10.);
+    hrocHits2ls->SetOption("colz");
+    hrocHits3ls = fs->make<TH2F>("hrocHits3ls"," ",1000,0.,3000.,10,0.,10.);
+    hrocHits3ls->SetOption("colz");
+
+    hcountInRoc1 = fs->make<TH1D>("hcountInRoc1","roc 1 count",10000,-0.5,999999.5);
+    hcountInRoc2 = fs->make<TH1D>("hcountInRoc2","roc 2 count",10000,-0.5,999999.5);
+    hcountInRoc3 = fs->make<TH1D>("hcountInRoc3","roc 3 count",10000,-0.5,999999.5);
+    hcountInRoc12 = fs->make<TH1D>("hcountInRoc12","roc 1 count norm",500,-0.5,4.5);
+    hcountInRoc22 = fs->make<TH1D>("hcountInRoc22","roc 2 count norm",500,-0.5,4.5);
+    hcountInRoc32 = fs->make<TH1D>("hcountInRoc32","roc 3 count norm",500,-0.5,4.5);
+    hcountInRoc4 = fs->make<TH1D>("hcountInRoc4","roc fpix count",10000,-0.5,999999.5);
+    hcountInRoc42 = fs->make<TH1D>("hcountInRoc42","roc fpix count norm",500,-0.5,4.5);
+
+  //   hmoduleHits1ls = fs->make<TH2F>("hmoduleHits1ls"," ",3000,0.,3000.,3,0.,3.);
+  //   hmoduleHits1ls->SetOption("colz");
+  //   hmoduleHits2ls = fs->make<TH2F>("hmoduleHits2ls"," ",3000,0.,3000.,3,0.,3.);
+  //   hmoduleHits2ls->SetOption("colz");
+  //   hmoduleHits3ls = fs->make<TH2F>("hmoduleHits3ls"," ",3000,0.,3000.,3,0.,3.);
+  //   hmoduleHits3ls->SetOption("colz");
+
+  } // ROC_EFF
 
   countEvents=0;
   countAllEvents=0;
@@ -1494,21 +1016,131 @@ void TestClusters::beginJob() {
   //for(int ilayer = 0; ilayer<3; ++ilayer) 
   //for(int id=0;id<10;++id) {rocHits[ilayer][id]=0.; moduleHits[ilayer][id]=0.;}
 
-#ifdef ROC_EFF
-  // Analyze single pixel efficiency
-  pixEff = new rocEfficiency();
-#endif
 
-#ifdef BX
-  getbx = new getBX();
-#endif
+  if(doBX) {
+    // the schemes of the file first, the built-in one for the other runs
+    bunchPattern.setDefault( bunchPattern.addScheme(-1,1,0,defaultLimit,2,
+       std::vector<PixelBunchPattern::Train>(defaultTrains,defaultTrains+sizeof(defaultTrains)/sizeof(defaultTrains[0]))) );
+    string bunchFile = conf_.getUntrackedParameter<string>("BunchPatternFile","");
+    if(bunchFile!="" && !bunchPattern.load(bunchFile)) 
+      cout<<" bunch patterns of "<<bunchFile<<" not used, only the default one"<<endl;
+  }
 
   lumiCorrector = new LumiCorrector();
 
 
+}
+// ------------ analysis blocks of the job, were the HISTOS, L1, ... defines  ------------
+void TestClusters::selectFeatures() {
+  const struct { const char * name; bool TestClusters::* flag; bool on; } features[] = {
+    {"histos",   &TestClusters::doHistos,   true },  // histos per pixel, cluster and module
+    {"l1",       &TestClusters::doL1,       true },  // L1 bits and bptx selection
+    {"hlt",      &TestClusters::doHLT,      false},  // HLT paths
+    {"heavyIon", &TestClusters::doHeavyIon, false},  // occupancy histo ranges for HI
+    {"rocEff",   &TestClusters::doRocEff,   true },  // hits per roc, dead and inefficient rocs
+    {"lumi",     &TestClusters::doLumi,     true },  // inst. lumi from the lumi producer
+    {"bx",       &TestClusters::doBX,       true }   // bunch type from the bunch pattern
+  };
+  const unsigned int n = sizeof(features)/sizeof(features[0]);
+
+  vector<string> defaults;
+  for(unsigned int i=0;i<n;++i) if(features[i].on) defaults.push_back(features[i].name);
+  vector<string> selected = conf_.getUntrackedParameter<vector<string> >("Features",defaults);
+
+  for(unsigned int i=0;i<n;++i) this->*features[i].flag = false;
+  for(unsigned int k=0;k<selected.size();++k) {
+    unsigned int i=0;
+    while(i<n && selected[k]!=features[i].name) ++i;
+    if(i<n) this->*features[i].flag = true;
+    else cout<<" unknown feature "<<selected[k]<<", ignored"<<endl;
+  }
+
+  cout<<" features:";
+  for(unsigned int i=0;i<n;++i) if(this->*features[i].flag) cout<<" "<<features[i].name;
+  cout<<endl;
+}
+// ------------ method called at the begining of each lumi section  ------------
+void TestClusters::beginLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const& es) {
+  // the lumi is constant in the lumi section, correct it once for all its events
+  lsLumiAv = 0.;
+  lsLumiBx.assign(PixelBunchPattern::NumberOfBx, 0.);
+  if(!doLumi) return;
+
+  edm::Handle<LumiSummary> summary;
+  edm::Handle<LumiDetails> ld;
+  lumi.getByLabel("lumiProducer", summary);
+  lumi.getByLabel("lumiProducer", ld);
+
+  //edm::Handle<edm::ConditionsInLumiBlock> cond;
+  //lumi.getByLabel("conditionsInEdm", cond);
+  // This will only work when running on RECO until (if) they fix it in the FW
+  // When running on RAW and reconstructing, the LumiSummary will not appear
+  // before reaching endLuminosityBlock(). Therefore, it is not
+  // possible to get this info for the events
+  if (!summary.isValid()) {
+    //std::cout << "** ERROR: lumi section does not get lumi info\n";
+    return;
+  }
+
+  //intlumi =(summary->intgRecLumi())/1000.; // integrated lumi per LS in -pb
+  //instlumi=(summary->avgInsDelLumi())/1000.; //ave. inst lumi per LS in -pb
+  float tmp0 =(summary->avgInsDelLumi()); //ave. inst lumi per LS in -nb
+  //beamint1=(cond->totalIntensityBeam1)/1000;
+  //beamint2=(cond->totalIntensityBeam2)/1000;
+  const int nbx=1331;  // for 1380 fills
+  float corr = lumiCorrector->TotalNormOcc1( (tmp0/1000.),nbx);
+  //float tmp2 = lumiCorrector->TotalNormOcc2(tmp0,nbx);
+  //float tmp3 = lumiCorrector->TotalNormET(tmp0,nbx);
+  float tmp1 = tmp0 * corr;
+  //lsLumiAv = tmp1/1000000.;  // in 10^33
+  float tmp2 = tmp1/float(nbx)/1000.;  // per bx
+  lsLumiAv = tmp2;  // use per bx lumi
+
+  if( ld.isValid() ) {
+    for(int b=0;b<PixelBunchPattern::NumberOfBx-1;++b)
+      lsLumiBx[b] = ld->lumiValue(LumiDetails::kOCC1, b)*6.37; // cor=6.37 in 2011, 7.13 in 2012?
+  }
+
+  //cout<<lumi.run()<<" "<<lumi.luminosityBlock()<<" "<<tmp0<<" "<<corr<<" "<<tmp1<<" "<<lsLumiAv<<endl;
+}
+// ------------ method called at the end of each lumi section  ------------
+void TestClusters::endLuminosityBlock(edm::LuminosityBlock const& lumi, edm::EventSetup const& es) {
+  bxAccumulator.flush();
+  lumiSummary.endLumi(lumi.run(),lumi.luminosityBlock());
+  if(doRocEff) {
+    // hits of the lumi section in the watched rocs
+    int ls = lumi.luminosityBlock();
+    rocOccupancy.endLumi(ls);
+    for(unsigned int k=0;k<watchedRocs.size();++k) {
+      float hits = float(rocOccupancy.lastCount(watchedRocs[k].roc));
+      if(hits>0) watchedRocs[k].h->Fill(float(ls),watchedRocs[k].bin,hits);
+    }
+  }
+}
+// ------------ rocs followed per lumi section in hrocHits*ls  ------------
+void TestClusters::watchRocs() {
+  // layer, online ladder, module, roc and histo bin, run 180250
+  const int rocs[][5] = { {1,-9,4,12,0}, {1,-7,-4,3,1}, {1,-5,-4,11,2}, {1,2,-2,1,3}, {1,8,2,1,4},
+			  {2,-2,1,10,0}, {2,10,-3,2,1}, {2,15,3,7,2},
+			  {3,-13,4,12,0}, {3,-7,-4,15,1}, {3,-6,-2,10,2} };
+  TH2F * histos[3] = {hrocHits1ls,hrocHits2ls,hrocHits3ls};
+  watchedRocs.clear();
+  for(unsigned int i=0;i<moduleIndex.size();++i) {
+    const SiPixelModuleIndex::Module & m = moduleIndex.module(i);
+    for(unsigned int k=0;k<sizeof(rocs)/sizeof(rocs[0]);++k) {
+      if(m.layer!=rocs[k][0] || m.ladderName!=rocs[k][1] || m.moduleName!=rocs[k][2]) continue;
+      WatchedRoc w = { rocOccupancy.rocIndex(i,rocs[k][3]), histos[rocs[k][0]-1], float(rocs[k][4]) };
+      if(w.roc>=0) watchedRocs.push_back(w);
+    }
+  }
 }
 // ------------ method called to at the end of the job  ------------
 void TestClusters::endJob(){
+  bxAccumulator.flush();
+  if(bxAccumulator.outOfRange()>0) 
+    cout<<" bx accumulator: "<<bxAccumulator.outOfRange()<<" entries with bx out of range skipped"<<endl;
+  if(lumiSummary.isOpen()) 
+    cout<<" lumi summary: "<<lumiSummary.lumis()<<" lumi sections written"<<endl;
   double norm = 1;
   double totClusters = sumClusters; // save the total cluster number
   if(countEvents>0) {
@@ -1519,7 +1151,7 @@ void TestClusters::endJob(){
 
   countLumi /= 1000.;
   double c1=0, c2=0;
-  double c3 = hinst->GetMean();
+  double c3 = doLumi ? hinst->GetMean() : 0.;
   if(c3>0.) {c1=sumClusters/c3; c2=sumPixels/c3;}
 
   cout << " End PixelClusTest, events all/with hits=  " << countAllEvents<<"/"<<countEvents
@@ -1527,161 +1159,88 @@ void TestClusters::endJob(){
   cout<<" Lumi = "<<countLumi<<" still the /10 bug? "<<"clu and pix per lumi unit"<<c1<<" "<<c2<<endl;
 
 
-  //Divide the size histos
-  hsizeDetMap1->Divide(hsizeDetMap1,hDetMap1,1.,1.);
-  hsizeDetMap2->Divide(hsizeDetMap2,hDetMap2,1.,1.);
-  hsizeDetMap3->Divide(hsizeDetMap3,hDetMap3,1.,1.);
-
-  // Rescale all 2D plots
-  hDetsMap1->Scale(norm);
-  hDetsMap2->Scale(norm);
-  hDetsMap3->Scale(norm);
-  hDetMap1->Scale(norm);
-  hDetMap2->Scale(norm);
-  hDetMap3->Scale(norm);
-  hpDetMap1->Scale(norm);
-  hpDetMap2->Scale(norm);
-  hpDetMap3->Scale(norm);
-  hpixDetMap1->Scale(norm);
-  hpixDetMap2->Scale(norm);
-  hpixDetMap3->Scale(norm);
-  hcluDetMap1->Scale(norm);
-  hcluDetMap2->Scale(norm);
-  hcluDetMap3->Scale(norm);
-
-
-
-#ifdef ROC_EFF
-
-  // Do this only if there is enough statistics
-  double clusPerROC = totClusters/15000.;
-  if( clusPerROC < 1000.) {
-    cout<<" The average number of clusters per ROC is too low to do teh ROF efficiency analysis "<<clusPerROC<<endl;
-    
-  } else { // do it
-
-    int deadRocs1 = 0, ineffRocs1=0,deadRocs2 = 0, ineffRocs2=0,deadRocs3 = 0, ineffRocs3=0 ;
-    const int ladders1[20] = {-10,-9,-8,-7,-6,-5,-4,-3,-2,-1,1,2,3,4,5,6,7,8,9,10};  
-    const int ladders2[32] = {-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
-    const int ladders3[44] = {-22,-21,-20,-19,-18,-17,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1,
-			      1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22};
-    const int modules[8] = {-4,-3,-2,-1,1,2,3,4};
-    const float effCut = 0.25;
-    float half1=1, half2=0;
-    
-    
+  if(doHistos) {
+    //Divide the size histos
+    hsizeDetMap1->Divide(hsizeDetMap1,hDetMap1,1.,1.);
+    hsizeDetMap2->Divide(hsizeDetMap2,hDetMap2,1.,1.);
+    hsizeDetMap3->Divide(hsizeDetMap3,hDetMap3,1.,1.);
+
+    // Rescale all 2D plots
+    hDetsMap1->Scale(norm);
+    hDetsMap2->Scale(norm);
+    hDetsMap3->Scale(norm);
+    hDetMap1->Scale(norm);
+    hDetMap2->Scale(norm);
+    hDetMap3->Scale(norm);
+    hpDetMap1->Scale(norm);
+    hpDetMap2->Scale(norm);
+    hpDetMap3->Scale(norm);
+    hpixDetMap1->Scale(norm);
+    hpixDetMap2->Scale(norm);
+    hpixDetMap3->Scale(norm);
+    hcluDetMap1->Scale(norm);
+    hcluDetMap2->Scale(norm);
+    hcluDetMap3->Scale(norm);
+  }
 
-  // layer 1
-  for(int ilad=0;ilad<20;++ilad) {
-    int lad = ladders1[ilad];
-    for(int imod=0;imod<8;++imod) {
-      int mod = modules[imod];
-      half1=0; half2=0;
-      float count = pixEff->getModule(1,lad,mod,half1,half2);
-      //cout<<" layer 1 "<<lad<<" "<<mod<<" "<<count<<endl;
-      if(count<1.) continue;  // skip dead modules 
-      for(int roc=0;roc<16;++roc) {
-	if     (roc<8 && half1==0) continue;
-	else if(roc>7 && half2==0) continue;
-        float tmp = pixEff->getRoc(1,lad,mod,roc);
-	if(tmp<0.) {  // half-module rocs will show up here
-	  if( (abs(lad)==1  || abs(lad)==10) && (roc>7) ) {  // OK half module
-	    continue;
-	  } else {		
-	    cout<<" Layer1, wrong number of hits, roc "<<tmp<<" "<<lad<<" "<<mod<<" "<<roc<<endl;
-	  }
-	} else if(tmp==0.) {
-	  deadRocs1++;
-	  cout<<" layer1, dead  roc "<<lad<<" "<<mod<<" "<<roc<<" - "<<count<<" "<<half1<<" "<<half2<<endl;
-	} else {
-	  hcountInRoc1->Fill(tmp);
-          float tmp1 = tmp/count;
-          //cout<<" roc "<<roc<<" "<<tmp<<" "<<tmp1<<endl;
-          hcountInRoc12->Fill(tmp1);
-	  if( abs(1.-tmp1)>effCut ) {
-	    ineffRocs1++;
-	    cout<<"LOW-EFF/NOISY ROC, Layer 1: "<<tmp1<<"/"<<tmp<<" ladder "<<lad<<" module "<<mod<<" roc(false #) "<<roc<<endl;
-	    hbadMap1->Fill(float(mod),float(lad));
- 	  }
-        } //if
-      } // loop over rocs
-    } // mod
-  } // lad    
 
-  for(int ilad=0;ilad<32;++ilad) {
-    int lad = ladders2[ilad];
-    for(int imod=0;imod<8;++imod) {
-      int mod = modules[imod];
-      half1=0; half2=0;
-      float count = pixEff->getModule(2,lad,mod,half1,half2);
-      //cout<<" layer 2 "<<lad<<" "<<mod<<" "<<count<<endl;
-      if(count<1.) continue; // skip dead whole modules
-      for(int roc=0;roc<16;++roc) {
-	if     (roc<8 && half1==0) continue;
-	else if(roc>7 && half2==0) continue;
-        float tmp = pixEff->getRoc(2,lad,mod,roc);
-	if(tmp<0.) { 
-	  if( (abs(lad)==1  || abs(lad)==16) && (roc>7) ) {  // OK half module
-	    continue;
-	  } else {
-	    cout<<" Layer 2, wrong number of hits, roc "<<tmp<<" "<<lad<<" "<<mod<<" "<<roc<<endl;
-	  }
-	} else if(tmp==0.) {
-	  deadRocs2++;
-	  cout<<" layer2, dead  roc "<<lad<<" "<<mod<<" "<<roc<<" - "<<count<<" "<<half1<<" "<<half2<<endl;
-	} else {
-	  hcountInRoc2->Fill(tmp);
-          float tmp1 = tmp/count;
-          //cout<<" roc "<<roc<<" "<<tmp<<" "<<tmp1<<endl;
-          hcountInRoc22->Fill(tmp1);
-	  if( abs(1.-tmp1)>effCut ) {
-	    ineffRocs2++;
-	    cout<<"LOW-EFF/NOISY ROC, Layer 2: "<<tmp1<<"/"<<tmp<<" ladder "<<lad<<" module "<<mod<<" roc(false) "<<roc<<endl; 
-	    hbadMap2->Fill(float(mod),float(lad));
-	  } 
-        } //if
-      } // loop over rocs
-    } // mod
-  } // lad    
 
-  for(int ilad=0;ilad<44;++ilad) {
-    int lad = ladders3[ilad];
-    for(int imod=0;imod<8;++imod) {
-      int mod = modules[imod];
+  if(doRocEff) {
+
+    // Do this only if there is enough statistics
+    double clusPerROC = totClusters/15000.;
+    if( clusPerROC < 1000.) {
+      cout<<" The average number of clusters per ROC is too low to do teh ROF efficiency analysis "<<clusPerROC<<endl;
+    
+    } else { // do it
+
+      // layers 1-3, fpix
+      int deadRocs[4] = {0,0,0,0}, ineffRocs[4] = {0,0,0,0};
+      TH1D * hcount[4]  = {hcountInRoc1,hcountInRoc2,hcountInRoc3,hcountInRoc4};
+      TH1D * hcountn[4] = {hcountInRoc12,hcountInRoc22,hcountInRoc32,hcountInRoc42};
+      TH2F * hbad[4]    = {hbadMap1,hbadMap2,hbadMap3,0};
+      const char * name[4] = {"Layer 1","Layer 2","Layer 3","FPix"};
+      const float effCut = 0.25;
+      float half1=1, half2=0;
+    
+    for(unsigned int i=0;i<moduleIndex.size();++i) {
+      const SiPixelModuleIndex::Module & m = moduleIndex.module(i);
+      int group = (m.layer>0) ? m.layer-1 : 3;
+      // barrel: online ladder and module; fpix: blade and disk, negative for -z
+      int lad = (m.layer>0) ? m.ladderName : m.blade;
+      int mod = (m.layer>0) ? m.moduleName : (m.side==1 ? -m.disk : m.disk);
       half1=0; half2=0;
-      float count = pixEff->getModule(3,lad,mod,half1,half2);
-      //cout<<" layer 3"<<lad<<" "<<mod<<" "<<count<<endl;
-      if(count<1.) continue; // skip dead whole modules
-      for(int roc=0;roc<16;++roc) {
-        float tmp = pixEff->getRoc(3,lad,mod,roc);
-	if(tmp<0.) {
-	  if( (abs(lad)==1  || abs(lad)==22) && (roc>7) ) {  // OK half module
-	    continue;
-	  } else {
-	    cout<<" Layer 3: wrong number of hits, roc "<<tmp<<" "<<lad<<" "<<mod<<" "<<roc<<endl;
-	  }
-	} else if(tmp==0.) {
-	  deadRocs3++;
-	  cout<<" layer3, dead  roc "<<lad<<" "<<mod<<" "<<roc<<" - "<<count<<" "<<half1<<" "<<half2<<endl;
+      float count = rocOccupancy.moduleAverage(i,half1,half2);
+      //cout<<name[group]<<" "<<lad<<" "<<mod<<" "<<count<<endl;
+      if(count<1.) continue;  // skip dead modules 
+      for(unsigned int roc=0;roc<rocOccupancy.numberOfRocs(i);++roc) {
+	if     (roc< rocOccupancy.rocsPerRow(i) && half1==0) continue;
+	else if(roc>=rocOccupancy.rocsPerRow(i) && half2==0) continue;
+	float tmp = rocOccupancy.count(i,roc);
+	if(tmp==0.) {
+	  deadRocs[group]++;
+	  cout<<" "<<name[group]<<", dead  roc "<<lad<<" "<<mod<<" "<<m.panel<<" "<<m.module<<" "<<roc
+	      <<" - "<<count<<" "<<half1<<" "<<half2<<endl;
 	} else {
-	  hcountInRoc3->Fill(tmp);
-          float tmp1 = tmp/count;
-          //cout<<" roc "<<roc<<" "<<tmp<<" "<<tmp1<<endl;
-          hcountInRoc32->Fill(tmp1);
+	  hcount[group]->Fill(tmp);
+	  float tmp1 = tmp/count;
+	  //cout<<" roc "<<roc<<" "<<tmp<<" "<<tmp1<<endl;
+	  hcountn[group]->Fill(tmp1);
 	  if( abs(1.-tmp1)>effCut ) {
-	    ineffRocs3++;
-	    cout<<"LOW-EFF/NOISY ROC, Layer 3: "<<tmp1<<"/"<<tmp<<" ladder "<<lad<<" module "<<mod<<" roc(false) "<<roc<<endl; 
-	    hbadMap3->Fill(float(mod),float(lad));
+	    ineffRocs[group]++;
+	    cout<<"LOW-EFF/NOISY ROC, "<<name[group]<<": "<<tmp1<<"/"<<tmp<<" ladder "<<lad<<" module "<<mod
+		<<" "<<m.panel<<" "<<m.module<<" roc(false #) "<<roc<<endl;
+	    if(hbad[group]) hbad[group]->Fill(float(mod),float(lad));
 	  }
-        } //if
+	} //if
       } // loop over rocs
-    } // mod
-  } // lad    
+    } // modules
 
-  cout<<" Bad Rocs "<<deadRocs1<<" "<<deadRocs2<<" "<<deadRocs3<<", Inefficient Rocs "<<ineffRocs1<<" "<<ineffRocs2<<" "<<ineffRocs3<<endl;
-  } // if DO IT
+    cout<<" Bad Rocs "<<deadRocs[0]<<" "<<deadRocs[1]<<" "<<deadRocs[2]<<" fpix "<<deadRocs[3]
+	<<", Inefficient Rocs "<<ineffRocs[0]<<" "<<ineffRocs[1]<<" "<<ineffRocs[2]<<" fpix "<<ineffRocs[3]<<endl;
+    } // if DO IT
 
-#endif // ROC_EFF
+  } // ROC_EFF
 
 }
 //////////////////////////////////////////////////////////////////
@@ -1702,6 +1261,10 @@ void TestClusters::analyze(const edm::Event& e,
   edm::ESHandle<TrackerGeometry> geom;
   es.get<TrackerDigiGeometryRecord>().get( geom );
   const TrackerGeometry& theTracker(*geom);
+  if( moduleIndex.update(es) ) {
+    cout<<" module index for "<<moduleIndex.size()<<" pixel modules"<<endl;
+    if( doRocEff && rocOccupancy.setLayout(moduleIndex) ) watchRocs();
+  }
 
   countAllEvents++;
   int run       = e.id().run();
@@ -1711,7 +1274,7 @@ void TestClusters::analyze(const edm::Event& e,
   int bx        = e.bunchCrossing();
   int orbit     = e.orbitNumber();
 
-  hbx0->Fill(float(bx));
+  bxAccumulator.fill(cbx0,bx);
   hlumi0->Fill(float(lumiBlock));
 
   //if(lumiBlock<127) return;
@@ -1720,60 +1283,24 @@ void TestClusters::analyze(const edm::Event& e,
   float instlumi=0;
   //int beamint1=0, beamint2=0;
 
-#ifdef Lumi
-  float instlumiAv = 0, instlumiBx = 0;
+  if(doLumi) {
+    // Lumi of the lumi section, from beginLuminosityBlock
+    float instlumiAv = lsLumiAv;
+    float instlumiBx = (bx>=0 && bx<int(lsLumiBx.size())) ? lsLumiBx[bx] : 0.;
 
-  // Lumi 
-  edm::LuminosityBlock const& iLumi = e.getLuminosityBlock();
-  edm::Handle<LumiSummary> lumi;
-  edm::Handle<LumiDetails> ld;
-  iLumi.getByLabel("lumiProducer", lumi);
-  iLumi.getByLabel("lumiProducer", ld);
+    hinst->Fill(float(instlumiBx));
+    //hintg->Fill(float(intlumi));
+    hinstls->Fill(float(lumiBlock),float(instlumiAv));
+    hinstlsbx->Fill(float(lumiBlock),float(instlumiBx));
+    lumiSummary.fill(lsInst,instlumiBx);
+    hinstbx->Fill(float(bx),float(instlumiBx));
+    //hbeam1->Fill(float(lumiBlock),float(beamint1));
+    //hbeam2->Fill(float(lumiBlock),float(beamint2));
 
-  edm::Handle<edm::ConditionsInLumiBlock> cond;
-  iLumi.getByLabel("conditionsInEdm", cond);
-  // This will only work when running on RECO until (if) they fix it in the FW
-  // When running on RAW and reconstructing, the LumiSummary will not appear
-  // in the event before reaching endLuminosityBlock(). Therefore, it is not
-  // possible to get this info in the event
-  if (lumi.isValid()) {
-    //intlumi =(lumi->intgRecLumi())/1000.; // integrated lumi per LS in -pb
-    //instlumi=(lumi->avgInsDelLumi())/1000.; //ave. inst lumi per LS in -pb
-    float tmp0 =(lumi->avgInsDelLumi()); //ave. inst lumi per LS in -nb
-    //beamint1=(cond->totalIntensityBeam1)/1000;
-    //beamint2=(cond->totalIntensityBeam2)/1000;
-    const int nbx=1331;  // for 1380 fills 
-    float corr = lumiCorrector->TotalNormOcc1( (tmp0/1000.),nbx);
-    //float tmp2 = lumiCorrector->TotalNormOcc2(tmp0,nbx);
-    //float tmp3 = lumiCorrector->TotalNormET(tmp0,nbx);
-    float tmp1 = tmp0 * corr;
-    //instlumiAv = tmp1/1000000.;  // in 10^33 
-    float tmp2 = tmp1/float(nbx)/1000.;  // per bx
-    instlumiAv = tmp2;  // use per bx lumi 
-
-    if( ld.isValid() ) {
-      instlumiBx = ld->lumiValue(LumiDetails::kOCC1, bx)*6.37; // cor=6.37 in 2011, 7.13 in 2012?
-    }
-
-    //cout<<run<<" "<<lumiBlock<<" "<<tmp0<<" "<<corr<<" "<<tmp1<<" "<<instlumiAv<<" "<<tmp2<<" ";
-    //cout<<instlumiBx<<endl;
-
-  } else {
-    //std::cout << "** ERROR: Event does not get lumi info\n";
-  }
+    // Use this per bx as int lumi 
+    instlumi = instlumiBx;
 
-  hinst->Fill(float(instlumiBx));
-  //hintg->Fill(float(intlumi));
-  hinstls->Fill(float(lumiBlock),float(instlumiAv));
-  hinstlsbx->Fill(float(lumiBlock),float(instlumiBx));
-  hinstbx->Fill(float(bx),float(instlumiBx));
-  //hbeam1->Fill(float(lumiBlock),float(beamint1));
-  //hbeam2->Fill(float(lumiBlock),float(beamint2));
-
-  // Use this per bx as int lumi 
-  instlumi = instlumiBx;
-
-#endif
+  } // lumi
 
   // PVs
   int numPVsGood = 0;
@@ -1805,26 +1332,28 @@ void TestClusters::analyze(const edm::Event& e,
     
     hpvs->Fill(float(numPVsGood));
     hpvls->Fill(float(lumiBlock),float(numPVsGood));
+    lumiSummary.fill(lsPvs,numPVsGood);
     if(instlumi>0.) {
       float tmp = float(numPVsGood)/instlumi;
       //hpvlsn->Fill(float(lumiBlock),tmp);
     }
   } // if run
     
-#ifdef BX
-  int bxId = -1;
-  //cout<<" for bx "<<bx<<endl;
-  bxId = getbx->find(bx);  // get the bunch type 
-  //cout<<" id is "<<bxId<<endl;
+  int bxId = -1;  // bunch type, stays -1 without the bx feature
+  if(doBX) {
+    //cout<<" for bx "<<bx<<endl;
+    if(bunchPattern.setRun(run) && PRINT) cout<<" run "<<run<<" bunch pattern of fill "<<bunchPattern.fill()<<endl;
+    bxId = bunchPattern.find(bx);  // get the bunch type 
+    //cout<<" id is "<<bxId<<endl;
+
+    if(bxId==3)      bxAccumulator.fill(cbx1,bx);
+    else if(bxId==4) bxAccumulator.fill(cbx2,bx);
+    else if(bxId==1) bxAccumulator.fill(cbx3,bx);
+    else if(bxId==2) bxAccumulator.fill(cbx4,bx);
+    else if(bxId==5 || bxId==6) bxAccumulator.fill(cbx5,bx);
+    else if(bxId==0) bxAccumulator.fill(cbx6,bx);
 
-  if(bxId==3)      hbx1->Fill(float(bx));
-  else if(bxId==4) hbx2->Fill(float(bx));
-  else if(bxId==1) hbx3->Fill(float(bx));
-  else if(bxId==2) hbx4->Fill(float(bx));
-  else if(bxId==5 || bxId==6) hbx5->Fill(float(bx));
-  else if(bxId==0) hbx6->Fill(float(bx));
-
-#endif
+  }
 
 
 
@@ -1851,10 +1380,9 @@ void TestClusters::analyze(const edm::Event& e,
     bptx3=false, bptx4=false, bptx5=false, bptx6=false,bptx7=false;
   //bool  bcsOR=false, bit32_33=false, bit40=false, bit41=false, halo=false, splash1=false, splash2=false;
 
-#ifdef L1
   // Get L1
   Handle<L1GlobalTriggerReadoutRecord> L1GTRR;
-  e.getByLabel("gtDigis",L1GTRR);
+  if(doL1) e.getByLabel("gtDigis",L1GTRR);  // else not valid
 
 
   if (L1GTRR.isValid()) {
@@ -1868,9 +1396,11 @@ void TestClusters::analyze(const edm::Event& e,
     // <<techLowNonPres<<" "<<techHighNonPres<<dec<<endl;
 
     //cout<<" L1 status = "<<l1a<<" : ";
-    for (unsigned int i = 0; i < L1GTRR->decisionWord().size(); ++i) {
-      int l1flag = L1GTRR->decisionWord()[i]; 
-      int t1flag = L1GTRR->technicalTriggerWord()[i]; 
+    const DecisionWord & l1Word = L1GTRR->decisionWord();
+    const TechnicalTriggerWord & techWord = L1GTRR->technicalTriggerWord();
+    for (unsigned int i = 0; i < l1Word.size(); ++i) {
+      int l1flag = l1Word[i];
+      int t1flag = techWord[i];
       int techflag = 0;
       if(i<32) techflag = ( techLowNonPres & (0x1<<i) );
       else if(i<64) techflag = ( techHighNonPres & (0x1<<i) );
@@ -1909,7 +1439,6 @@ void TestClusters::analyze(const edm::Event& e,
     //cout<<dec<<endl;
 
   } // if l1a
-#endif
 
   bool bptx_and = bptx_m && bptx_p;
   bool bptx_or  = bptx_m || bptx_p;
@@ -1921,51 +1450,33 @@ void TestClusters::analyze(const edm::Event& e,
   bool hlt[256];
   for(int i=0;i<256;++i) hlt[i]=false;
 
-#ifdef HLT
-
-  edm::TriggerNames TrigNames;
-  edm::Handle<edm::TriggerResults> HLTResults;
-
-  // Extract the HLT results
-  e.getByLabel(edm::InputTag("TriggerResults","","HLT"),HLTResults);
-  if ((HLTResults.isValid() == true) && (HLTResults->size() > 0)) {
-
-    //TrigNames.init(*HLTResults);
-    const edm::TriggerNames & TrigNames = e.triggerNames(*HLTResults);
+  if(doHLT) {
 
-    //cout<<TrigNames.triggerNames().size()<<endl;
+    edm::Handle<edm::TriggerResults> HLTResults;
 
-    for (unsigned int i = 0; i < TrigNames.triggerNames().size(); i++) {  // loop over trigger
-      if(countAllEvents==1) cout<<i<<" "<<TrigNames.triggerName(i)<<endl;
+    // Extract the HLT results
+    e.getByLabel(edm::InputTag("TriggerResults","","HLT"),HLTResults);
+    if ((HLTResults.isValid() == true) && (HLTResults->size() > 0)) {
 
-      if ( 
-	   (HLTResults->wasrun(TrigNames.triggerIndex(TrigNames.triggerName(i))) == true) &&
-	   (HLTResults->accept(TrigNames.triggerIndex(TrigNames.triggerName(i))) == true) &&
-	   (HLTResults->error( TrigNames.triggerIndex(TrigNames.triggerName(i))) == false) ) {
-
-	hlt[i]=true;
-	hlt1->Fill(float(i));
-
-// 	if (      TrigNames.triggerName(i) == "HLT_L1Tech_BSC_minBias") passHLT1=true;
-// 	else if  (TrigNames.triggerName(i) == "HLT_L1Tech_BSC_minBias_OR") passHLT2=true;
-// 	else if  (TrigNames.triggerName(i) == "HLT_L1_BptxXOR_BscMinBiasOR")
-// 	  passHLT3=true;
-// 	else if  (TrigNames.triggerName(i) == "HLT_L1Tech_BSC_halo_forPhysicsBackground") passHLT4=true;
-// 	//
-// 	//else if  (TrigNames.triggerName(i) == "HLT_L1_BPTX") passHLT5=true;
-// 	else if  (TrigNames.triggerName(i) == "HLT_L1_ZeroBias") passHLT5=true;
-// 	//else if  (TrigNames.triggerName(i) == "HLT_L1_BPTX_MinusOnly") passHLT5=true;
-// 	//else if  (TrigNames.triggerName(i) == "HLT_L1_BPTX_PlusOnly") passHLT5=true;
-// 	else if ((TrigNames.triggerName(i) == "HLT_MinBiasPixel_SingleTrac") ||
-// 		 (TrigNames.triggerName(i) == "HLT_MinBiasPixel_DoubleTrack") ||
-// 		 (TrigNames.triggerName(i) == "HLT_MinBiasPixel_DoubleIsoTrack5") )
-//	  passHLT5=true;
-
-      } // if hlt
+      // decode the menu only when it changes, the path index is the bit
+      if(HLTResults->parameterSetID() != hltMenu) {
+	hltMenu = HLTResults->parameterSetID();
+	const edm::TriggerNames & TrigNames = e.triggerNames(*HLTResults);
+	hltPaths = min(min((unsigned int)TrigNames.size(),(unsigned int)HLTResults->size()),256u);
+	cout<<" HLT menu of run "<<run<<", "<<TrigNames.size()<<" paths"<<endl;
+	for (unsigned int i = 0; i < TrigNames.size(); i++) cout<<i<<" "<<TrigNames.triggerName(i)<<endl;
+	// paths used by name are looked up here, once per menu, e.g.
+	// hltZeroBias = TrigNames.triggerIndex("HLT_L1_ZeroBias"); // size() if not in the menu
+      }
 
-    } // loop 
-  } // if valid
-#endif
+      for (unsigned int i = 0; i < hltPaths; i++) {  // loop over trigger
+	if( HLTResults->wasrun(i) && HLTResults->accept(i) && !HLTResults->error(i) ) {
+	  hlt[i]=true;
+	  hlt1->Fill(float(i));
+	} // if hlt
+      } // loop
+    } // if valid
+  } // HLT
 
   //----------------------------------------------
 
@@ -1994,9 +1505,9 @@ void TestClusters::analyze(const edm::Event& e,
 
   hevent->Fill(float(event));
   hlumi->Fill(float(lumiBlock));
-  hbx->Fill(float(bx));
+  bxAccumulator.fill(cbx,bx);
   //horbit->Fill(float(orbit));
-  for (unsigned int i=0;i<256;i++) if(hlt[i]==true) hlt2->Fill(float(i));
+  if(doHLT) for (unsigned int i=0;i<256;i++) if(hlt[i]==true) hlt2->Fill(float(i));
 
   if(run!=runNumberOld) {
     runNumberOld=run;
@@ -2067,6 +1578,9 @@ void TestClusters::analyze(const edm::Event& e,
   //static int module3[416][160] = {{0}};
 
   
+  // the per pixel, cluster and module histos of the selected events
+  const bool fillHistos = doHistos && (selectEvent==-1 || countEvents==selectEvent);
+
   // get vector of detunit ids
   //--- Loop over detunits.
   edmNew::DetSetVector<SiPixelCluster>::const_iterator DSViter=input.begin();
@@ -2082,11 +1596,9 @@ void TestClusters::analyze(const edm::Event& e,
       cout<<"Det: "<<detId.rawId()<<" "<<detId.null()<<" "<<detType<<" "<<subid<<endl;    
 
 
-#ifdef HISTOS
     //hdetunit->Fill(float(detid));
     //hpixid->Fill(float(detType));
     //hpixsubid->Fill(float(subid));
-#endif // HISTOS
 
     if(detType!=1) continue; // look only at pixels
     ++numberOfDetUnits;
@@ -2113,8 +1625,6 @@ void TestClusters::analyze(const edm::Event& e,
     unsigned int layerC=0;
     unsigned int ladderC=0;
     unsigned int zindex=0;
-    int shell  = 0; // shell id // Shell { mO = 1, mI = 2 , pO =3 , pI =4 };
-    int sector = 0; // 1-8
     int ladder = 0; // 1-22
     int layer  = 0; // 1-3
     int module = 0; // 1-4
@@ -2129,15 +1639,22 @@ void TestClusters::analyze(const edm::Event& e,
 
     edmNew::DetSet<SiPixelCluster>::const_iterator clustIt;
 
+    // Module ids from the index, decoded once per geometry
+    int moduleIdx = moduleIndex.index(detid);
+    if(moduleIdx<0) {
+      cout<<" det "<<detid<<" not in the pixel geometry "<<endl;
+      continue;
+    }
+    const SiPixelModuleIndex::Module & pixModule = moduleIndex.module(moduleIdx);
+
     // Subdet id, pix barrel=1, forward=2
     if(subid==2) {  // forward
 
-      PXFDetId pdetId = PXFDetId(detid);       
-      disk=pdetId.disk(); //1,2,3
-      blade=pdetId.blade(); //1-24
-      zindexF=pdetId.module(); //
-      side=pdetId.side(); //size=1 for -z, 2 for +z
-      panel=pdetId.panel(); //panel=1
+      disk=pixModule.disk; //1,2,3
+      blade=pixModule.blade; //1-24
+      zindexF=pixModule.module; //
+      side=pixModule.side; //size=1 for -z, 2 for +z
+      panel=pixModule.panel; //panel=1
       
       if(PRINT) cout<<" forward det, disk "<<disk<<", blade "
  		    <<blade<<", module "<<zindexF<<", side "<<side<<", panel "
@@ -2147,41 +1664,23 @@ void TestClusters::analyze(const edm::Event& e,
 
     } else if (subid==1) {  // barrel
 
-      PXBDetId pdetId = PXBDetId(detid);  // 
-      //unsigned int detTypeP=pdetId.det();  // pix det identification
-      //unsigned int subidP=pdetId.subdetId(); // sub deu id
       // Barell layer = 1,2,3
-      layerC=pdetId.layer();
+      layerC=pixModule.layer;
       // Barrel ladder id 1-20,32,44.
-      ladderC=pdetId.ladder();
+      ladderC=pixModule.ladder;
       // Barrel Z-index=1,8
-      zindex=pdetId.module();
-
-      // Convert to online 
-      PixelBarrelName pbn(pdetId);
-      // Shell { mO = 1, mI = 2 , pO =3 , pI =4 };
-      PixelBarrelName::Shell sh = pbn.shell(); //enum
-      sector = pbn.sectorName();
-      ladder = pbn.ladderName();
-      layer  = pbn.layerName();
-      module = pbn.moduleName();
-      half  = pbn.isHalfModule();
-      shell = int(sh);
-      // change the module sign for z<0
-      if(shell==1 || shell==2) module = -module;
-      // change ladeer sign for Outer )x<0)
-      if(shell==1 || shell==3) ladder = -ladder;
+      zindex=pixModule.module;
+
+      // Online, ladder negative for x<0, module negative for z<0
+      ladder = pixModule.ladderName;
+      layer  = pixModule.layer;
+      module = pixModule.moduleName;
+      half  = pixModule.half;
       
       if(PRINT) { 
 	cout<<" Barrel layer, ladder, module "
 	    <<layerC<<" "<<ladderC<<" "<<zindex<<" "
-	    <<sh<<"("<<shell<<") "<<sector<<" "<<layer<<" "<<ladder<<" "
-	    <<module<<" "<<half<< endl;
-	//cout<<" Barrel det, thick "<<detThick<<" "
-	//  <<" layer, ladder, module "
-	//  <<layer<<" "<<ladder<<" "<<zindex<<endl;
-	//cout<<" col/row, pitch "<<cols<<" "<<rows<<" "
-	//  <<pitchX<<" "<<pitchY<<endl;
+	    <<layer<<" "<<ladder<<" "<<module<<" "<<half<< endl;
       }      
       
     } // if subid
@@ -2250,18 +1749,15 @@ void TestClusters::analyze(const edm::Event& e,
 	float pixx = pixelsVec[i].x; // index as float=iteger, row index
 	float pixy = pixelsVec[i].y; // same, col index
 	float adc = (float(pixelsVec[i].adc)/1000.);
-#ifdef ROC_EFF
-	int roc = rocId(int(pixy),int(pixx));  // column, row
-#endif
+	if(doRocEff) rocOccupancy.fill(moduleIdx,int(pixy),int(pixx));  // column, row
 	//int chan = PixelChannelIdentifier::pixelToChannel(int(pixx),int(pixy));
 
 	bool bigInX = topol->isItBigPixelInX(int(pixx));
 	bool bigInY = topol->isItBigPixelInY(int(pixy));
 	if( !(bigInX || bigInY) ) numberOfNoneEdgePixels++;
 	
-#ifdef HISTOS
 	// Pixel histos
-	if (subid==1 && (selectEvent==-1 || countEvents==selectEvent)) {  // barrel
+	if (subid==1 && fillHistos) {  // barrel
 	  if(layer==1) {
 	    numOfPixPerDet1++;
 	    numOfPixPerLay1++;     
@@ -2301,36 +1797,6 @@ void TestClusters::analyze(const edm::Event& e,
 	   hcharPixLumi->Fill(instlumi,adc);
 
 
-#ifdef ROC_EFF
-	   pixEff->addPixel(1,ladder,module,roc);  // count pixels
-	   
-	   //index = lumiBlock/5;
-// 	   if     (ladder== 3 && module== 3)  hmoduleHits1ls->Fill(float(lumiBlock),0);
-// 	   if     (ladder==-9 && module==-3 && roc== 9)  hrocHits1ls->Fill(float(lumiBlock),0);
-// 	   else if(ladder==-9 && module==-1 && roc== 0)  hrocHits1ls->Fill(float(lumiBlock),1);
-// 	   else if(ladder==-8 && module==-1 && roc== 2)  hrocHits1ls->Fill(float(lumiBlock),2);
-// 	   else if(ladder==-8 && module== 1 && roc== 2)  hrocHits1ls->Fill(float(lumiBlock),3);
-// 	   else if(ladder==-4 && module==-2 && roc== 2)  hrocHits1ls->Fill(float(lumiBlock),4);
-// 	   else if(ladder== 2 && module== 2 && roc== 4)  hrocHits1ls->Fill(float(lumiBlock),5);
-// 	   else if(ladder== 3 && module==-2 && roc== 4)  hrocHits1ls->Fill(float(lumiBlock),6);
-// 	   else if(ladder== 3 && module== 1 && roc== 6)  hrocHits1ls->Fill(float(lumiBlock),7);
-// 	   else if(ladder== 4 && module== 3 && roc== 8)  hrocHits1ls->Fill(float(lumiBlock),8);
-// 	   else if(ladder== 8 && module==-4 && roc==11)  hrocHits1ls->Fill(float(lumiBlock),9);
-	   // run 176286
-	   //if     (ladder==-3 && module== 1 && roc== 5)  hrocHits1ls->Fill(float(lumiBlock),0);
-	   //else if(ladder== 2 && module==-1 && roc==13)  hrocHits1ls->Fill(float(lumiBlock),1);
-	   //else if(ladder== 3 && module== 4 && roc== 9)  hrocHits1ls->Fill(float(lumiBlock),2);
-	   //else if(ladder== 5 && module== 2 && roc== 3)  hrocHits1ls->Fill(float(lumiBlock),3);
-	   //else if(ladder== 7 && module==-1 && roc== 8)  hrocHits1ls->Fill(float(lumiBlock),4);
-	   //else if(ladder== 2 && module== 1 && roc== 0)  hrocHits1ls->Fill(float(lumiBlock),5);
-	   // run 180250
-	   if     (ladder==-9 && module== 4 && roc== 12)  hrocHits1ls->Fill(float(lumiBlock),0);
-	   else if(ladder==-7 && module==-4 && roc==3)  hrocHits1ls->Fill(float(lumiBlock),1);
-	   else if(ladder==-5 && module==-4 && roc==11)  hrocHits1ls->Fill(float(lumiBlock),2);
-	   else if(ladder== 2 && module==-2 && roc== 1)  hrocHits1ls->Fill(float(lumiBlock),3);
-	   else if(ladder== 8 && module== 2 && roc== 1)  hrocHits1ls->Fill(float(lumiBlock),4);
-	   //else if(ladder== 2 && module== 1 && roc== 0)  hrocHits1ls->Fill(float(lumiBlock),5);
-#endif
 	    
 	  } else if(layer==2) {
 
@@ -2359,35 +1825,6 @@ void TestClusters::analyze(const edm::Event& e,
 	    if(pixx<80.) numOfPixPerLink21++;
 	    else numOfPixPerLink22++;
 
-#ifdef ROC_EFF
-	    pixEff->addPixel(2,ladder,module,roc);
-
-	   //index = lumiBlock/5;
-// 	    if     (ladder==10 && module== 2)  hmoduleHits2ls->Fill(float(lumiBlock),0); // many resyncs
-
-// 	   if     (ladder==-2 && module== 1 && roc==10)  hrocHits2ls->Fill(float(lumiBlock),0);
-// 	   else if(ladder== 1 && module== 1 && roc== 3)  hrocHits2ls->Fill(float(lumiBlock),1);
-// 	   else if(ladder== 1 && module== 2 && roc== 4)  hrocHits2ls->Fill(float(lumiBlock),2);
-// 	   else if(ladder== 2 && module==-4 && roc== 3)  hrocHits2ls->Fill(float(lumiBlock),3);
-// 	   else if(ladder==10 && module==-3 && roc== 1)  hrocHits2ls->Fill(float(lumiBlock),4);
-// 	   else if(ladder==10 && module==-1 && roc==10)  hrocHits2ls->Fill(float(lumiBlock),5);
-// 	   else if(ladder==11 && module== 3 && roc==13)  hrocHits2ls->Fill(float(lumiBlock),6);
-// 	   else if(ladder==12 && module==-4 && roc==14)  hrocHits2ls->Fill(float(lumiBlock),7);
-// 	   else if(ladder==12 && module==-1 && roc== 3)  hrocHits2ls->Fill(float(lumiBlock),8);
-// 	   else if(ladder==-5 && module==-2 && roc==10)  hrocHits2ls->Fill(float(lumiBlock),9);
-// 	   else if(ladder==10 && module== 2 && roc== 0)  hrocHits3ls->Fill(float(lumiBlock),9); // many resuncs 
-
-	   // run 176286
-	   //if     (ladder==-5 && module==-2 && roc==10)  hrocHits2ls->Fill(float(lumiBlock),0);
-	   //else if(ladder==-2 && module==-4 && roc==12)  hrocHits2ls->Fill(float(lumiBlock),1);
-	   //else if(ladder==15 && module==-1 && roc==11)  hrocHits2ls->Fill(float(lumiBlock),2);
-	   //else if(ladder== 2 && module==1  && roc== 0)  hrocHits2ls->Fill(float(lumiBlock),3);
-	   // run 180250
-	   if     (ladder==-2 && module== 1 && roc==10)  hrocHits2ls->Fill(float(lumiBlock),0);
-	   else if(ladder==10 && module==-3 && roc== 2)  hrocHits2ls->Fill(float(lumiBlock),1);
-	   else if(ladder==15 && module== 3 && roc== 7)  hrocHits2ls->Fill(float(lumiBlock),2);
-	   //else if(ladder== 2 && module==1  && roc== 0)  hrocHits2ls->Fill(float(lumiBlock),3);
-#endif
 
 	    hpixcharge2->Fill(adc);
 	    hpixDetMap2->Fill(pixy,pixx);
@@ -2455,41 +1892,10 @@ void TestClusters::analyze(const edm::Event& e,
 	    //cout<<" module "<<layer<<" "<<ladder<<" "<<module<<" "
 	    //  <<pixx<<" "<<pixy<<" "<<module3[int(pixx)][int(pixy)]<<endl;
 
-#ifdef ROC_EFF
-	    pixEff->addPixel(3,ladder,module,roc);
-
-	    //index = lumiBlock/5;
-// 	    if     (ladder==11 && module== 1)  hmoduleHits3ls->Fill(float(lumiBlock),0);
-	    
-// 	    if     (ladder==-18 && module==-3 && roc== 0)  hrocHits3ls->Fill(float(lumiBlock),0);
-// 	    else if(ladder== 5  && module== 1 && roc== 5)  hrocHits3ls->Fill(float(lumiBlock),1);
-// 	    else if(ladder== 9  && module==-1 && roc== 2)  hrocHits3ls->Fill(float(lumiBlock),2);
-// 	    else if(ladder==10  && module==-3 && roc== 8)  hrocHits3ls->Fill(float(lumiBlock),3);
-// 	    else if(ladder==12  && module==-3 && roc==12)  hrocHits3ls->Fill(float(lumiBlock),4);
-// 	    else if(ladder==-18 && module==-2 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),5);
-	    //else if(ladder==-3  && module==-3 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),6);
-	    //else if(ladder==-3  && module==-3 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),7);
-	    //else if(ladder==-3  && module==-3 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),8);
-	    //else if(ladder==-3  && module==-3 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),9);
-	    
-	    // run 176286
-	    //if     (ladder==-18 && module==-2 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),0);
-	    //else if(ladder==-3  && module==-3 && roc==14)  hrocHits3ls->Fill(float(lumiBlock),1);
-	    //else if(ladder== 3  && module==-1 && roc==12)  hrocHits3ls->Fill(float(lumiBlock),2);
-	    //else if(ladder==16  && module==-3 && roc== 6)  hrocHits3ls->Fill(float(lumiBlock),3);
-	    //else if(ladder== 2  && module== 1 && roc== 0)  hrocHits3ls->Fill(float(lumiBlock),4);
-	    // run 180250
-	    if     (ladder==-13 && module== 4 && roc==12)  hrocHits3ls->Fill(float(lumiBlock),0);
-	    else if(ladder==-7  && module==-4 && roc==15)  hrocHits3ls->Fill(float(lumiBlock),1);
-	    else if(ladder==-6  && module==-2 && roc==10)  hrocHits3ls->Fill(float(lumiBlock),2);
-	    //else if(ladder==16  && module==-3 && roc== 6)  hrocHits3ls->Fill(float(lumiBlock),3);
-	    //else if(ladder== 2  && module== 1 && roc== 0)  hrocHits3ls->Fill(float(lumiBlock),4);
-	    
-#endif
 
 	  }  // if layer
 
-	} else if (subid==2 && (selectEvent==-1 || countEvents==selectEvent)) {  // endcap
+	} else if (subid==2 && fillHistos) {  // endcap
 	  // pixels
 
 	  if(disk==1) { // disk1 -+z
@@ -2513,7 +1919,6 @@ void TestClusters::analyze(const edm::Event& e,
 
 	} // end if subdet (pixel loop)
 
-#endif // HISTOS
 	
 	edgeInX = topol->isItEdgePixelInX(int(pixx));
 	edgeInY = topol->isItEdgePixelInY(int(pixy));
@@ -2530,10 +1935,9 @@ void TestClusters::analyze(const edm::Event& e,
       
 
 
-#ifdef HISTOS
       
       // Cluster histos
-      if (subid==1 && (selectEvent==-1 || countEvents==selectEvent) ) {  // barrel
+      if (subid==1 && fillHistos ) {  // barrel
 	//if (subid==1) {  // barrel
 
 	if(layer==1) {  // layer 1
@@ -2565,7 +1969,6 @@ void TestClusters::analyze(const edm::Event& e,
 	  hclumulty1->Fill(zPos,sizeY);
 	  hcluchar1->Fill(zPos,ch);
 
-#ifdef BX
 	  if(bxId>-1) {
 	    if(bxId==3)      hchargebx1->Fill(ch);
 	    else if(bxId==4) hchargebx2->Fill(ch);
@@ -2575,9 +1978,8 @@ void TestClusters::analyze(const edm::Event& e,
 	    else if(bxId==5 || bxId==6) hchargebx5->Fill(ch);
 	    else cout<<" wrong bx id "<<bxId<<endl;
 	  }
-#endif
 
-	  hcharClubx->Fill(bx,ch);
+	  bxAccumulator.fill(ccharClubx,bx,ch,layer-1);
 	  hsizeClubx->Fill(bx,size);
 	  hsizeYClubx->Fill(bx,sizeY);
 	  hcharCluls->Fill(lumiBlock,ch);
@@ -2635,7 +2037,6 @@ void TestClusters::analyze(const edm::Event& e,
 	    }
 	  }
 
-#ifdef BX
 	  if(bxId>-1) {
 	    if(bxId==3) hchargebx1->Fill(ch);
 	    else if(bxId==4) hchargebx2->Fill(ch);
@@ -2645,8 +2046,7 @@ void TestClusters::analyze(const edm::Event& e,
 	    else if(bxId==5 || bxId==6) hchargebx5->Fill(ch);
 	    else cout<<" wrong bx id "<<bxId<<endl;
 	  }
-#endif
-	  hcharClubx->Fill(bx,ch);
+	  bxAccumulator.fill(ccharClubx,bx,ch,layer-1);
 	  hsizeClubx->Fill(bx,size);
 	  hsizeYClubx->Fill(bx,sizeY);
 	  hcharCluls->Fill(lumiBlock,ch);
@@ -2684,7 +2084,6 @@ void TestClusters::analyze(const edm::Event& e,
 	  hclumulty3->Fill(zPos,sizeY);
 	  hcluchar3->Fill(zPos,ch);
 
-#ifdef BX
 	  if(bxId>-1) {
 	    if(bxId==3) hchargebx1->Fill(ch);
 	    else if(bxId==4) hchargebx2->Fill(ch);
@@ -2694,9 +2093,8 @@ void TestClusters::analyze(const edm::Event& e,
 	    else if( bxId==5 || bxId==6 ) hchargebx5->Fill(ch);
 	    else cout<<" wrong bx id "<<bxId<<endl;
 	  }
-#endif
 
-	  hcharClubx->Fill(bx,ch);
+	  bxAccumulator.fill(ccharClubx,bx,ch,layer-1);
 	  hsizeClubx->Fill(bx,size);
 	  hsizeYClubx->Fill(bx,sizeY);
 	  hcharCluls->Fill(lumiBlock,ch);
@@ -2713,7 +2111,7 @@ void TestClusters::analyze(const edm::Event& e,
 
 	} // end if layer
 
-      } else if (subid==2 && (selectEvent==-1 || countEvents==selectEvent) ) {  // endcap
+      } else if (subid==2 && fillHistos ) {  // endcap
 
 	//cout<<disk<<" "<<side<<endl;
 	if(disk==1) { // disk1 -+z
@@ -2743,7 +2141,6 @@ void TestClusters::analyze(const edm::Event& e,
 
       } // end barrel/forward cluster loop
       
-#endif // HISTOS
 
       if(edgeHitX != edgeHitX2) 
 	cout<<" wrong egdeX "<<edgeHitX<<" "<<edgeHitX2<<endl;
@@ -2766,8 +2163,7 @@ void TestClusters::analyze(const edm::Event& e,
 	cout<<"Lay3: number of clusters per det = "<<numOfClustersPerDet1<<endl;
     } // end if PRINT
 
-#ifdef HISTOS
-    if (subid==1 && (selectEvent==-1 || countEvents==selectEvent) ) {  // barrel
+    if (subid==1 && fillHistos ) {  // barrel
       //if (subid==1 && countEvents==selectEvent) {  // barrel
 
       //hlayerid->Fill(float(layer));
@@ -2854,7 +2250,6 @@ void TestClusters::analyze(const edm::Event& e,
       
     } // end barrel/forward
 
-#endif // HISTOS
     
   } // detunits loop
 
@@ -2872,18 +2267,17 @@ void TestClusters::analyze(const edm::Event& e,
 	<<numberOfDetUnits2<<" "<<numberOfDetUnits3<<endl;
   } // if PRINT
   
-#ifdef HISTOS
 
   //if(numberOfClusters<=3) continue; // skip events
-  if ( (selectEvent==-1 || countEvents==selectEvent) ) { 
+  if ( fillHistos ) { 
 
     hclus16->Fill(float(numOf));            // number of modules with pix
     hlumi1->Fill(float(lumiBlock));
     
-    if(bptx_m && bptx_xor) hbx7->Fill(float(bx));
-    if(bptx_p && bptx_xor) hbx8->Fill(float(bx));
-    if(bptx_and) hbx9->Fill(float(bx));
-    if(bptx_or)  hbx10->Fill(float(bx));
+    if(bptx_m && bptx_xor) bxAccumulator.fill(cbx7,bx);
+    if(bptx_p && bptx_xor) bxAccumulator.fill(cbx8,bx);
+    if(bptx_and) bxAccumulator.fill(cbx9,bx);
+    if(bptx_or)  bxAccumulator.fill(cbx10,bx);
 
     
     hdigis->Fill(float(numberOfPixels));  // all pix 
@@ -2916,20 +2310,26 @@ void TestClusters::analyze(const edm::Event& e,
     hclusFPix->Fill(float(clusf));  // clusters in fpix
 
     hclus5->Fill(float(numberOfNoneEdgePixels));   // count none edge pixels
-    hclusls->Fill(float(lumiBlock),float(numberOfClusters)); // clusters fpix+bpix
-    hpixls->Fill(float(lumiBlock),float(numberOfPixels)); // pixels fpix+bpix
+    if(!lumiSummary.isOpen()) {
+      hclusls->Fill(float(lumiBlock),float(numberOfClusters)); // clusters fpix+bpix
+      hpixls->Fill(float(lumiBlock),float(numberOfPixels)); // pixels fpix+bpix
+    }
+    lumiSummary.fill(lsClus,numberOfClusters);
+    lumiSummary.fill(lsPix,numberOfPixels);
 
-    hclubx->Fill(float(bx),float(numberOfClusters)); // clusters fpix+bpix
-    hpixbx->Fill(float(bx),float(numberOfPixels)); // pixels fpix+bpix
+    bxAccumulator.fill(cclubx,bx,float(numberOfClusters)); // clusters fpix+bpix
+    bxAccumulator.fill(cpixbx,bx,float(numberOfPixels)); // pixels fpix+bpix
     hpvbx->Fill(float(bx),float(numPVsGood)); // pvs
 
 
     if(instlumi>0.) {
       float tmp = float(numberOfClusters)/instlumi;
-      hcluslsn->Fill(float(lumiBlock),tmp); // clusters fpix+bpix
+      if(!lumiSummary.isOpen()) hcluslsn->Fill(float(lumiBlock),tmp); // clusters fpix+bpix
       tmp = float(numberOfPixels)/instlumi;
-      hpixlsn->Fill(float(lumiBlock),tmp); // pixels fpix+bpix
-      
+      if(!lumiSummary.isOpen()) hpixlsn->Fill(float(lumiBlock),tmp); // pixels fpix+bpix
+      lumiSummary.fill(lsClusN,float(numberOfClusters)/instlumi);
+      lumiSummary.fill(lsPixN,tmp);
+
       hcluLumi->Fill(instlumi,float(numberOfClusters)); // clus 
       hpixLumi->Fill(instlumi,float(numberOfPixels)); // pix
 
@@ -3154,89 +2554,90 @@ void TestClusters::analyze(const edm::Event& e,
 //     }
 #endif // SEB 
 
-#ifdef L1
-    int numberOfClusters0 = numberOfClusters;  // select all clusters
+    if(doL1) {
+      int numberOfClusters0 = numberOfClusters;  // select all clusters
     
-    if(bptx3) hclus1->Fill(float(numberOfClusters0));
-    if(bptx4) hclus2->Fill(float(numberOfClusters0));
-    //if(bit0)  hclus10->Fill(float(numberOfClusters0));   // 
-    if(bptx_and) hclus11->Fill(float(numberOfClusters0));
-    if(bptx_xor) hclus12->Fill(float(numberOfClusters0));
-    if(!bptx_xor && !bptx_and) hclus13->Fill(float(numberOfClusters0));
-    if(bptx_m)   hclus14->Fill(float(numberOfClusters0));
-    if(bptx_p)   hclus15->Fill(float(numberOfClusters0));
-
-    //if(bcs_all)   hclus4->Fill(float(numberOfClusters0));       // or of all BCS bits
-    //else      hclus17->Fill(float(numberOfClusters0));      // no BCS
-    //if(bit126) hclus6->Fill(float(numberOfClusters0));   // bit 126
-    //if(bit124) hclus7->Fill(float(numberOfClusters0));
-    //if(bit122) hclus26->Fill(float(numberOfClusters0));
-    //if(bcsOR)      hclus8->Fill(float(numberOfClusters0));  // bit 34
-    //if(bcs)        hclus9->Fill(float(numberOfClusters0));  // all bcs except 34
-    //if(bcs_bptx)   hclus29->Fill(float(numberOfClusters0)); // bits 124,126
-    //if(bcs_double) hclus28->Fill(float(numberOfClusters0)); // 36-39, 40-43
-    //if(bit32_33)   hclus25->Fill(float(numberOfClusters0)); // bits 32,33? is this usefull
-    //if(halo)       hclus3->Fill(float(numberOfClusters0));  // bits 36-39
-    //if(bit85) hclus18->Fill(float(numberOfClusters0));      // bit85
-    //if(minBias) hclus19->Fill(float(numberOfClusters0));    // bits 40,41
-// #ifdef BX 
-//     if     (bxId==1)  {hclus30->Fill(float(numberOfClusters0));hdigis30->Fill(float(numberOfPixels));}
-//     else if(bxId==2)  {hclus31->Fill(float(numberOfClusters0));hdigis31->Fill(float(numberOfPixels));}
-//     else if(bxId==3)  {hclus32->Fill(float(numberOfClusters0));hdigis32->Fill(float(numberOfPixels));}
-//     else if(bxId==4)  {hclus33->Fill(float(numberOfClusters0));hdigis33->Fill(float(numberOfPixels));}
-//     else if(bxId==5)  {hclus34->Fill(float(numberOfClusters0));hdigis34->Fill(float(numberOfPixels));}
-//     else if(bxId==6)  {hclus35->Fill(float(numberOfClusters0));hdigis35->Fill(float(numberOfPixels));}
-//     else if(bxId==-1) {hclus36->Fill(float(numberOfClusters0));hdigis36->Fill(float(numberOfPixels));}
-//     else              {hclus37->Fill(float(numberOfClusters0));hdigis37->Fill(float(numberOfPixels));}
-//     if(run>=160888 && run<=160940) { // 64bx
-//       // Fill 1638
-//       if(bx==442)       {hclus7->Fill(float(numberOfClusters0));  hdigis7->Fill(float(numberOfPixels));} //B1, 1st
-//       else if(bx==3136) {hclus18->Fill(float(numberOfClusters0)); hdigis18->Fill(float(numberOfPixels));} //B1, last
-//       else if(bx==466)  {hclus25->Fill(float(numberOfClusters0)); hdigis25->Fill(float(numberOfPixels));} //B2, last
-//       else if(bx==3112) {hclus26->Fill(float(numberOfClusters0)); hdigis26->Fill(float(numberOfPixels));} //B2, 1st
-//     } else if(run>=160955 && run<=161176) { // 136bx
-//       // Fill 1640
-//       if(bx==149)       hclus7->Fill(float(numberOfClusters0));
-//       else if(bx==3184) hclus18->Fill(float(numberOfClusters0));
-//       else if(bx==173)  hclus25->Fill(float(numberOfClusters0));
-//       else if(bx==3112) hclus26->Fill(float(numberOfClusters0));
-//     } else if(run>=161216 && run<=161312) { // 200bx
-//       // Fill 1645
-//       if(bx==1 || bx==4) {
-// 	hclus7->Fill(float(numberOfClusters0));
-// 	hdigis7->Fill(float(numberOfPixels));
-//       } else if( bx==1950 || bx==1953 || bx==1956 || bx==1959 ) {
-// 	hclus18->Fill(float(numberOfClusters0));
-// 	hdigis18->Fill(float(numberOfPixels));
-//       } else if(bx==25 || bx==28) {
-// 	hclus25->Fill(float(numberOfClusters0));
-// 	hdigis25->Fill(float(numberOfPixels));
-//       } else if( bx==1878 || bx==1881 || bx==1884 || bx==1887 ) {
-// 	hclus26->Fill(float(numberOfClusters0));
-// 	hdigis26->Fill(float(numberOfPixels));      }
-//     }
-// #endif
-
-    // Check L1 bits with pixel selection
-    if (L1GTRR.isValid()) {
-      //bool l1a = L1GTRR->decision();
-      //cout<<" L1 status :"<<l1a<<" "<<hex;
-      for (unsigned int i = 0; i < L1GTRR->decisionWord().size(); ++i) {
-	int l1flag = L1GTRR->decisionWord()[i]; 
-	int t1flag = L1GTRR->technicalTriggerWord()[i]; 	
-	if( l1flag>0 )        hl1a1->Fill(float(i));
-	if( t1flag>0 && i<64) hl1t1->Fill(float(i));
-      } // for loop
-    } // if l1a
-
-    // HLT bits
-    for (unsigned int i=0;i<256;i++) if(hlt[i]) hlt3->Fill(float(i));
+      if(bptx3) hclus1->Fill(float(numberOfClusters0));
+      if(bptx4) hclus2->Fill(float(numberOfClusters0));
+      //if(bit0)  hclus10->Fill(float(numberOfClusters0));   // 
+      if(bptx_and) hclus11->Fill(float(numberOfClusters0));
+      if(bptx_xor) hclus12->Fill(float(numberOfClusters0));
+      if(!bptx_xor && !bptx_and) hclus13->Fill(float(numberOfClusters0));
+      if(bptx_m)   hclus14->Fill(float(numberOfClusters0));
+      if(bptx_p)   hclus15->Fill(float(numberOfClusters0));
+
+      //if(bcs_all)   hclus4->Fill(float(numberOfClusters0));       // or of all BCS bits
+      //else      hclus17->Fill(float(numberOfClusters0));      // no BCS
+      //if(bit126) hclus6->Fill(float(numberOfClusters0));   // bit 126
+      //if(bit124) hclus7->Fill(float(numberOfClusters0));
+      //if(bit122) hclus26->Fill(float(numberOfClusters0));
+      //if(bcsOR)      hclus8->Fill(float(numberOfClusters0));  // bit 34
+      //if(bcs)        hclus9->Fill(float(numberOfClusters0));  // all bcs except 34
+      //if(bcs_bptx)   hclus29->Fill(float(numberOfClusters0)); // bits 124,126
+      //if(bcs_double) hclus28->Fill(float(numberOfClusters0)); // 36-39, 40-43
+      //if(bit32_33)   hclus25->Fill(float(numberOfClusters0)); // bits 32,33? is this usefull
+      //if(halo)       hclus3->Fill(float(numberOfClusters0));  // bits 36-39
+      //if(bit85) hclus18->Fill(float(numberOfClusters0));      // bit85
+      //if(minBias) hclus19->Fill(float(numberOfClusters0));    // bits 40,41
+  // #ifdef BX 
+  //     if     (bxId==1)  {hclus30->Fill(float(numberOfClusters0));hdigis30->Fill(float(numberOfPixels));}
+  //     else if(bxId==2)  {hclus31->Fill(float(numberOfClusters0));hdigis31->Fill(float(numberOfPixels));}
+  //     else if(bxId==3)  {hclus32->Fill(float(numberOfClusters0));hdigis32->Fill(float(numberOfPixels));}
+  //     else if(bxId==4)  {hclus33->Fill(float(numberOfClusters0));hdigis33->Fill(float(numberOfPixels));}
+  //     else if(bxId==5)  {hclus34->Fill(float(numberOfClusters0));hdigis34->Fill(float(numberOfPixels));}
+  //     else if(bxId==6)  {hclus35->Fill(float(numberOfClusters0));hdigis35->Fill(float(numberOfPixels));}
+  //     else if(bxId==-1) {hclus36->Fill(float(numberOfClusters0));hdigis36->Fill(float(numberOfPixels));}
+  //     else              {hclus37->Fill(float(numberOfClusters0));hdigis37->Fill(float(numberOfPixels));}
+  //     if(run>=160888 && run<=160940) { // 64bx
+  //       // Fill 1638
+  //       if(bx==442)       {hclus7->Fill(float(numberOfClusters0));  hdigis7->Fill(float(numberOfPixels));} //B1, 1st
+  //       else if(bx==3136) {hclus18->Fill(float(numberOfClusters0)); hdigis18->Fill(float(numberOfPixels));} //B1, last
+  //       else if(bx==466)  {hclus25->Fill(float(numberOfClusters0)); hdigis25->Fill(float(numberOfPixels));} //B2, last
+  //       else if(bx==3112) {hclus26->Fill(float(numberOfClusters0)); hdigis26->Fill(float(numberOfPixels));} //B2, 1st
+  //     } else if(run>=160955 && run<=161176) { // 136bx
+  //       // Fill 1640
+  //       if(bx==149)       hclus7->Fill(float(numberOfClusters0));
+  //       else if(bx==3184) hclus18->Fill(float(numberOfClusters0));
+  //       else if(bx==173)  hclus25->Fill(float(numberOfClusters0));
+  //       else if(bx==3112) hclus26->Fill(float(numberOfClusters0));
+  //     } else if(run>=161216 && run<=161312) { // 200bx
+  //       // Fill 1645
+  //       if(bx==1 || bx==4) {
+  // 	hclus7->Fill(float(numberOfClusters0));
+  // 	hdigis7->Fill(float(numberOfPixels));
+  //       } else if( bx==1950 || bx==1953 || bx==1956 || bx==1959 ) {
+  // 	hclus18->Fill(float(numberOfClusters0));
+  // 	hdigis18->Fill(float(numberOfPixels));
+  //       } else if(bx==25 || bx==28) {
+  // 	hclus25->Fill(float(numberOfClusters0));
+  // 	hdigis25->Fill(float(numberOfPixels));
+  //       } else if( bx==1878 || bx==1881 || bx==1884 || bx==1887 ) {
+  // 	hclus26->Fill(float(numberOfClusters0));
+  // 	hdigis26->Fill(float(numberOfPixels));      }
+  //     }
+  // #endif
+
+      // Check L1 bits with pixel selection
+      if (L1GTRR.isValid()) {
+	//bool l1a = L1GTRR->decision();
+	//cout<<" L1 status :"<<l1a<<" "<<hex;
+	const DecisionWord & l1Word = L1GTRR->decisionWord();
+	const TechnicalTriggerWord & techWord = L1GTRR->technicalTriggerWord();
+	for (unsigned int i = 0; i < l1Word.size(); ++i) {
+	  int l1flag = l1Word[i];
+	  int t1flag = techWord[i];
+	  if( l1flag>0 )        hl1a1->Fill(float(i));
+	  if( t1flag>0 && i<64) hl1t1->Fill(float(i));
+	} // for loop
+      } // if l1a
+
+      // HLT bits
+      for (unsigned int i=0;i<256;i++) if(hlt[i]) hlt3->Fill(float(i));
     
-#endif  // L1
+    } // L1
     
   } // if select event
 
-#endif // HISTOS
     
   
 } // end 
@@ -141,6 +141,8 @@ process.GlobalTag.globaltag = "GR_P_V28::All"
 process.analysis = cms.EDAnalyzer("ReadPixClusters",
     Verbosity = cms.untracked.bool(True),
     src = cms.InputTag("siPixelClusters"),
+#    NtupleMaxClusters = cms.untracked.int32(20000), # per cluster ntuple, 0 off
+#    NtupleBasketSize = cms.untracked.int32(256000),
 )
 
 #process.p = cms.Path(process.hltfilter*process.analysis)
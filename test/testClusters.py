@@ -419,6 +419,10 @@ process.d = cms.EDAnalyzer("TestClusters",
     src = cms.InputTag("siPixelClusters"),
     Select1 = cms.untracked.int32(1),  # cut on the num of dets <4 skip, 0 means 4 default 
     Select2 = cms.untracked.int32(0),  # 6 no bptx, 0 no selection                               
+#    BunchPatternFile = cms.untracked.string("bunchPatterns.txt"), # fill schemes per run, see PixelBunchPattern.h
+# analysis blocks, default histos l1 rocEff lumi bx; also hlt and heavyIon (HI histo ranges)
+#    Features = cms.untracked.vstring("histos","l1","rocEff","lumi","bx"),
+#    LumiSummaryFile = cms.untracked.string("lumiSummary.txt"), # per LS averages, appended at each endLumi, replace hclusls, hpixls, hcluslsn, hpixlsn
 )
 
 process.p = cms.Path(process.hltPhysicsDeclared*process.hltfilter*process.d)
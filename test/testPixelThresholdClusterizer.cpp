@@ -0,0 +1,654 @@
+//----------------------------------------------------------------------------
+//! Unit test of PixelThresholdClusterizer: the specialised cluster searches
+//! must give the clusters of the generic search on the pixel matrix
+//! (copy_to_buffer() and make_clusters_runtime()), on random DetUnits
+//! with isolated pixels, large clusters and long lines of pixels.
+//!
+//!  - binary readout layers: clusterize_binary() on the occupancy bitmap
+//!    gives the same clusters, in the same order, with the same pixels
+//!    and charge (the pixel order inside a cluster may differ).  With a
+//!    cluster of more than 256 pixels it gives up, and the matrix search
+//!    done instead, as in clusterizeDetUnit(), gives the generic clusters.
+//!  - topology kernels: the instance of make_clusters_fixed() chosen by
+//!    select_kernel() for the BPix and FPix sizes gives exactly the same
+//!    clusters, pixel order included; odd sizes go to the runtime one.
+//!    Besides the random DetUnits, a fixture of blocks, diagonal chains,
+//!    pixels touching by a corner only, pixels one apart and the corners
+//!    of the DetUnit must give its known clusters with every kernel.
+//!
+//! The buffer and the bitmap must be clean after each DetUnit.
+//!
+//! The threshold tables in noise units must hold the expected thresholds
+//! and give the clusters of the equivalent flat thresholds; the time per
+//! DetUnit with the tables and with flat thresholds is printed.
+//!
+//! The seeded search is timed against an iterative label propagation (the
+//! reference of the heavy-ion studies: every pixel above threshold takes
+//! the smallest label of its 8 neighbours until nothing changes, then the
+//! seed and cluster thresholds are applied per label) from 0.1% to 30%
+//! occupancy; both must give the same clusters.  The seeded search was
+//! faster at all occupancies, so there is no label propagation engine.
+//!
+//! Then, as a record for the ScalingReport, the time per DetUnit and the
+//! working memory at 1% occupancy are printed for the present BPix module
+//! and three larger synthetic topologies, on which the bitmap of the
+//! binary readout is checked against the matrix as above.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/PixelThresholdClusterizer.h"
+#include "DataFormats/SiPixelDetId/interface/PXBDetId.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+typedef edmNew::DetSetVector<SiPixelCluster> Clusters;
+
+class testPixelThresholdClusterizer {
+ public:
+  static bool binaryReadout();
+  static bool largeCluster();
+  static bool topologyKernels();
+  static bool scaling();
+  static bool noiseThresholds();
+  static bool labelPropagation();
+
+ private:
+  static edm::ParameterSet config();
+  static edm::DetSet<PixelDigi> randomDigis( uint32_t detid, int nrows, int ncols, int ndigis,
+					     bool lines, int adc );
+  static edm::DetSet<PixelDigi> fixtureDigis( uint32_t detid, int nrows, int ncols );
+  static void generic( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+		       int nrows, int ncols, Clusters & output );
+  static void kernel( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+		      int nrows, int ncols, Clusters & output );
+  static bool sameClusters( const Clusters & a, const Clusters & b, bool samePixelOrder );
+  static bool isClean( const PixelThresholdClusterizer & cl );
+  typedef std::vector<std::vector<std::pair<int,int> > > PixelSets;
+  static void labelClusters( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+			     int nrows, int ncols, std::vector<int> & labels, PixelSets & clusters );
+};
+
+
+//----------------------------------------------------------------------------
+//! Flat thresholds, no gain calibration; layers 5 and up are binary.
+//----------------------------------------------------------------------------
+edm::ParameterSet testPixelThresholdClusterizer::config()
+{
+  edm::ParameterSet conf;
+  conf.addParameter<int>("ChannelThreshold", 1000);
+  conf.addParameter<int>("SeedThreshold", 1000);
+  conf.addParameter<double>("ClusterThreshold", 4000.);
+  conf.addParameter<int>("VCaltoElectronGain", 65);
+  conf.addParameter<int>("VCaltoElectronOffset", -414);
+  conf.addParameter<int>("AdcFullScaleStack", 1);
+  conf.addParameter<int>("FirstStackLayer", 5);
+  conf.addParameter<bool>("SplitClusters", false);
+  conf.addUntrackedParameter<bool>("MissCalibrate", false);
+  return conf;
+}
+
+//----------------------------------------------------------------------------
+//! Random pixels, each at most once; with lines, half of them make lines
+//! of 40 pixels going down one row per pixel and right one column every
+//! three, so that each pixel touches the previous one: long connected
+//! clusters, cut at the edges of the DetUnit.
+//----------------------------------------------------------------------------
+edm::DetSet<PixelDigi> testPixelThresholdClusterizer::randomDigis( uint32_t detid, int nrows, int ncols,
+								   int ndigis, bool lines, int adc )
+{
+  const int length = 40;
+  edm::DetSet<PixelDigi> digis(detid);
+  std::set<std::pair<int,int> > used;
+  int lineRow = 0, lineCol = 0;
+  for (int i = 0; i < ndigis; ++i)
+    {
+      int row = rand() % nrows;
+      int col = rand() % ncols;
+      if ( lines && i < ndigis/2 )
+	{
+	  const int j = i % length;
+	  if ( j == 0 ) 
+	    {
+	      lineRow = row;
+	      lineCol = col;
+	    }
+	  row = lineRow + j;
+	  col = lineCol + j/3;
+	  if ( row >= nrows || col >= ncols ) continue;
+	}
+      if ( !used.insert(std::make_pair(row,col)).second ) continue;
+      digis.push_back(PixelDigi(row, col, adc));
+    }
+  return digis;
+}
+
+//----------------------------------------------------------------------------
+//! Known clusters, fixtureClusters of them with fixturePixels pixels in
+//! all; every pixel is above the cluster threshold on its own.
+//----------------------------------------------------------------------------
+namespace {
+  const unsigned int fixtureClusters = 10;
+  const unsigned int fixturePixels = 24;
+}
+
+edm::DetSet<PixelDigi> testPixelThresholdClusterizer::fixtureDigis( uint32_t detid, int nrows, int ncols )
+{
+  const int pixels[][2] = {
+    { 2, 2}, { 2, 3}, { 2, 4}, { 3, 2}, { 3, 3}, { 3, 4}, { 4, 2}, { 4, 3}, { 4, 4},   // 3x3 block
+    {10,10}, {11,11}, {12,12}, {13,13},                                               // diagonal chain
+    {20,31}, {21,30},                                                                 // anti-diagonal pair
+    {30,40}, {30,42},                                                                 // one column apart
+    { 0, 0}, {nrows-1, ncols-1}, { 0, ncols-1}, {nrows-1, 0},                         // corners
+    {nrows-1,50}, {nrows-2,50}, {nrows-2,51}                                          // L on the last row
+  };
+  edm::DetSet<PixelDigi> digis(detid);
+  for (unsigned int i = 0; i < sizeof(pixels)/sizeof(pixels[0]); ++i)
+    digis.push_back(PixelDigi(pixels[i][0], pixels[i][1], 100));
+  return digis;
+}
+
+//----------------------------------------------------------------------------
+//! The reference: the generic search on the matrix.
+//----------------------------------------------------------------------------
+void testPixelThresholdClusterizer::generic( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+					     int nrows, int ncols, Clusters & output )
+{
+  Clusters::FastFiller spc(output, digis.detId());
+  cl.setup(nrows, ncols);
+  cl.begin_detunit(digis.detId(), false);
+  cl.copy_to_buffer(digis.begin(), digis.end());
+  cl.make_clusters_runtime(spc);
+  cl.clear_buffer(digis.begin(), digis.end());
+}
+
+//----------------------------------------------------------------------------
+//! The kernel selected by setup(), as clusterizeDetUnit() runs it.
+//----------------------------------------------------------------------------
+void testPixelThresholdClusterizer::kernel( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+					    int nrows, int ncols, Clusters & output )
+{
+  Clusters::FastFiller spc(output, digis.detId());
+  cl.setup(nrows, ncols);
+  cl.begin_detunit(digis.detId(), false);
+  cl.copy_to_buffer(digis.begin(), digis.end());
+  (cl.*cl.theKernel)(spc);
+  cl.clear_buffer(digis.begin(), digis.end());
+}
+
+bool testPixelThresholdClusterizer::sameClusters( const Clusters & a, const Clusters & b, bool samePixelOrder )
+{
+  if ( a.size() != b.size() || a.dataSize() != b.dataSize() ) return false;
+  for (Clusters::const_iterator da = a.begin(), db = b.begin(); da != a.end(); ++da, ++db)
+    {
+      if ( da->detId() != db->detId() || da->size() != db->size() ) return false;
+      for (unsigned int i = 0; i < da->size(); ++i)
+	{
+	  const SiPixelCluster & ca = (*da)[i];
+	  const SiPixelCluster & cb = (*db)[i];
+	  if ( ca.charge() != cb.charge() ) return false;
+	  std::vector<SiPixelCluster::Pixel> pa = ca.pixels(), pb = cb.pixels();
+	  if ( pa.size() != pb.size() ) return false;
+	  std::vector<std::pair<std::pair<int,int>,int> > sa, sb;
+	  for (unsigned int p = 0; p < pa.size(); ++p)
+	    {
+	      sa.push_back(std::make_pair(std::make_pair(pa[p].x, pa[p].y), pa[p].adc));
+	      sb.push_back(std::make_pair(std::make_pair(pb[p].x, pb[p].y), pb[p].adc));
+	    }
+	  if ( !samePixelOrder )
+	    {
+	      std::sort(sa.begin(), sa.end());
+	      std::sort(sb.begin(), sb.end());
+	    }
+	  if ( sa != sb ) return false;
+	}
+    }
+  return true;
+}
+
+bool testPixelThresholdClusterizer::isClean( const PixelThresholdClusterizer & cl )
+{
+  for (int col = 0; col < cl.theNumOfCols; ++col)
+    for (int row = 0; row < cl.theNumOfRows; ++row)
+      if ( cl.theBuffer(row,col) != 0 ||
+	   ( cl.theBitmap.rows() > 0 && cl.theBitmap.test(row,col) ) ) return false;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Occupancy bitmap of the binary readout layers against the matrix.
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::binaryReadout()
+{
+  PixelThresholdClusterizer cl(config());
+  const int nrows = 160, ncols = 416;
+  srand(7);
+  unsigned int nclusters = 0;
+  for (int it = 0; it < 300; ++it)
+    {
+      const uint32_t detid = PXBDetId(5, 1 + it/8, 1 + it%8).rawId();
+      edm::DetSet<PixelDigi> digis = randomDigis(detid, nrows, ncols, rand() % (it < 150 ? 200 : 8000),
+						 it%3 == 0, 1);
+      Clusters bitmap, matrix;
+      {
+	Clusters::FastFiller spc(bitmap, detid);
+	cl.setup(nrows, ncols);
+	cl.begin_detunit(detid, false);
+	if ( !cl.binary_readout() || !cl.clusterize_binary(digis.begin(), digis.end(), spc) )
+	  {
+	    std::cout << "binaryReadout: DetUnit " << it << " not done on the bitmap" << std::endl;
+	    return false;
+	  }
+      }
+      generic(cl, digis, nrows, ncols, matrix);
+      if ( !sameClusters(bitmap, matrix, false) || !isClean(cl) )
+	{
+	  std::cout << "binaryReadout: DetUnit " << it << " differs, " << bitmap.dataSize()
+		    << " clusters on the bitmap, " << matrix.dataSize() << " on the matrix" << std::endl;
+	  return false;
+	}
+      nclusters += matrix.dataSize();
+    }
+  std::cout << "binaryReadout: 300 DetUnits, " << nclusters << " clusters, OK" << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Binary readout DetUnits with a block of 300 to 600 pixels: too large
+//! for the bitmap, done on the matrix.
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::largeCluster()
+{
+  PixelThresholdClusterizer cl(config());
+  const int nrows = 160, ncols = 416;
+  srand(17);
+  for (int it = 0; it < 20; ++it)
+    {
+      const uint32_t detid = PXBDetId(5, 1, 1 + it).rawId();
+      edm::DetSet<PixelDigi> digis = randomDigis(detid, nrows, ncols, 100 + rand()%400, it%2 == 0, 1);
+      std::set<std::pair<int,int> > used;
+      for (edm::DetSet<PixelDigi>::const_iterator di = digis.begin(); di != digis.end(); ++di)
+	used.insert(std::make_pair(di->row(), di->column()));
+      const int height = 15 + rand()%15, width = 20;
+      const int row0 = rand() % (nrows-height), col0 = rand() % (ncols-width);
+      for (int col = col0; col < col0+width; ++col)
+	for (int row = row0; row < row0+height; ++row)
+	  if ( used.insert(std::make_pair(row,col)).second ) digis.push_back(PixelDigi(row, col, 1));
+
+      Clusters fallback, matrix;
+      bool onBitmap = false;
+      {
+	Clusters::FastFiller spc(fallback, detid);
+	cl.setup(nrows, ncols);
+	cl.begin_detunit(detid, false);
+	onBitmap = cl.binary_readout() && cl.clusterize_binary(digis.begin(), digis.end(), spc);
+	if ( !onBitmap )
+	  {
+	    cl.copy_to_buffer(digis.begin(), digis.end());
+	    (cl.*cl.theKernel)(spc);
+	    cl.clear_buffer(digis.begin(), digis.end());
+	  }
+      }
+      generic(cl, digis, nrows, ncols, matrix);
+      if ( onBitmap || !sameClusters(fallback, matrix, true) || !isClean(cl) )
+	{
+	  std::cout << "largeCluster: DetUnit " << it << ( onBitmap ? " done on the bitmap" : " differs" )
+		    << ", " << fallback.dataSize() << " clusters, " << matrix.dataSize() 
+		    << " with the generic search" << std::endl;
+	  return false;
+	}
+    }
+  std::cout << "largeCluster: 20 DetUnits, OK" << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Kernel of each topology against the runtime one, on analog layers.
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::topologyKernels()
+{
+  PixelThresholdClusterizer cl(config());
+  // the sizes of the table of select_kernel(), then one which is not in it
+  const int sizes[][2] = { {160,416}, {80,416}, {80,104}, {80,260}, {160,156}, {160,208}, {160,260},
+			   {93,217} };
+  const int nsizes = sizeof(sizes)/sizeof(sizes[0]);
+  for (int k = 0; k < nsizes; ++k)
+    {
+      const int nrows = sizes[k][0], ncols = sizes[k][1];
+      const uint32_t detid = PXBDetId(1, 1, 1 + k).rawId();
+      cl.setup(nrows, ncols);
+      if ( (k == nsizes-1) != (cl.theKernel == &PixelThresholdClusterizer::make_clusters_runtime) )
+	{
+	  std::cout << "topologyKernels: wrong kernel for " << nrows << " x " << ncols << std::endl;
+	  return false;
+	}
+      edm::DetSet<PixelDigi> digis = fixtureDigis(detid, nrows, ncols);
+      Clusters fixture, matrix;
+      kernel(cl, digis, nrows, ncols, fixture);
+      generic(cl, digis, nrows, ncols, matrix);
+      unsigned int npixels = 0;
+      for (Clusters::const_iterator it = fixture.begin(); it != fixture.end(); ++it)
+	for (unsigned int i = 0; i < it->size(); ++i) npixels += (*it)[i].size();
+      if ( fixture.dataSize() != fixtureClusters || npixels != fixturePixels ||
+	   !sameClusters(fixture, matrix, true) || !isClean(cl) )
+	{
+	  std::cout << "topologyKernels: fixture on " << nrows << " x " << ncols << " gives " 
+		    << fixture.dataSize() << " clusters of " << npixels << " pixels, expected "
+		    << fixtureClusters << " of " << fixturePixels << std::endl;
+	  return false;
+	}
+    }
+
+  srand(11);
+  unsigned int nclusters = 0;
+  for (int it = 0; it < 320; ++it)
+    {
+      const int nrows = sizes[it%nsizes][0], ncols = sizes[it%nsizes][1];
+      const uint32_t detid = PXBDetId(1, 1 + it/8, 1 + it%8).rawId();
+      edm::DetSet<PixelDigi> digis = randomDigis(detid, nrows, ncols, rand() % (it < 150 ? 200 : 8000),
+						 it%3 == 0, 20 + rand()%200);
+      Clusters withKernel, matrix;
+      kernel(cl, digis, nrows, ncols, withKernel);
+      generic(cl, digis, nrows, ncols, matrix);
+      if ( !sameClusters(withKernel, matrix, true) || !isClean(cl) )
+	{
+	  std::cout << "topologyKernels: DetUnit " << it << " (" << nrows << " x " << ncols << ") differs, "
+		    << withKernel.dataSize() << " clusters with the kernel, " << matrix.dataSize() 
+		    << " with the runtime search" << std::endl;
+	  return false;
+	}
+      nclusters += matrix.dataSize();
+    }
+  std::cout << "topologyKernels: fixtures, 320 DetUnits, " << nclusters << " clusters, OK" << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Time and memory per DetUnit against the number of channels.
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::scaling()
+{
+  PixelThresholdClusterizer cl(config());
+  const int sizes[][2] = { {160,416}, {320,832}, {640,1664}, {1280,3328} };
+  const int nmodules = 20;
+  for (unsigned int k = 0; k < sizeof(sizes)/sizeof(sizes[0]); ++k)
+    {
+      const int nrows = sizes[k][0], ncols = sizes[k][1];
+      const int nchannels = nrows*ncols;
+      srand(3);
+      std::vector<edm::DetSet<PixelDigi> > modules;
+      for (int m = 0; m < nmodules; ++m) 
+	modules.push_back(randomDigis(PXBDetId(1, 1, 1 + m).rawId(), nrows, ncols, nchannels/100, false, 50));
+
+      Clusters output;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int m = 0; m < nmodules; ++m)
+	{
+	  Clusters::FastFiller spc(output, modules[m].detId());
+	  cl.setup(nrows, ncols);
+	  cl.begin_detunit(modules[m].detId(), false);
+	  cl.copy_to_buffer(modules[m].begin(), modules[m].end());
+	  (cl.*cl.theKernel)(spc);
+	  cl.clear_buffer(modules[m].begin(), modules[m].end());
+	}
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      const double us = elapsed.count()*1e6/nmodules;
+      std::cout << "scaling: " << nrows << " x " << ncols << ", " << us << " us/DetUnit, " 
+		<< cl.memoryUsage()/1024 << " kB, " << us*1000/nchannels << " ns/channel" << std::endl;
+
+      if ( k == 0 ) continue;
+      for (int m = 0; m < 3; ++m)
+	{
+	  const uint32_t detid = PXBDetId(5, 1, 1 + m).rawId();
+	  edm::DetSet<PixelDigi> digis = randomDigis(detid, nrows, ncols, nchannels/100, m == 0, 1);
+	  Clusters bitmap, matrix;
+	  {
+	    Clusters::FastFiller spc(bitmap, detid);
+	    cl.setup(nrows, ncols);
+	    cl.begin_detunit(detid, false);
+	    if ( !cl.clusterize_binary(digis.begin(), digis.end(), spc) ) return false;
+	  }
+	  generic(cl, digis, nrows, ncols, matrix);
+	  if ( !sameClusters(bitmap, matrix, false) || !isClean(cl) )
+	    {
+	      std::cout << "scaling: bitmap and matrix differ for " << nrows << " x " << ncols << std::endl;
+	      return false;
+	    }
+	}
+    }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Thresholds in noise units, without gain payload (135 electrons per ADC
+//! count): noise sqrt(200^2 + (135/sqrt(12))^2) = 203.7 electrons.
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::noiseThresholds()
+{
+  edm::ParameterSet conf = config();
+  conf.addParameter<double>("ChannelThresholdInNoiseUnits", 6.);
+  conf.addParameter<double>("SeedThresholdInNoiseUnits", 10.);
+  conf.addParameter<double>("ClusterThresholdInNoiseUnits", 40.);
+  conf.addParameter<double>("NoiseInElectrons", 200.);
+  const double noise = std::sqrt(200.*200. + 135.*135./12.);
+  edm::ParameterSet flatConf = config();
+  flatConf.addParameter<int>("ChannelThreshold", int(6.*noise));
+  flatConf.addParameter<int>("SeedThreshold", int(10.*noise));
+  flatConf.addParameter<double>("ClusterThreshold", 40.*noise);
+  PixelThresholdClusterizer tables(conf), flat(flatConf);
+
+  const int nrows = 160, ncols = 416, nmodules = 200;
+  srand(13);
+  std::vector<edm::DetSet<PixelDigi> > modules;
+  for (int m = 0; m < nmodules; ++m)
+    {
+      const uint32_t detid = PXBDetId(1, 1 + m/8, 1 + m%8).rawId();
+      PixelThresholdClusterizer::ThresholdTable & table = tables.theThresholdTables[detid];
+      tables.make_threshold_table(detid, nrows, ncols, 80, table);
+      if ( table.pixel[m%ncols] != int(6.*noise) || table.seed[m%ncols] != int(10.*noise) ||
+	   table.minPixel != int(6.*noise) || std::abs(table.cluster - 40.*noise) > 1. )
+	{
+	  std::cout << "noiseThresholds: wrong table, pixel " << table.pixel[m%ncols] << " seed " << table.seed[m%ncols]
+		    << " cluster " << table.cluster << " for a noise of " << noise << std::endl;
+	  return false;
+	}
+      edm::DetSet<PixelDigi> digis(detid);
+      const edm::DetSet<PixelDigi> pixels = randomDigis(detid, nrows, ncols, nrows*ncols/100, m%3 == 0, 0);
+      for (edm::DetSet<PixelDigi>::const_iterator di = pixels.begin(); di != pixels.end(); ++di)
+	digis.push_back(PixelDigi(di->row(), di->column(), 5 + rand()%50));
+      modules.push_back(digis);
+    }
+
+  Clusters withTables, withFlat;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int m = 0; m < nmodules; ++m) generic(tables, modules[m], nrows, ncols, withTables);
+  std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+  for (int m = 0; m < nmodules; ++m) generic(flat, modules[m], nrows, ncols, withFlat);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  if ( !sameClusters(withTables, withFlat, true) || withFlat.dataSize() == 0 )
+    {
+      std::cout << "noiseThresholds: " << withTables.dataSize() << " clusters with the tables, "
+		<< withFlat.dataSize() << " with the flat thresholds" << std::endl;
+      return false;
+    }
+  std::chrono::duration<double> tTables = middle - start, tFlat = end - middle;
+  std::cout << "noiseThresholds: " << nmodules << " DetUnits, " << withFlat.dataSize() << " clusters, OK; "
+	    << tTables.count()*1e6/nmodules << " us/DetUnit with the tables, "
+	    << tFlat.count()*1e6/nmodules << " us/DetUnit with flat thresholds" << std::endl;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//! Clusters by label propagation, as sorted pixel lists.  The labels are
+//! indices in a column-major matrix with one empty row and column around
+//! it; empty pixels hold INT_MAX, so that a column update is a branch-free
+//! minimum over the 3x3 neighbourhood, vectorised along the rows.
+//----------------------------------------------------------------------------
+void testPixelThresholdClusterizer::labelClusters( PixelThresholdClusterizer & cl, const edm::DetSet<PixelDigi> & digis,
+						   int nrows, int ncols, std::vector<int> & labels, PixelSets & clusters )
+{
+  const int empty = std::numeric_limits<int>::max();
+  const int stride = nrows+2;
+  labels.assign(stride*(ncols+2), empty);
+  std::vector<int> charges(labels.size(), 0), next(stride);
+  cl.begin_detunit(digis.detId(), false);
+  for (edm::DetSet<PixelDigi>::const_iterator di = digis.begin(); di != digis.end(); ++di)
+    {
+      const int charge = cl.calibrate(di->adc(), di->column(), di->row());
+      if ( charge < cl.thePixelThresholds[di->column()] ) continue;
+      const int i = (di->column()+1)*stride + di->row()+1;
+      labels[i] = i;
+      charges[i] = charge;
+    }
+
+  bool changed = true;
+  while ( changed )
+    {
+      changed = false;
+      for (int col = 1; col <= ncols; ++col)
+	{
+	  const int * l = &labels[(col-1)*stride];
+	  const int * c = &labels[col*stride];
+	  const int * r = &labels[(col+1)*stride];
+	  for (int row = 1; row <= nrows; ++row)
+	    {
+	      int m = std::min(std::min(std::min(l[row-1], l[row]), std::min(l[row+1], c[row-1])),
+			       std::min(std::min(c[row+1], r[row-1]), std::min(r[row], r[row+1])));
+	      next[row] = ( c[row] == empty ) ? empty : std::min(c[row], m);
+	    }
+	  int * out = &labels[col*stride];
+	  for (int row = 1; row <= nrows; ++row)
+	    if ( next[row] != out[row] ) 
+	      {
+		out[row] = next[row];
+		changed = true;
+	      }
+	}
+    }
+
+  std::map<int, std::vector<std::pair<int,int> > > pixels;
+  std::map<int, std::pair<bool,float> > seedAndCharge;
+  for (unsigned int i = 0; i < labels.size(); ++i)
+    {
+      if ( labels[i] == empty ) continue;
+      const int row = i%stride - 1, col = i/stride - 1;
+      pixels[labels[i]].push_back(std::make_pair(row, col));
+      std::pair<bool,float> & sc = seedAndCharge[labels[i]];
+      sc.first = sc.first || charges[i] >= cl.theSeedThresholds[col];
+      sc.second += charges[i];
+    }
+  clusters.clear();
+  for (std::map<int, std::vector<std::pair<int,int> > >::iterator it = pixels.begin(); it != pixels.end(); ++it)
+    {
+      const std::pair<bool,float> & sc = seedAndCharge[it->first];
+      if ( !sc.first || sc.second < cl.theModuleClusterThreshold ) continue;
+      std::sort(it->second.begin(), it->second.end());
+      clusters.push_back(it->second);
+    }
+  std::sort(clusters.begin(), clusters.end());
+}
+
+//----------------------------------------------------------------------------
+//! Seeded search against label propagation on 160x416 DetUnits, half of
+//! the fired pixels in 2x2 blobs, half single; the clusters are compared
+//! as long as no component is larger than a cluster can be (256 pixels).
+//----------------------------------------------------------------------------
+bool testPixelThresholdClusterizer::labelPropagation()
+{
+  PixelThresholdClusterizer cl(config());
+  const int nrows = 160, ncols = 416, nmodules = 10;
+  const double occupancies[] = { 0.001, 0.01, 0.05, 0.1, 0.2, 0.3 };
+  srand(19);
+  double crossover = -1.;
+  for (unsigned int k = 0; k < sizeof(occupancies)/sizeof(occupancies[0]); ++k)
+    {
+      const int npixels = int(occupancies[k]*nrows*ncols);
+      std::vector<edm::DetSet<PixelDigi> > modules;
+      for (int m = 0; m < nmodules; ++m)
+	{
+	  const uint32_t detid = PXBDetId(1, 1, 1 + m).rawId();
+	  edm::DetSet<PixelDigi> digis(detid);
+	  std::set<std::pair<int,int> > used;
+	  for (int i = 0; int(digis.size()) < npixels && i < 4*npixels; ++i)
+	    {
+	      const int row = rand() % (nrows-1), col = rand() % (ncols-1);
+	      const int size = ( i%2 == 0 ) ? 2 : 1;
+	      for (int c = col; c < col+size; ++c)
+		for (int r = row; r < row+size; ++r)
+		  if ( used.insert(std::make_pair(r,c)).second ) digis.push_back(PixelDigi(r, c, 20 + rand()%200));
+	    }
+	  modules.push_back(digis);
+	}
+
+      Clusters seeded;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      for (int m = 0; m < nmodules; ++m) kernel(cl, modules[m], nrows, ncols, seeded);
+      std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+      std::vector<int> labels;
+      std::vector<PixelSets> labelled(nmodules);
+      for (int m = 0; m < nmodules; ++m) labelClusters(cl, modules[m], nrows, ncols, labels, labelled[m]);
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      bool compared = true;
+      Clusters::const_iterator ds = seeded.begin();
+      for (int m = 0; m < nmodules; ++m, ++ds)
+	{
+	  PixelSets sets;
+	  for (unsigned int i = 0; i < ds->size(); ++i)
+	    {
+	      std::vector<SiPixelCluster::Pixel> pixels = (*ds)[i].pixels();
+	      std::vector<std::pair<int,int> > set;
+	      for (unsigned int p = 0; p < pixels.size(); ++p) set.push_back(std::make_pair(pixels[p].x, pixels[p].y));
+	      std::sort(set.begin(), set.end());
+	      sets.push_back(set);
+	    }
+	  std::sort(sets.begin(), sets.end());
+	  bool large = false;
+	  for (unsigned int i = 0; i < labelled[m].size(); ++i) large = large || labelled[m][i].size() > 256;
+	  if ( large ) 
+	    {
+	      compared = false;
+	      continue;
+	    }
+	  if ( sets != labelled[m] )
+	    {
+	      std::cout << "labelPropagation: " << sets.size() << " clusters with the seeded search, "
+			<< labelled[m].size() << " with the labels at " << 100*occupancies[k] << "% occupancy" << std::endl;
+	      return false;
+	    }
+	}
+
+      std::chrono::duration<double> tSeeded = middle - start, tLabels = end - middle;
+      std::cout << "labelPropagation: " << 100*occupancies[k] << "% occupancy, seeded " 
+		<< tSeeded.count()*1e6/nmodules << " us/DetUnit, labels " << tLabels.count()*1e6/nmodules
+		<< " us/DetUnit" << ( compared ? "" : " (components above 256 pixels, not compared)" ) << std::endl;
+      if ( crossover < 0. && tLabels < tSeeded ) crossover = occupancies[k];
+    }
+  if ( crossover < 0. ) 
+    std::cout << "labelPropagation: no crossover up to 30% occupancy, OK" << std::endl;
+  else
+    std::cout << "labelPropagation: crossover at " << 100*crossover << "% occupancy, OK" << std::endl;
+  return true;
+}
+
+
+int main()
+{
+  bool ok = testPixelThresholdClusterizer::binaryReadout();
+  ok = testPixelThresholdClusterizer::largeCluster() && ok;
+  ok = testPixelThresholdClusterizer::topologyKernels() && ok;
+  ok = testPixelThresholdClusterizer::noiseThresholds() && ok;
+  ok = testPixelThresholdClusterizer::labelPropagation() && ok;
+  ok = testPixelThresholdClusterizer::scaling() && ok;
+  return ok ? 0 : 1;
+}
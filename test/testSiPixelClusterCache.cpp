@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------
+//! Unit test of SiPixelClusterCache with two producers of the same
+//! configuration and hot pixel masking, run as SiPixelClusterProducer does:
+//! the one which misses the cache fills the masker and clusters, the other
+//! one takes the clusters.  Over several lumi sections, whichever of the two
+//! comes first in the event, the masks must stay the same (one shared
+//! masker, filled once per event), so that the second producer always hits
+//! the cache, and the hot pixel must be masked.  The copy of the shared
+//! clusters must have the same DetUnits and clusters.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusterCache.h"
+
+#include <cstdlib>
+#include <iostream>
+
+
+namespace {
+  //! One producer of the test, its clusters are not made here
+  struct Producer {
+    Producer( const std::string & config, const edm::ParameterSet & maskConf) :
+      hits(0), misses(0)
+    {
+      masker = SiPixelClusterCache::instance().masker(config, maskConf, owner);
+    }
+
+    //! True if the clusters were taken from the cache
+    bool produce( const edm::EventID & event, const edm::ProductID & input,
+		  const std::string & config, const edm::ProductID & output)
+    {
+      edm::ProductID shared;
+      if ( SiPixelClusterCache::instance().find(event, input, config, masker->maskDigest(), shared) ) {
+	++hits;
+	return true;
+      }
+      ++misses;
+      if ( masker->newEvent(event) ) {
+	masker->fill(302055684, 10, 20);                  // hot, every event
+	for (int i = 0; i < 50; ++i)
+	  masker->fill(302055684 + 4*(rand()%8), rand()%160, rand()%416);
+      }
+      SiPixelClusterCache::instance().insert(event, input, config, masker->maskDigest(), output);
+      return false;
+    }
+
+    boost::shared_ptr<SiPixelHotPixelMasker> masker;
+    bool owner;
+    unsigned int hits, misses;
+  };
+}
+
+
+int main()
+{
+  edm::ParameterSet maskConf;
+  maskConf.addParameter<double>("MaxRate", 0.5);
+  maskConf.addParameter<unsigned int>("WindowLumiSections", 2);
+  maskConf.addParameter<unsigned int>("MinEvents", 50);
+  maskConf.addParameter<unsigned int>("SketchWidthBits", 12);
+  maskConf.addParameter<unsigned int>("SketchDepth", 4);
+
+  const std::string config = "identical";
+  Producer first(config, maskConf), second(config, maskConf);
+  if ( !first.owner || second.owner || first.masker != second.masker ) {
+    std::cerr << "SiPixelClusterCache: the producers do not share one masker" << std::endl;
+    return 1;
+  }
+
+  srand(5);
+  const edm::ProductID input(1, 1), firstOutput(1, 2), secondOutput(1, 3);
+  unsigned long long nEvent = 0;
+  for (unsigned int ls = 1; ls <= 5; ++ls)
+    {
+      for (int i = 0; i < 40; ++i)
+	{
+	  const edm::EventID event(1, ls, ++nEvent);
+	  // the order of the modules differs between the paths
+	  Producer & a = ( i%3 == 0 ) ? second : first;
+	  Producer & b = ( i%3 == 0 ) ? first : second;
+	  a.produce(event, input, config, &a == &first ? firstOutput : secondOutput);
+	  if ( !b.produce(event, input, config, &b == &first ? firstOutput : secondOutput) ) {
+	    std::cerr << "SiPixelClusterCache: miss in lumi section " << ls << ", event " << nEvent << std::endl;
+	    return 1;
+	  }
+	}
+      if ( first.owner ) first.masker->endLumiBlock();
+      if ( second.owner ) second.masker->endLumiBlock();
+    }
+  if ( first.masker->nMasked() != 1 ) {
+    std::cerr << "SiPixelClusterCache: " << first.masker->nMasked() << " pixels masked, expected 1" << std::endl;
+    return 1;
+  }
+
+  // the copy of the shared clusters
+  SiPixelClusterCache::Collection shared, copy;
+  for (unsigned int id = 302055684; id < 302055684 + 4*20; id += 4)
+    {
+      SiPixelClusterCache::Collection::FastFiller ff(shared, id);
+      for (unsigned int i = 0; i < id%7; ++i)
+	{
+	  SiPixelCluster cluster(SiPixelCluster::PixelPos(i, id%416), 100 + i);
+	  cluster.add(SiPixelCluster::PixelPos(i+1, id%416), 50);
+	  ff.push_back(cluster);
+	}
+    }
+  SiPixelClusterCache::copy(shared, copy);
+  bool same = ( copy.size() == shared.size() && copy.dataSize() == shared.dataSize() );
+  for (SiPixelClusterCache::Collection::const_iterator it = shared.begin(), ic = copy.begin();
+       same && it != shared.end(); ++it, ++ic)
+    {
+      same = ( ic->detId() == it->detId() && ic->size() == it->size() );
+      for (unsigned int i = 0; same && i < it->size(); ++i)
+	same = ( (*ic)[i].minPixelRow() == (*it)[i].minPixelRow() && (*ic)[i].minPixelCol() == (*it)[i].minPixelCol() &&
+		 (*ic)[i].size() == (*it)[i].size() && (*ic)[i].charge() == (*it)[i].charge() );
+    }
+  if ( !same ) {
+    std::cerr << "SiPixelClusterCache: the copy differs from the shared clusters" << std::endl;
+    return 1;
+  }
+
+  std::cout << "SiPixelClusterCache: " << first.hits + second.hits << " events shared, "
+	    << first.misses + second.misses << " clustered, 1 pixel masked, OK" << std::endl;
+  return 0;
+}
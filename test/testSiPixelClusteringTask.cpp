@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------
+//! Unit test of SiPixelClusteringTask: resumed until done, the DetUnits are
+//! clustered once each, in the order given, batchSize at a time, the empty
+//! ones dropped; with too many clusters the output is empty and the task
+//! is done at once.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelClusteringTask.h"
+#include "DataFormats/SiPixelDigi/interface/PixelDigi.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+
+namespace {
+  typedef edm::DetSetVector<PixelDigi> Digis;
+  typedef SiPixelClusteringTask<Digis> Task;
+
+  //! One cluster per digi, the DetUnits in the order they were done
+  class OneClusterPerDigi : public Task::ModuleClusterizer {
+  public:
+    void clusterize(const Task::DetUnit & input, Task::Output::FastFiller & spc) {
+      done.push_back(input.detId());
+      for (Task::DetUnit::const_iterator di = input.begin(); di != input.end(); ++di)
+	spc.push_back(SiPixelCluster(SiPixelCluster::PixelPos(di->row(), di->column()), di->adc()));
+    }
+    std::vector<uint32_t> done;
+  };
+}
+
+
+int main()
+{
+  Digis digis;
+  unsigned int nclusters = 0;
+  for (uint32_t id = 100; id < 200; ++id)
+    {
+      edm::DetSet<PixelDigi> & detSet = digis.find_or_insert(id);
+      for (unsigned int i = 0; i < id%4; ++i, ++nclusters)
+	detSet.data.push_back(PixelDigi(10*i, id%50, 100));
+    }
+
+  // input order, batches of 8
+  OneClusterPerDigi clusterizer;
+  Task::Output output;
+  Task task(clusterizer, digis, output, 8);
+  unsigned int nresumed = 1;
+  while ( task.resume() ) ++nresumed;
+  if ( !task.done() || nresumed != 13 || task.numberOfDetUnits() != 100 ||
+       task.numberOfClusters() != nclusters || output.dataSize() != nclusters || output.size() != 75 )
+    {
+      std::cerr << "SiPixelClusteringTask: " << nresumed << " batches, " << task.numberOfDetUnits() << " DetUnits, "
+		<< output.dataSize() << " clusters in " << output.size() << " DetUnits" << std::endl;
+      return 1;
+    }
+  for (unsigned int i = 0; i < clusterizer.done.size(); ++i)
+    if ( clusterizer.done[i] != 100 + i ) {
+      std::cerr << "SiPixelClusteringTask: DetUnit " << clusterizer.done[i] << " done at " << i << std::endl;
+      return 1;
+    }
+
+  // reversed order, stopped after 2 batches
+  std::vector<Task::const_iterator> reversed;
+  for (Task::const_iterator it = digis.begin(); it != digis.end(); ++it) reversed.push_back(it);
+  std::reverse(reversed.begin(), reversed.end());
+  OneClusterPerDigi backwards;
+  Task::Output partial;
+  Task stopped(backwards, reversed, partial, 10);
+  stopped.resume();
+  stopped.resume();
+  if ( stopped.done() || backwards.done.size() != 20 || backwards.done.front() != 199 || backwards.done.back() != 180 )
+    {
+      std::cerr << "SiPixelClusteringTask: " << backwards.done.size() << " DetUnits done in reverse order" << std::endl;
+      return 1;
+    }
+
+  // too many clusters
+  OneClusterPerDigi limited;
+  Task::Output empty;
+  Task tooMany(limited, digis, empty, 16, 20);
+  if ( tooMany.resume() || !tooMany.done() || !tooMany.tooManyClusters() || empty.size() != 0 )
+    {
+      std::cerr << "SiPixelClusteringTask: the limit on the clusters is not applied" << std::endl;
+      return 1;
+    }
+
+  std::cout << "SiPixelClusteringTask: " << nresumed << " batches, OK" << std::endl;
+  return 0;
+}
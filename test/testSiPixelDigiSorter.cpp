@@ -0,0 +1,60 @@
+//----------------------------------------------------------------------------
+//! Unit test of SiPixelDigiSorter: the digis must come out in the order of
+//! std::stable_sort by (column, row), repeated pixels included, for random,
+//! already sorted and wide (512 rows and more) DetUnits; sorted input must
+//! be returned as it is, without a copy.
+//----------------------------------------------------------------------------
+
+#include "RecoLocalTracker/SiPixelClusterizer/interface/SiPixelDigiSorter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+
+namespace {
+  bool less( const PixelDigi & a, const PixelDigi & b) {
+    return a.column() < b.column() || (a.column() == b.column() && a.row() < b.row());
+  }
+  bool same( const PixelDigi & a, const PixelDigi & b) {
+    return a.row() == b.row() && a.column() == b.column() && a.adc() == b.adc();
+  }
+}
+
+
+int main()
+{
+  SiPixelDigiSorter sorter;
+  srand(3);
+  for (int it = 0; it < 2000; ++it)
+    {
+      const int n = rand() % 3000;
+      const int nrows = ( it%50 == 0 ) ? 1000 : 160;
+      std::vector<PixelDigi> digis;
+      for (int i = 0; i < n; ++i) 
+	digis.push_back(PixelDigi(rand() % nrows, rand() % 416, i & 255));   // repeated pixels too
+      const bool sorted = ( it%3 == 0 );
+      if ( sorted ) std::stable_sort(digis.begin(), digis.end(), less);
+
+      std::vector<PixelDigi> reference(digis);
+      std::stable_sort(reference.begin(), reference.end(), less);
+
+      std::vector<PixelDigi>::const_iterator begin = digis.begin(), end = digis.end();
+      sorter.sort(begin, end);
+      if ( sorted && n > 0 && begin != std::vector<PixelDigi>::const_iterator(digis.begin()) )
+	{
+	  std::cout << "SiPixelDigiSorter: sorted DetUnit " << it << " was copied" << std::endl;
+	  return 1;
+	}
+      if ( (unsigned int)(end - begin) != reference.size() || 
+	   !std::equal(reference.begin(), reference.end(), begin, same) )
+	{
+	  std::cout << "SiPixelDigiSorter: DetUnit " << it << " (" << n << " digis, " 
+		    << nrows << " rows) not in order" << std::endl;
+	  return 1;
+	}
+    }
+  std::cout << "SiPixelDigiSorter: 2000 DetUnits, OK" << std::endl;
+  return 0;
+}